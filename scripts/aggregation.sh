@@ -0,0 +1,45 @@
+#!/usr/bin/env bash
+
+{
+# Benchmark of the A-MPDU aggregation of DL MU PPDUs: 37 users at 80 MHz with 256-MPDU
+# BA windows, with and without balanced aggregation. Prints the wall-clock aggregation
+# time per DL MU PPDU, the MPDUs aggregated per PPDU, the MPDUs per PSDU of the users
+# other than the longest one of their PPDU and the throughput. Exits with an error if
+# balanced aggregation does not make the A-MPDUs of these other users shorter.
+channelWidth=${1:-80}
+clients=${2:-37}
+mkdir -p logs
+
+declare -A secondary=()
+printf "%-9s %14s %14s %14s %14s\n" balanced "us/PPDU" "MPDUs/PPDU" "MPDUs/other" "Mb/s"
+for balanced in 0 1; do
+    log=logs/aggregation_"$channelWidth"mhz_"$clients"c_"$balanced".log
+    ../../ns3 run src/saw.cc -- --channelWidth="$channelWidth" --clients="$clients" --downlink=1 \
+        --useExtendedBlockAck=1 --enablePcap=0 --cache=0 \
+        --ns3::RrMultiUserScheduler::BalancedDlAmpdu="$balanced" "${@:3}" >"$log" 2>&1 \
+        || { echo "FAILED: $log"; exit 1; }
+    awk -v balanced="$balanced" '
+        /^Scheduler after/ {
+            for (i = 1; i <= NF; i++) {
+                split($i, kv, "=")
+                counters[kv[1]] = kv[2]
+            }
+        }
+        /\(Total\)/ { tput = $6 }
+        END {
+            ppdus = counters["DlMuPpdus"]
+            printf "%-9s %14.2f %14.2f %14.2f %14s\n", balanced, counters["AggregationUsPerPpdu"],
+                (ppdus > 0 ? counters["AggregatedMpdus"] / ppdus : 0),
+                counters["SecondaryMpdusPerPsdu"], tput
+        }' "$log"
+    secondary[$balanced]=$(grep '^Scheduler after' "$log" | tr ' ' '\n' \
+        | awk -F= '$1 == "SecondaryMpdusPerPsdu" { print $2 }')
+done
+
+if awk -v off="${secondary[0]}" -v on="${secondary[1]}" 'BEGIN { exit !(on < off) }'; then
+    echo "PASS: the other A-MPDUs are shorter with balanced aggregation"
+else
+    echo "FAIL: the other A-MPDUs are not shorter with balanced aggregation"
+    exit 1
+fi
+}
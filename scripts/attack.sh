@@ -0,0 +1,75 @@
+#!/usr/bin/env bash
+
+{
+# Impact of misbehaving clients on the others. For each misbehavior and number of
+# clients, the first `attackers` clients misbehave and the run is compared with the one
+# where every client is well-behaved. Prints the mean throughput and application p99
+# delay of the victims (the well-behaved clients) in both runs, and the scheduler
+# overhead of the attack: the BSRP to data airtime ratio, the unsolicited skips and the
+# wall-clock time of the run. Exits with an error if any run failed.
+misbehaviors=(bsr skip trigger ba)
+clientCounts=(1 2 4 8 16 32 74)
+attackers=${1:-1}
+channelWidth=${2:-160}
+simulationTime=${3:-2}
+mkdir -p logs
+failed=0
+
+# Print the victims' mean throughput and p99 delay, the BSRP to data ratio, the
+# unsolicited skips and the wall-clock time of the run of the given log
+summarize() {
+    awk -v attackers="$1" '
+        /\(Client\[/ {
+            i = substr($8, 9) + 0
+            if (i >= attackers) { tput += $6; n++ }
+        }
+        /^Client\[.*\] delay/ {
+            i = substr($1, 8) + 0
+            for (f = 1; f <= NF; f++) if ($f == "application") { split($(f + 2), kv, "=") }
+            if (i >= attackers) { p99 += kv[2] + 0 }
+        }
+        /^Scheduler after/ {
+            for (f = 1; f <= NF; f++) {
+                split($f, kv, "=")
+                counters[kv[1]] = kv[2]
+            }
+        }
+        / events in / { wall = $4 }
+        END {
+            if (n > 0) printf "%.2f %.2f", tput / n, p99 / n; else printf "- -"
+            printf " %.3f %d %.3f\n", counters["BsrpToDataRatio"], counters["UnsolicitedSkips"], wall
+        }' "$2"
+}
+
+# Run saw.cc with the given misbehavior and print the summary of the run
+run() {
+    local log=logs/attack_"$clients"c_"$attackers"a_"$channelWidth"mhz_"$1".log
+    if ! ../../ns3 run src/saw.cc -- --channelWidth="$channelWidth" --clients="$clients" \
+        --attack="$1" --attackers="$attackers" --latency=1 --simulationTime="$simulationTime" \
+        --enablePcap=0 --cache=0 "${extraArgs[@]}" >"$log" 2>&1; then
+        echo "FAILED: $log" >&2
+        return 1
+    fi
+    summarize "$attackers" "$log"
+}
+
+extraArgs=("${@:4}")
+printf "%-8s %-8s %12s %12s %10s %10s %10s %10s %8s %8s\n" clients attack "base (Mb/s)" \
+    "att (Mb/s)" "base p99" "att p99" "base bsrp" "att bsrp" skips "wall x"
+for clients in "${clientCounts[@]}"; do
+    if [ "$clients" -lt "$attackers" ]; then
+        continue
+    fi
+    base=$(run none) || { failed=1; base=""; }
+    read -r baseTput baseP99 baseBsrp _ baseWall <<<"${base:-- - - - -}"
+    for misbehavior in "${misbehaviors[@]}"; do
+        att=$(run "$misbehavior") || { failed=1; att=""; }
+        read -r attTput attP99 attBsrp attSkips attWall <<<"${att:-- - - - -}"
+        printf "%-8s %-8s %12s %12s %10s %10s %10s %10s %8s %8s\n" "$clients" "$misbehavior" \
+            "$baseTput" "$attTput" "$baseP99" "$attP99" "$baseBsrp" "$attBsrp" "$attSkips" \
+            "$(awk -v a="$baseWall" -v b="$attWall" \
+                'BEGIN { if (a > 0 && b != "-") printf "%.2f", b / a; else print "-" }')"
+    done
+done
+exit $failed
+}
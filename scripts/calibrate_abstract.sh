@@ -0,0 +1,80 @@
+#!/usr/bin/env bash
+
+{
+# Calibration of the abstracted PHY against the full Spectrum PHY. Each point is run
+# with both PHY models, in both directions, and the report gives the total throughput,
+# the Jain's fairness index of the clients, the MU scheduling decisions and the
+# wall-clock time of both runs, with the relative throughput error and the speedup of the
+# abstracted PHY. Points whose throughput error exceeds the tolerance (in %) are flagged.
+# With isolate=1, the abstracted PHY also removes the links between the stations, which
+# is faster but changes their EDCA contention (UL SU, hidden nodes), hence the error.
+# Exits with an error if any run failed.
+clientCounts=(8 16 32 74)
+channelWidth=${1:-160}
+simulationTime=${2:-2}
+tolerance=${3:-5}
+isolate=${4:-0}
+mkdir -p logs
+report=logs/calibration_abstract$([ "$isolate" == 1 ] && echo _isolated).csv
+failed=0
+
+# Print the total throughput, the fairness index, the MU decisions and the wall-clock
+# time of the run of the given log
+summarize() {
+    awk '
+        /\(Client\[/ { sum += $6; sumSq += $6 * $6; n++ }
+        /\(Total\)/ { total = $6 }
+        /^Scheduler after/ {
+            for (f = 1; f <= NF; f++) {
+                split($f, kv, "=")
+                counters[kv[1]] = kv[2]
+            }
+        }
+        / events in / { wall = $4 }
+        END {
+            printf "%s %.3f %d %.3f\n", total, (sumSq > 0 ? sum * sum / (n * sumSq) : 0),
+                counters["MuDecisions"], wall
+        }' "$1"
+}
+
+echo "direction,n_clients,spectrum_mbps,abstract_mbps,tput_error_pct,spectrum_jain,abstract_jain,spectrum_decisions,abstract_decisions,spectrum_wall_s,abstract_wall_s,speedup" >"$report"
+printf "%-9s %-8s %12s %12s %8s %7s %7s %9s %8s\n" direction clients "spec (Mb/s)" \
+    "abst (Mb/s)" error "jain S" "jain A" decisions speedup
+for downlink in 1 0; do
+    direction=$([ "$downlink" == 1 ] && echo DL || echo UL)
+    for clients in "${clientCounts[@]}"; do
+        declare -A stats=()
+        for phyModel in Spectrum Abstract; do
+            log=logs/calibration_"$direction"_"$clients"c_"$channelWidth"mhz_"$phyModel".log
+            isolation=()
+            if [ "$phyModel" == Abstract ] && [ "$isolate" == 1 ]; then
+                log=${log%.log}_isolated.log
+                isolation=(--isolateClients=1)
+            fi
+            if ! ../../ns3 run src/saw.cc -- --phyModel="$phyModel" --channelWidth="$channelWidth" \
+                --clients="$clients" --downlink="$downlink" --simulationTime="$simulationTime" \
+                --enablePcap=0 --cache=0 "${isolation[@]}" "${@:5}" >"$log" 2>&1; then
+                echo "FAILED: $log"
+                failed=1
+                continue
+            fi
+            stats[$phyModel]=$(summarize "$log")
+        done
+        read -r specTput specJain specDecisions specWall <<<"${stats[Spectrum]:-- - - -}"
+        read -r abstTput abstJain abstDecisions abstWall <<<"${stats[Abstract]:-- - - -}"
+        error=$(awk -v a="$specTput" -v b="$abstTput" \
+            'BEGIN { if (a > 0 && b != "-") printf "%+.1f", 100 * (b - a) / a; else print "-" }')
+        speedup=$(awk -v a="$specWall" -v b="$abstWall" \
+            'BEGIN { if (a > 0 && b > 0) printf "%.1f", a / b; else print "-" }')
+        flag=$(awk -v e="$error" -v t="$tolerance" \
+            'BEGIN { if (e != "-" && (e > t || -e > t)) print "*"; else print "" }')
+        printf "%-9s %-8s %12s %12s %7s%% %7s %7s %4s/%-4s %7sx %s\n" "$direction" "$clients" \
+            "$specTput" "$abstTput" "$error" "$specJain" "$abstJain" "$specDecisions" \
+            "$abstDecisions" "$speedup" "$flag"
+        echo "$direction,$clients,$specTput,$abstTput,$error,$specJain,$abstJain,$specDecisions,$abstDecisions,$specWall,$abstWall,$speedup" >>"$report"
+        unset stats
+    done
+done
+echo "Points flagged with * differ by more than $tolerance% (report in $report)"
+exit $failed
+}
@@ -0,0 +1,43 @@
+#!/usr/bin/env bash
+
+{
+# Regression harness for the central 26-tone RUs. For each width, the number of clients
+# exceeds the number of equal-sized RUs (e.g., 5 clients at 20 MHz get four 52-tone RUs
+# plus the central 26-tone RU), so that every MU PPDU can use the central RUs. Each
+# point is run with and without central RUs, in both directions, with the RU allocation
+# checked on every MU PPDU (the run aborts on overlapping or out-of-band RUs). Prints the
+# throughput gain of the central RUs and exits with an error if any run failed. The last
+# point is a single client at 160 MHz, which gets the 2x996-tone RU.
+points=(20:5 40:10 80:21 160:42 160:1)
+simulationTime=${1:-2}
+mkdir -p logs
+failed=0
+
+printf "%-8s %-9s %-8s %12s %12s %8s\n" width direction clients "off (Mb/s)" "on (Mb/s)" gain
+for point in "${points[@]}"; do
+    width=${point%%:*}
+    clients=${point##*:}
+    for downlink in 1 0; do
+        direction=$([ "$downlink" == 1 ] && echo DL || echo UL)
+        declare -A tput=()
+        for central in 0 1; do
+            log=logs/central26_"$width"mhz_"$clients"c_"$direction"_"$central".log
+            if ! ../../ns3 run src/saw.cc -- --channelWidth="$width" --clients="$clients" \
+                --downlink="$downlink" --useCentral26TonesRus="$central" \
+                --simulationTime="$simulationTime" --enablePcap=0 \
+                --ns3::RrMultiUserScheduler::ValidateRus=true "${@:2}" >"$log" 2>&1; then
+                echo "FAILED: $log"
+                failed=1
+                continue
+            fi
+            tput[$central]=$(awk '/\(Total\)/ { t = $6 } END { print t }' "$log")
+        done
+        printf "%-8s %-9s %-8s %12s %12s %8s\n" "$width" "$direction" "$clients" \
+            "${tput[0]:--}" "${tput[1]:--}" \
+            "$(awk -v a="${tput[0]}" -v b="${tput[1]}" \
+                'BEGIN { if (a > 0 && b != "") printf "%+.1f%%", 100 * (b - a) / a; else print "-" }')"
+        unset tput
+    done
+done
+exit $failed
+}
@@ -5,7 +5,7 @@ set -x
 clients=(1 2 4 8)
 # Check if the first argument is provided
 if [ -z "$1" ]; then
-    echo "Usage: $0 <ofdm|ofdma>"
+    echo "Usage: $0 <ofdm|ofdma> [extra saw.cc options]"
     exit 1
 fi
 
@@ -19,9 +19,14 @@ else
     exit 1
 fi
 
-# Loop through each client number
+# Loop through each client number. Runs already simulated with the same configuration
+# and build are taken from the result cache (see --cacheInspect and --cacheEvict), in
+# which case no capture is produced.
 for clients in "${clients[@]}"; do
-    ../../ns3 run src/saw.cc -- --clients="$clients" --enableUlOfdma="$enableUlOfdma" | tee logs/"$1"_"$clients"c.log
-    mv ../../ap.pcap  ~/Desktop/"$1"_"$clients"c.pcap
+    ../../ns3 run src/saw.cc -- --clients="$clients" --enableUlOfdma="$enableUlOfdma" --cache=1 "${@:2}" \
+        | tee logs/"$1"_"$clients"c.log
+    if [ -f ../../ap.pcap ]; then
+        mv ../../ap.pcap  ~/Desktop/"$1"_"$clients"c.pcap
+    fi
 done
 }
\ No newline at end of file
@@ -0,0 +1,18 @@
+#!/usr/bin/env bash
+set -x
+
+{
+# Large-scale regression sweep: multiple BSSs with hundreds of stations each.
+# Reports events/s and memory per station in data/rr_perf_*.csv.
+aps=(1 2 4)
+clients=(50 100 200)
+layout=${1:-disc}
+
+for nAps in "${aps[@]}"; do
+    for nClients in "${clients[@]}"; do
+        ../../ns3 run src/saw.cc -- --nAps="$nAps" --clients="$nClients" --layout="$layout" \
+            --distance=10 --apSpacing=30 --enablePcap=0 --simulationTime=5 \
+            | tee logs/scale_"$layout"_"$nAps"ap_"$nClients"c.log
+    done
+done
+}
@@ -0,0 +1,27 @@
+#!/usr/bin/env bash
+set -x
+
+{
+# Run the jobs of a scenario file as independent processes, e.g.:
+#   ./scenario.sh scenarios/example.toml [parallel jobs]
+# Each job writes its own data/rr_*_job<N>.csv files.
+if [ -z "$1" ]; then
+    echo "Usage: $0 <scenario file> [parallel jobs]"
+    exit 1
+fi
+scenario=$(realpath "$1")
+parallel=${2:-$(nproc)}
+
+# Build once, and validate every job, before running any of them
+../../ns3 build || exit 1
+nJobs=$(../../ns3 run src/saw.cc -- --scenario="$scenario" --listJobs | grep -c '^job ')
+if [ "$nJobs" -eq 0 ]; then
+    echo "No job in $scenario"
+    exit 1
+fi
+
+name=$(basename "$scenario" .toml)
+seq 0 $((nJobs - 1)) | xargs -P "$parallel" -I{} \
+    sh -c '../../ns3 run --no-build src/saw.cc -- --scenario="$0" --job={} > logs/"$1"_job{}.log 2>&1' \
+    "$scenario" "$name"
+}
@@ -0,0 +1,34 @@
+#!/usr/bin/env bash
+
+{
+# Benchmark of the UL length computation of the Trigger Frames: UL OFDMA with many
+# clients, with and without the memoized TB PPDU durations. Prints the wall-clock time
+# spent computing the TB PPDU durations per Trigger Frame, the cache hit ratio and the
+# throughput, which must not change.
+channelWidth=${1:-160}
+clients=${2:-74}
+mkdir -p logs
+
+printf "%-6s %14s %10s %10s %14s\n" cache "us/TF" TFs "hits (%)" "Mb/s"
+for cache in 0 1; do
+    log=logs/tx_duration_"$channelWidth"mhz_"$clients"c_"$cache".log
+    ../../ns3 run src/saw.cc -- --channelWidth="$channelWidth" --clients="$clients" --downlink=0 \
+        --enablePcap=0 --cache=0 \
+        --ns3::RrMultiUserScheduler::TxDurationCache="$cache" "${@:3}" >"$log" 2>&1 \
+        || { echo "FAILED: $log"; exit 1; }
+    awk -v cache="$cache" '
+        /^Scheduler after/ {
+            for (i = 1; i <= NF; i++) {
+                split($i, kv, "=")
+                counters[kv[1]] = kv[2]
+            }
+        }
+        /\(Total\)/ { tput = $6 }
+        END {
+            lookups = counters["TxDurationHits"] + counters["TxDurationMisses"]
+            printf "%-6s %14.2f %10d %10.1f %14s\n", cache, counters["TfSizingUsPerTf"],
+                counters["SizedTriggerFrames"],
+                (lookups > 0 ? 100 * counters["TxDurationHits"] / lookups : 0), tput
+        }' "$log"
+done
+}
@@ -0,0 +1,159 @@
+#include "abstract_phy.h"
+
+#include "ns3/abort.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/wifi-utils.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("AbstractPhy");
+
+NS_OBJECT_ENSURE_REGISTERED(ThresholdErrorRateModel);
+NS_OBJECT_ENSURE_REGISTERED(ApCentricPropagationLossModel);
+
+TypeId
+ThresholdErrorRateModel::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::ThresholdErrorRateModel")
+            .SetParent<ErrorRateModel>()
+            .SetGroupName("Wifi")
+            .AddConstructor<ThresholdErrorRateModel>()
+            .AddAttribute("MarginDb",
+                          "Margin in dB added to the minimum SNR of every MCS",
+                          DoubleValue(0),
+                          MakeDoubleAccessor(&ThresholdErrorRateModel::m_marginDb),
+                          MakeDoubleChecker<double>());
+    return tid;
+}
+
+ThresholdErrorRateModel::ThresholdErrorRateModel()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+double
+ThresholdErrorRateModel::GetThresholdDb(WifiMode mode) const
+{
+    auto codeRate = mode.GetCodeRate();
+    if (codeRate == WIFI_CODE_RATE_UNDEFINED)
+    {
+        return m_marginDb; // DSSS/CCK
+    }
+    double thresholdDb = 0;
+    switch (mode.GetConstellationSize())
+    {
+    case 2:
+        thresholdDb = (codeRate == WIFI_CODE_RATE_1_2 ? 1 : 3);
+        break;
+    case 4:
+        thresholdDb = (codeRate == WIFI_CODE_RATE_1_2 ? 4 : 7);
+        break;
+    case 16:
+        thresholdDb = (codeRate == WIFI_CODE_RATE_1_2 ? 10 : 14);
+        break;
+    case 64:
+        thresholdDb = (codeRate == WIFI_CODE_RATE_2_3   ? 18
+                       : codeRate == WIFI_CODE_RATE_3_4 ? 19.5
+                                                        : 21);
+        break;
+    case 256:
+        thresholdDb = (codeRate == WIFI_CODE_RATE_3_4 ? 25.5 : 27.5);
+        break;
+    case 1024:
+        thresholdDb = (codeRate == WIFI_CODE_RATE_3_4 ? 31 : 33);
+        break;
+    default:
+        NS_ABORT_MSG("No SNR threshold for " << mode);
+    }
+    return thresholdDb + m_marginDb;
+}
+
+double
+ThresholdErrorRateModel::DoGetChunkSuccessRate(WifiMode mode,
+                                               const WifiTxVector& txVector,
+                                               double snr,
+                                               uint64_t nbits,
+                                               uint8_t numRxAntennas,
+                                               WifiPpduField field,
+                                               uint16_t staId) const
+{
+    return (RatioToDb(snr) >= GetThresholdDb(mode) ? 1.0 : 0.0);
+}
+
+TypeId
+ApCentricPropagationLossModel::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::ApCentricPropagationLossModel")
+            .SetParent<PropagationLossModel>()
+            .SetGroupName("Propagation")
+            .AddConstructor<ApCentricPropagationLossModel>()
+            .AddAttribute("IsolationLoss",
+                          "The loss in dB of the links between two stations, replacing the "
+                          "wrapped model if positive. The stations then cannot sense each "
+                          "other, which changes their EDCA contention",
+                          DoubleValue(0),
+                          MakeDoubleAccessor(&ApCentricPropagationLossModel::m_isolationLossDb),
+                          MakeDoubleChecker<double>(0));
+    return tid;
+}
+
+ApCentricPropagationLossModel::ApCentricPropagationLossModel()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+ApCentricPropagationLossModel::SetModel(Ptr<PropagationLossModel> model)
+{
+    NS_LOG_FUNCTION(this << model);
+    m_model = model;
+}
+
+void
+ApCentricPropagationLossModel::AddAp(uint32_t nodeId)
+{
+    NS_LOG_FUNCTION(this << nodeId);
+    m_aps.insert(nodeId);
+}
+
+void
+ApCentricPropagationLossModel::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_model = nullptr;
+    PropagationLossModel::DoDispose();
+}
+
+bool
+ApCentricPropagationLossModel::IsAp(Ptr<MobilityModel> mobility) const
+{
+    auto node = mobility->GetObject<Node>();
+    NS_ABORT_MSG_IF(!node, "The mobility model is not aggregated to a node");
+    return m_aps.count(node->GetId()) > 0;
+}
+
+double
+ApCentricPropagationLossModel::DoCalcRxPower(double txPowerDbm,
+                                             Ptr<MobilityModel> a,
+                                             Ptr<MobilityModel> b) const
+{
+    NS_ABORT_MSG_IF(!m_model, "No propagation loss model for the links of the APs");
+    if (m_isolationLossDb > 0 && !IsAp(a) && !IsAp(b))
+    {
+        return txPowerDbm - m_isolationLossDb;
+    }
+    return m_model->CalcRxPower(txPowerDbm, a, b);
+}
+
+int64_t
+ApCentricPropagationLossModel::DoAssignStreams(int64_t stream)
+{
+    return (m_model ? m_model->AssignStreams(stream) : 0);
+}
+
+} // namespace ns3
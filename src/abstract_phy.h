@@ -0,0 +1,101 @@
+#ifndef ABSTRACT_PHY_H
+#define ABSTRACT_PHY_H
+
+#include "ns3/error-rate-model.h"
+#include "ns3/mobility-model.h"
+#include "ns3/propagation-loss-model.h"
+
+#include <cstdint>
+#include <set>
+
+namespace ns3
+{
+
+/**
+ * Table-driven error rate model of the abstracted PHY: a chunk is received if the SNR
+ * is at least the threshold of its modulation and coding rate (plus a margin), and lost
+ * otherwise, whatever its size. The thresholds are the usual minimum SNRs of the
+ * 802.11 MCSs (about 10% PER for a 1500-byte PSDU), hence the PER curves of the other
+ * models are not evaluated.
+ */
+class ThresholdErrorRateModel : public ErrorRateModel
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+    ThresholdErrorRateModel();
+
+    /**
+     * \param mode the mode of a chunk
+     * \return the minimum SNR in dB for the chunk to be received, including the margin
+     */
+    double GetThresholdDb(WifiMode mode) const;
+
+  private:
+    double DoGetChunkSuccessRate(WifiMode mode,
+                                 const WifiTxVector& txVector,
+                                 double snr,
+                                 uint64_t nbits,
+                                 uint8_t numRxAntennas,
+                                 WifiPpduField field,
+                                 uint16_t staId) const override;
+
+    double m_marginDb; //!< margin added to the thresholds, in dB
+};
+
+/**
+ * Propagation loss model of the abstracted PHY: the links involving an AP use the
+ * wrapped model and, if the IsolationLoss attribute is positive, the links between two
+ * stations have this fixed loss instead. Combined with a MaxLossDb attribute of the
+ * spectrum channel below the isolation loss, the signals of the stations are only
+ * delivered to the APs, hence a TB PPDU from N stations makes N receptions instead of
+ * N^2. The isolation changes the results though: the stations can no longer sense each
+ * other, hence their EDCA accesses (UL SU and the contention with the AP) never defer to
+ * each other and there are no hidden-node collisions between them. It is thus off by
+ * default.
+ */
+class ApCentricPropagationLossModel : public PropagationLossModel
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+    ApCentricPropagationLossModel();
+
+    /**
+     * \param model the model of the links involving an AP
+     */
+    void SetModel(Ptr<PropagationLossModel> model);
+    /**
+     * \param nodeId the ID of the node of an AP
+     */
+    void AddAp(uint32_t nodeId);
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    double DoCalcRxPower(double txPowerDbm,
+                         Ptr<MobilityModel> a,
+                         Ptr<MobilityModel> b) const override;
+    int64_t DoAssignStreams(int64_t stream) override;
+
+    /**
+     * \param mobility the mobility model of a node
+     * \return whether the node is an AP
+     */
+    bool IsAp(Ptr<MobilityModel> mobility) const;
+
+    Ptr<PropagationLossModel> m_model; //!< the model of the links involving an AP
+    std::set<uint32_t> m_aps;          //!< the IDs of the nodes of the APs
+    double m_isolationLossDb;          //!< the loss of the links between two stations (0: off)
+};
+
+} // namespace ns3
+
+#endif /* ABSTRACT_PHY_H */
@@ -0,0 +1,536 @@
+#include "async_log.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <pthread.h>
+#include <unistd.h>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("AsyncLogWriter");
+
+namespace
+{
+
+/// number of forks the current process descends from
+std::atomic<uint64_t> g_forks{0};
+
+/**
+ * \return the number of forks the current process descends from, counting them from
+ *         the first call on
+ */
+uint64_t
+GetForkGeneration()
+{
+    static const bool registered =
+        (pthread_atfork(nullptr, nullptr, [] { g_forks.fetch_add(1); }) == 0);
+    NS_ABORT_MSG_IF(!registered, "Failed to register the fork handler of the writer");
+    return g_forks.load();
+}
+
+/**
+ * Write a segment of a ring to a file descriptor.
+ *
+ * \param fd the file descriptor
+ * \param data the segment
+ * \param size the size of the segment
+ * \return false if the write failed
+ */
+bool
+WriteSegment(int fd, const char* data, std::size_t size)
+{
+    std::size_t written = 0;
+    while (written < size)
+    {
+        ssize_t ret = write(fd, data + written, size - written);
+        if (ret < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (ret <= 0)
+        {
+            return false;
+        }
+        written += ret;
+    }
+    return true;
+}
+
+} // namespace
+
+AsyncLogWriter::AsyncLogWriter(std::size_t ringBytes)
+    : m_ringBytes(4096),
+      m_generation(GetForkGeneration())
+{
+    NS_LOG_FUNCTION(this << ringBytes);
+    while (m_ringBytes < ringBytes)
+    {
+        m_ringBytes *= 2;
+    }
+    m_thread = std::thread(&AsyncLogWriter::Run, this);
+}
+
+AsyncLogWriter::~AsyncLogWriter()
+{
+    NS_LOG_FUNCTION(this);
+    for (std::size_t i = 0; i < m_nSinks.load(); i++)
+    {
+        if (!m_sinks[i]->closed.load(std::memory_order_acquire))
+        {
+            m_sinks[i]->closing.store(true, std::memory_order_release);
+        }
+    }
+    Flush();
+    m_stop.store(true, std::memory_order_release);
+    Wake();
+    m_thread.join();
+}
+
+AsyncLogWriter::Policy
+AsyncLogWriter::ParsePolicy(const std::string& policy)
+{
+    NS_ABORT_MSG_IF(policy != "Block" && policy != "Drop",
+                    "Invalid back-pressure policy: " << policy << " (must be Block or Drop)");
+    return (policy == "Block" ? BLOCK : DROP);
+}
+
+int
+AsyncLogWriter::Open(const std::string& path, Policy policy)
+{
+    NS_LOG_FUNCTION(this << path << policy);
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    return AddSink(fd, path, true, policy);
+}
+
+int
+AsyncLogWriter::OpenFd(int fd, const std::string& name, Policy policy)
+{
+    NS_LOG_FUNCTION(this << fd << name << policy);
+    return AddSink(fd, name, false, policy);
+}
+
+int
+AsyncLogWriter::AddSink(int fd, const std::string& name, bool owned, Policy policy)
+{
+    // the slot of a sink closed by the writer thread is reused: the thread skips it
+    // until it is published again by clearing its closed flag
+    std::size_t n = m_nSinks.load(std::memory_order_relaxed);
+    std::size_t slot = 0;
+    while (slot < n && !m_sinks[slot]->closed.load(std::memory_order_acquire))
+    {
+        slot++;
+    }
+    NS_ABORT_MSG_IF(slot == MAX_SINKS, "Too many open sinks (at most " << MAX_SINKS << ")");
+
+    bool added = (slot == n);
+    if (added)
+    {
+        m_sinks[slot] = std::make_unique<Sink>();
+        m_sinks[slot]->ring = std::make_unique<char[]>(m_ringBytes);
+    }
+    auto& sink = *m_sinks[slot];
+    sink.name = name;
+    sink.fd = fd;
+    sink.owned = owned;
+    sink.policy = policy;
+    sink.head.store(0, std::memory_order_relaxed);
+    sink.tail.store(0, std::memory_order_relaxed);
+    sink.closing.store(false, std::memory_order_relaxed);
+    if (added)
+    {
+        m_nSinks.store(n + 1, std::memory_order_release);
+    }
+    else
+    {
+        sink.closed.store(false, std::memory_order_release);
+    }
+    return static_cast<int>(slot);
+}
+
+AsyncLogWriter::Sink&
+AsyncLogWriter::GetSink(int sink)
+{
+    NS_ABORT_MSG_IF(sink < 0 || static_cast<std::size_t>(sink) >= m_nSinks.load() ||
+                        m_sinks[sink]->closing.load(std::memory_order_relaxed),
+                    "Sink " << sink << " is not open");
+    return *m_sinks[sink];
+}
+
+void
+AsyncLogWriter::Close(int sink)
+{
+    NS_LOG_FUNCTION(this << sink);
+    GetSink(sink).closing.store(true, std::memory_order_release);
+    Wake();
+}
+
+bool
+AsyncLogWriter::Append(int sinkId, const char* data, std::size_t size)
+{
+    if (m_generation != g_forks.load(std::memory_order_relaxed))
+    {
+        return false; // inert copy in a forked worker
+    }
+    auto& sink = GetSink(sinkId);
+    m_stats.records++;
+    uint64_t head = sink.head.load(std::memory_order_relaxed);
+
+    // copy the given bytes at the head of the ring, which has room for them
+    auto copy = [&](const char* bytes, std::size_t n) {
+        std::size_t offset = head & (m_ringBytes - 1);
+        std::size_t first = std::min(n, m_ringBytes - offset);
+        std::memcpy(sink.ring.get() + offset, bytes, first);
+        std::memcpy(sink.ring.get(), bytes + first, n - first);
+        head += n;
+        sink.head.store(head, std::memory_order_release);
+    };
+
+    if (sink.policy == DROP)
+    {
+        if (size > m_ringBytes - (head - sink.tail.load(std::memory_order_acquire)))
+        {
+            m_stats.droppedRecords++;
+            m_stats.droppedBytes += size;
+            Wake();
+            return false;
+        }
+        copy(data, size);
+    }
+    else
+    {
+        std::chrono::steady_clock::time_point stallStart;
+        bool stalled = false;
+        while (size > 0)
+        {
+            std::size_t room = m_ringBytes - (head - sink.tail.load(std::memory_order_acquire));
+            if (room == 0)
+            {
+                if (!stalled)
+                {
+                    stalled = true;
+                    stallStart = std::chrono::steady_clock::now();
+                    m_stats.stalls++;
+                }
+                Wake();
+                std::this_thread::yield();
+                continue;
+            }
+            std::size_t n = std::min(size, room);
+            copy(data, n);
+            data += n;
+            size -= n;
+        }
+        if (stalled)
+        {
+            m_stats.stallSeconds += std::chrono::duration<double>(
+                                        std::chrono::steady_clock::now() - stallStart)
+                                        .count();
+        }
+    }
+
+    // the writer thread polls the rings, it is only woken up early if they fill up
+    if (head - sink.tail.load(std::memory_order_relaxed) >= m_ringBytes / 2)
+    {
+        Wake();
+    }
+    return true;
+}
+
+void
+AsyncLogWriter::Wake()
+{
+    if (!m_pending.exchange(true, std::memory_order_acq_rel))
+    {
+        m_wakeUp.notify_one();
+    }
+}
+
+bool
+AsyncLogWriter::IsDrained() const
+{
+    for (std::size_t i = 0; i < m_nSinks.load(std::memory_order_acquire); i++)
+    {
+        const auto& sink = *m_sinks[i];
+        if (sink.closed.load(std::memory_order_acquire))
+        {
+            continue;
+        }
+        if (sink.head.load(std::memory_order_acquire) !=
+                sink.tail.load(std::memory_order_acquire) ||
+            sink.closing.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+AsyncLogWriter::Flush()
+{
+    NS_LOG_FUNCTION(this);
+    if (m_generation != g_forks.load(std::memory_order_relaxed))
+    {
+        return; // the writer thread is not running in a forked worker
+    }
+    while (!IsDrained())
+    {
+        Wake();
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    auto stats = GetStats();
+    if (stats.stalls != m_reported.stalls || stats.droppedRecords != m_reported.droppedRecords)
+    {
+        std::cerr << "Output outran the writer (" << m_ringBytes / 1024 << " KiB rings): "
+                  << stats.stalls - m_reported.stalls << " records waited "
+                  << stats.stallSeconds - m_reported.stallSeconds << " s for room, "
+                  << stats.droppedRecords - m_reported.droppedRecords << " records ("
+                  << stats.droppedBytes - m_reported.droppedBytes << " bytes) dropped"
+                  << std::endl;
+    }
+    m_reported = stats;
+}
+
+AsyncLogWriter::Stats
+AsyncLogWriter::GetStats() const
+{
+    Stats stats = m_stats;
+    stats.bytes = m_bytes.load(std::memory_order_relaxed);
+    stats.writes = m_writes.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void
+AsyncLogWriter::Run()
+{
+    while (true)
+    {
+        bool wrote = false;
+        for (std::size_t i = 0; i < m_nSinks.load(std::memory_order_acquire); i++)
+        {
+            wrote |= Drain(*m_sinks[i]);
+        }
+        if (wrote)
+        {
+            continue;
+        }
+        if (m_stop.load(std::memory_order_acquire))
+        {
+            return;
+        }
+        // wait a bit for the rings to fill, so that the writes are large
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wakeUp.wait_for(lock, std::chrono::milliseconds(10), [this] {
+            return m_pending.load(std::memory_order_acquire);
+        });
+        m_pending.store(false, std::memory_order_release);
+    }
+}
+
+bool
+AsyncLogWriter::Drain(Sink& sink)
+{
+    if (sink.closed.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    // nothing is appended once the sink is closing, hence the head read afterwards is
+    // the final one
+    bool closing = sink.closing.load(std::memory_order_acquire);
+    uint64_t tail = sink.tail.load(std::memory_order_relaxed);
+    uint64_t head = sink.head.load(std::memory_order_acquire);
+
+    if (head != tail)
+    {
+        std::size_t offset = tail & (m_ringBytes - 1);
+        std::size_t size = head - tail;
+        std::size_t first = std::min(size, m_ringBytes - offset);
+        NS_ABORT_MSG_IF(!WriteSegment(sink.fd, sink.ring.get() + offset, first) ||
+                            !WriteSegment(sink.fd, sink.ring.get(), size - first),
+                        "Failed to write to " << sink.name << ": " << std::strerror(errno));
+        m_writes.fetch_add(first < size ? 2 : 1, std::memory_order_relaxed);
+        m_bytes.fetch_add(size, std::memory_order_relaxed);
+        sink.tail.store(head, std::memory_order_release);
+    }
+    if (closing)
+    {
+        if (sink.owned)
+        {
+            close(sink.fd);
+        }
+        sink.closed.store(true, std::memory_order_release);
+    }
+    return head != tail;
+}
+
+AsyncLogBuf::AsyncLogBuf(AsyncLogWriter* writer, int sink)
+    : m_writer(writer),
+      m_sink(sink)
+{
+}
+
+AsyncLogBuf::~AsyncLogBuf()
+{
+    sync();
+}
+
+AsyncLogWriter*
+AsyncLogBuf::GetWriter() const
+{
+    return m_writer;
+}
+
+int
+AsyncLogBuf::GetSink() const
+{
+    return m_sink;
+}
+
+int
+AsyncLogBuf::overflow(int c)
+{
+    if (c != traits_type::eof())
+    {
+        m_pending.push_back(traits_type::to_char_type(c));
+        if (m_pending.size() >= COMMIT_BYTES)
+        {
+            sync();
+        }
+    }
+    return traits_type::not_eof(c);
+}
+
+std::streamsize
+AsyncLogBuf::xsputn(const char* s, std::streamsize n)
+{
+    m_pending.append(s, n);
+    if (m_pending.size() >= COMMIT_BYTES)
+    {
+        sync();
+    }
+    return n;
+}
+
+int
+AsyncLogBuf::sync()
+{
+    if (!m_pending.empty())
+    {
+        // a dropped record is accounted for by the writer, not an error of the stream
+        m_writer->Append(m_sink, m_pending.data(), m_pending.size());
+        m_pending.clear();
+    }
+    return 0;
+}
+
+AsyncLogStream::AsyncLogStream(AsyncLogWriter* writer)
+    : std::ostream(nullptr),
+      m_writer(writer)
+{
+}
+
+AsyncLogStream::AsyncLogStream(AsyncLogWriter* writer, const std::string& path)
+    : AsyncLogStream(writer)
+{
+    open(path);
+}
+
+AsyncLogStream::~AsyncLogStream()
+{
+    close();
+}
+
+void
+AsyncLogStream::open(const std::string& path)
+{
+    close();
+    if (m_writer)
+    {
+        int sink = m_writer->Open(path);
+        if (sink >= 0)
+        {
+            m_buf = std::make_unique<AsyncLogBuf>(m_writer, sink);
+            rdbuf(m_buf.get());
+            return;
+        }
+    }
+    else if (m_fileBuf.open(path, std::ios::out | std::ios::trunc))
+    {
+        rdbuf(&m_fileBuf);
+        return;
+    }
+    setstate(std::ios::failbit);
+}
+
+bool
+AsyncLogStream::is_open() const
+{
+    return m_buf || m_fileBuf.is_open();
+}
+
+void
+AsyncLogStream::close()
+{
+    if (!is_open())
+    {
+        return;
+    }
+    flush();
+    rdbuf(nullptr);
+    if (m_buf)
+    {
+        m_buf->pubsync();
+        m_writer->Close(m_buf->GetSink());
+        m_buf.reset();
+    }
+    else
+    {
+        m_fileBuf.close();
+    }
+}
+
+AsyncLogRedirect::AsyncLogRedirect(AsyncLogWriter& writer,
+                                   std::ostream& os,
+                                   int fd,
+                                   const std::string& name,
+                                   AsyncLogWriter::Policy policy)
+    : m_os(os),
+      m_original(os.rdbuf()),
+      m_buf(&writer, writer.OpenFd(fd, name, policy))
+{
+    m_os.flush();
+    m_os.rdbuf(&m_buf);
+}
+
+AsyncLogRedirect::~AsyncLogRedirect()
+{
+    m_os.flush();
+    m_os.rdbuf(m_original);
+    m_buf.pubsync();
+    m_buf.GetWriter()->Close(m_buf.GetSink());
+}
+
+void
+FlushAsyncLog(std::ostream* os)
+{
+    os->flush();
+    if (auto buf = dynamic_cast<AsyncLogBuf*>(os->rdbuf()))
+    {
+        buf->GetWriter()->Flush();
+    }
+}
+
+} // namespace ns3
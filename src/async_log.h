@@ -0,0 +1,308 @@
+#ifndef ASYNC_LOG_H
+#define ASYNC_LOG_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+namespace ns3
+{
+
+/**
+ * Output subsystem decoupling the simulation from the file and terminal I/O.
+ *
+ * Every sink (a file or a file descriptor such as stdout) has a bounded single-producer,
+ * single-consumer ring buffer: the simulation thread copies its records into the ring
+ * without taking any lock and a background writer thread drains the rings with one large
+ * write per sink and wake-up (two halves of the ring being filled and drained at the same
+ * time). When a producer outruns the writer, i.e., the ring of a sink is full, the policy
+ * of the sink applies: BLOCK waits for the writer (no output is lost), DROP discards the
+ * record. The stalls and the dropped records are reported on stderr by Flush().
+ *
+ * Only the thread that created the writer may append to its sinks. Forked worker
+ * processes inherit an inert copy: their records are discarded and Flush() returns at
+ * once, since the writer thread is not running in them.
+ */
+class AsyncLogWriter
+{
+  public:
+    /**
+     * What to do with a record that does not fit in the ring of its sink
+     */
+    enum Policy : uint8_t
+    {
+        BLOCK, //!< wait until the writer thread made room for the record
+        DROP   //!< discard the record
+    };
+
+    /**
+     * Back-pressure and I/O counters, cumulated over all the sinks
+     */
+    struct Stats
+    {
+        uint64_t records{0};        //!< records appended
+        uint64_t bytes{0};          //!< bytes written by the writer thread
+        uint64_t writes{0};         //!< write system calls of the writer thread
+        uint64_t stalls{0};         //!< records that waited for room (BLOCK)
+        double stallSeconds{0};     //!< wall-clock time spent waiting for room
+        uint64_t droppedRecords{0}; //!< records discarded (DROP)
+        uint64_t droppedBytes{0};   //!< bytes of the discarded records
+    };
+
+    /**
+     * Start the writer thread.
+     *
+     * \param ringBytes the size of the ring of every sink, rounded up to a power of two
+     */
+    explicit AsyncLogWriter(std::size_t ringBytes);
+    /**
+     * Flush the sinks, stop the writer thread and close the files.
+     */
+    ~AsyncLogWriter();
+
+    AsyncLogWriter(const AsyncLogWriter&) = delete;
+    AsyncLogWriter& operator=(const AsyncLogWriter&) = delete;
+
+    /**
+     * \param path the path of a file, truncated
+     * \param policy the policy applied when the ring of the sink is full
+     * \return the sink writing to the file, or -1 if it cannot be opened
+     */
+    int Open(const std::string& path, Policy policy = BLOCK);
+    /**
+     * \param fd a file descriptor, which is not closed by the writer
+     * \param name the name of the sink in the error messages
+     * \param policy the policy applied when the ring of the sink is full
+     * \return the sink writing to the file descriptor
+     */
+    int OpenFd(int fd, const std::string& name, Policy policy = BLOCK);
+    /**
+     * Close a sink once the records appended to it have been written.
+     *
+     * \param sink the sink
+     */
+    void Close(int sink);
+
+    /**
+     * Append a record to a sink. Records larger than the ring are split with BLOCK and
+     * dropped with DROP.
+     *
+     * \param sink the sink
+     * \param data the record
+     * \param size the size of the record
+     * \return false if the record was discarded
+     */
+    bool Append(int sink, const char* data, std::size_t size);
+
+    /**
+     * Wait until every record appended so far has been written, and report on stderr
+     * the stalls and the dropped records since the previous flush, if any.
+     */
+    void Flush();
+
+    /**
+     * \return the counters of the writer
+     */
+    Stats GetStats() const;
+
+    /**
+     * \param policy the name of a policy (Block or Drop)
+     * \return the policy
+     */
+    static Policy ParsePolicy(const std::string& policy);
+
+  private:
+    /// max number of sinks opened over the lifetime of the writer
+    static constexpr std::size_t MAX_SINKS = 32;
+
+    /**
+     * A sink and its ring buffer. The producer only moves the head and the writer
+     * thread only moves the tail, both being cumulated byte counts.
+     */
+    struct Sink
+    {
+        std::string name;                          //!< the path of the sink, for the errors
+        int fd{-1};                                //!< the file descriptor of the sink
+        bool owned{false};                         //!< whether the writer closes the descriptor
+        Policy policy{BLOCK};                      //!< the policy of the sink
+        std::unique_ptr<char[]> ring;              //!< the ring buffer
+        alignas(64) std::atomic<uint64_t> head{0}; //!< bytes appended
+        alignas(64) std::atomic<uint64_t> tail{0}; //!< bytes written
+        std::atomic<bool> closing{false};          //!< close the descriptor once drained
+        std::atomic<bool> closed{false};           //!< the descriptor was closed
+    };
+
+    /**
+     * \param sink the sink
+     * \return the sink, checked to be open
+     */
+    Sink& GetSink(int sink);
+    /**
+     * \param fd the file descriptor of the new sink
+     * \param name the name of the sink
+     * \param owned whether the writer closes the descriptor
+     * \param policy the policy of the sink
+     * \return the new sink
+     */
+    int AddSink(int fd, const std::string& name, bool owned, Policy policy);
+    /**
+     * Wake up the writer thread, without waiting.
+     */
+    void Wake();
+    /**
+     * Body of the writer thread.
+     */
+    void Run();
+    /**
+     * Write the records of a sink not written yet (writer thread).
+     *
+     * \param sink the sink
+     * \return whether anything was written
+     */
+    bool Drain(Sink& sink);
+    /**
+     * \return whether every record appended so far has been written
+     */
+    bool IsDrained() const;
+
+    std::size_t m_ringBytes;                              //!< size of the rings
+    std::array<std::unique_ptr<Sink>, MAX_SINKS> m_sinks; //!< the sinks
+    std::atomic<std::size_t> m_nSinks{0};                 //!< sinks published to the writer
+    uint64_t m_generation;              //!< forks the process of the writer descends from
+    std::thread m_thread;               //!< the writer thread
+    std::mutex m_mutex;                 //!< mutex of the wake-up condition
+    std::condition_variable m_wakeUp;   //!< wakes the writer thread up
+    std::atomic<bool> m_pending{false}; //!< a wake-up was requested
+    std::atomic<bool> m_stop{false};    //!< stop the writer thread
+    std::atomic<uint64_t> m_bytes{0};   //!< bytes written
+    std::atomic<uint64_t> m_writes{0};  //!< write system calls
+    Stats m_stats;                      //!< producer-side counters (see m_bytes and m_writes)
+    Stats m_reported;                   //!< counters at the previous report
+};
+
+/**
+ * Stream buffer appending the characters written to it to a sink of an AsyncLogWriter.
+ * A record is appended on every flush of the stream (e.g., std::endl), or when the
+ * pending characters reach the commit size, hence the records of a DROP sink are whole
+ * lines as long as they are flushed line by line.
+ */
+class AsyncLogBuf : public std::streambuf
+{
+  public:
+    /**
+     * \param writer the writer of the sink
+     * \param sink the sink
+     */
+    AsyncLogBuf(AsyncLogWriter* writer, int sink);
+    ~AsyncLogBuf() override;
+
+    /**
+     * \return the writer of the sink
+     */
+    AsyncLogWriter* GetWriter() const;
+    /**
+     * \return the sink
+     */
+    int GetSink() const;
+
+  protected:
+    int overflow(int c) override;
+    std::streamsize xsputn(const char* s, std::streamsize n) override;
+    int sync() override;
+
+  private:
+    /// pending characters appended as a record even without a flush of the stream
+    static constexpr std::size_t COMMIT_BYTES = 64 * 1024;
+
+    AsyncLogWriter* m_writer; //!< the writer of the sink
+    int m_sink;               //!< the sink
+    std::string m_pending;    //!< characters not appended yet
+};
+
+/**
+ * Output file stream with the interface of std::ofstream used by saw.cc, writing
+ * through a BLOCK sink of an AsyncLogWriter, or through a regular file buffer if no
+ * writer is given.
+ */
+class AsyncLogStream : public std::ostream
+{
+  public:
+    /**
+     * \param writer the writer, or nullptr for synchronous output
+     */
+    explicit AsyncLogStream(AsyncLogWriter* writer);
+    /**
+     * \param writer the writer, or nullptr for synchronous output
+     * \param path the path of the file to open
+     */
+    AsyncLogStream(AsyncLogWriter* writer, const std::string& path);
+    ~AsyncLogStream() override;
+
+    /**
+     * \param path the path of the file to open
+     */
+    void open(const std::string& path);
+    /**
+     * \return whether the file is open
+     */
+    bool is_open() const;
+    /**
+     * Flush and close the file.
+     */
+    void close();
+
+  private:
+    AsyncLogWriter* m_writer;            //!< the writer, nullptr for synchronous output
+    std::unique_ptr<AsyncLogBuf> m_buf;  //!< the buffer of the sink, if open
+    std::filebuf m_fileBuf;              //!< the buffer of the synchronous output
+};
+
+/**
+ * Route a standard stream (e.g., std::cout) through a sink of an AsyncLogWriter for the
+ * lifetime of the object. The stream is flushed and restored on destruction, which must
+ * happen before the writer is destroyed.
+ */
+class AsyncLogRedirect
+{
+  public:
+    /**
+     * \param writer the writer
+     * \param os the stream to redirect
+     * \param fd the file descriptor the stream writes to
+     * \param name the name of the sink
+     * \param policy the policy of the sink
+     */
+    AsyncLogRedirect(AsyncLogWriter& writer,
+                     std::ostream& os,
+                     int fd,
+                     const std::string& name,
+                     AsyncLogWriter::Policy policy);
+    ~AsyncLogRedirect();
+
+    AsyncLogRedirect(const AsyncLogRedirect&) = delete;
+    AsyncLogRedirect& operator=(const AsyncLogRedirect&) = delete;
+
+  private:
+    std::ostream& m_os;         //!< the redirected stream
+    std::streambuf* m_original; //!< the original buffer of the stream
+    AsyncLogBuf m_buf;          //!< the buffer of the sink
+};
+
+/**
+ * Flush a stream and, if it writes through an AsyncLogWriter, wait for the writer to
+ * drain its sinks. Meant to be run by Simulator::ScheduleDestroy.
+ *
+ * \param os the stream
+ */
+void FlushAsyncLog(std::ostream* os);
+
+} // namespace ns3
+
+#endif /* ASYNC_LOG_H */
@@ -0,0 +1,134 @@
+#include "cached_loss_model.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/pointer.h"
+#include "ns3/uinteger.h"
+
+#include <cmath>
+#include <limits>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("CachedPropagationLossModel");
+
+NS_OBJECT_ENSURE_REGISTERED(CachedPropagationLossModel);
+
+TypeId
+CachedPropagationLossModel::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::CachedPropagationLossModel")
+            .SetParent<PropagationLossModel>()
+            .SetGroupName("Propagation")
+            .AddConstructor<CachedPropagationLossModel>()
+            .AddAttribute("Model",
+                          "The deterministic model whose link budgets are cached",
+                          PointerValue(),
+                          MakePointerAccessor(&CachedPropagationLossModel::SetModel),
+                          MakePointerChecker<PropagationLossModel>())
+            .AddAttribute("Hits",
+                          "Number of losses read from the cache (read-only)",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&CachedPropagationLossModel::m_nHits),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("Misses",
+                          "Number of losses computed by the wrapped model (read-only)",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&CachedPropagationLossModel::m_nMisses),
+                          MakeUintegerChecker<uint64_t>());
+    return tid;
+}
+
+CachedPropagationLossModel::CachedPropagationLossModel()
+    : m_nHits(0),
+      m_nMisses(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+CachedPropagationLossModel::SetModel(Ptr<PropagationLossModel> model)
+{
+    NS_LOG_FUNCTION(this << model);
+    m_model = model;
+    for (auto& row : m_lossDb)
+    {
+        row.assign(row.size(), std::numeric_limits<double>::quiet_NaN());
+    }
+}
+
+void
+CachedPropagationLossModel::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_model = nullptr;
+    m_indices.clear();
+    m_lossDb.clear();
+    PropagationLossModel::DoDispose();
+}
+
+std::size_t
+CachedPropagationLossModel::GetIndex(Ptr<MobilityModel> mobility) const
+{
+    auto [it, inserted] = m_indices.emplace(PeekPointer(mobility), m_lossDb.size());
+    if (inserted)
+    {
+        NS_LOG_DEBUG("New node " << mobility << " at index " << it->second);
+        for (auto& row : m_lossDb)
+        {
+            row.push_back(std::numeric_limits<double>::quiet_NaN());
+        }
+        m_lossDb.emplace_back(m_lossDb.size() + 1, std::numeric_limits<double>::quiet_NaN());
+        mobility->TraceConnectWithoutContext(
+            "CourseChange",
+            MakeCallback(&CachedPropagationLossModel::NotifyCourseChange, this));
+    }
+    return it->second;
+}
+
+void
+CachedPropagationLossModel::NotifyCourseChange(Ptr<const MobilityModel> mobility) const
+{
+    NS_LOG_FUNCTION(this << mobility);
+    auto index = m_indices.at(PeekPointer(mobility));
+    m_lossDb[index].assign(m_lossDb.size(), std::numeric_limits<double>::quiet_NaN());
+    for (auto& row : m_lossDb)
+    {
+        row[index] = std::numeric_limits<double>::quiet_NaN();
+    }
+}
+
+double
+CachedPropagationLossModel::DoCalcRxPower(double txPowerDbm,
+                                          Ptr<MobilityModel> a,
+                                          Ptr<MobilityModel> b) const
+{
+    NS_ABORT_MSG_IF(!m_model, "No propagation loss model to cache");
+    auto tx = GetIndex(a);
+    auto rx = GetIndex(b);
+    auto& lossDb = m_lossDb[tx][rx];
+    if (std::isnan(lossDb))
+    {
+        // the received power at 0 dBm is exactly the opposite of the loss, hence
+        // txPowerDbm - lossDb is what the wrapped model returns
+        lossDb = -m_model->CalcRxPower(0, a, b);
+        m_nMisses++;
+    }
+    else
+    {
+        m_nHits++;
+    }
+    return txPowerDbm - lossDb;
+}
+
+int64_t
+CachedPropagationLossModel::DoAssignStreams(int64_t stream)
+{
+    return (m_model ? m_model->AssignStreams(stream) : 0);
+}
+
+} // namespace ns3
@@ -0,0 +1,72 @@
+#ifndef CACHED_LOSS_MODEL_H
+#define CACHED_LOSS_MODEL_H
+
+#include "ns3/mobility-model.h"
+#include "ns3/propagation-loss-model.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Propagation loss model caching the link budget of every (transmitter, receiver) pair
+ * computed by a wrapped model. The loss of a pair is computed once and reused until
+ * the course of either node changes (CourseChange trace of its mobility model).
+ *
+ * The wrapped model must be deterministic and its loss must not depend on the transmit
+ * power, e.g., LogDistancePropagationLossModel, whose received power is then exactly
+ * the one of the wrapped model (chained models may differ in the last bits). Fading
+ * models such as NakagamiPropagationLossModel must not be wrapped.
+ */
+class CachedPropagationLossModel : public PropagationLossModel
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+    CachedPropagationLossModel();
+
+    /**
+     * \param model the model whose link budgets are cached
+     */
+    void SetModel(Ptr<PropagationLossModel> model);
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    double DoCalcRxPower(double txPowerDbm,
+                         Ptr<MobilityModel> a,
+                         Ptr<MobilityModel> b) const override;
+    int64_t DoAssignStreams(int64_t stream) override;
+
+    /**
+     * \param mobility the mobility model of a node
+     * \return the index of the node in the loss matrix, added if needed
+     */
+    std::size_t GetIndex(Ptr<MobilityModel> mobility) const;
+
+    /**
+     * Invalidate the links of a node whose course changed.
+     *
+     * \param mobility the mobility model of the node
+     */
+    void NotifyCourseChange(Ptr<const MobilityModel> mobility) const;
+
+    Ptr<PropagationLossModel> m_model; //!< the model whose link budgets are cached
+    mutable std::unordered_map<const MobilityModel*, std::size_t> m_indices; //!< index of
+                                                                              //!< each node
+    mutable std::vector<std::vector<double>> m_lossDb; //!< loss matrix (row: transmitter),
+                                                       //!< NaN if unknown
+    mutable uint64_t m_nHits;   //!< number of losses read from the matrix
+    mutable uint64_t m_nMisses; //!< number of losses computed by the wrapped model
+};
+
+} // namespace ns3
+
+#endif /* CACHED_LOSS_MODEL_H */
@@ -0,0 +1,115 @@
+#include "convergence.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <cmath>
+#include <numeric>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("ConvergenceController");
+
+ConvergenceController::ConvergenceController(std::size_t k,
+                                             double threshold,
+                                             Time warmup,
+                                             bool perClient)
+    : m_k(k),
+      m_threshold(threshold),
+      m_warmup(warmup),
+      m_perClient(perClient)
+{
+    NS_LOG_FUNCTION(this << k << threshold << warmup << perClient);
+    NS_ABORT_MSG_IF(k == 0, "At least one window is needed to detect convergence");
+}
+
+void
+ConvergenceController::Attach(ThroughputSampler& sampler)
+{
+    m_window = sampler.GetWindow();
+    sampler.AddWindowCallback(
+        [this](Time now, const std::vector<double>& goodput, const std::vector<double>& tput) {
+            WindowEnded(now, goodput, tput);
+        });
+}
+
+void
+ConvergenceController::WindowEnded(Time now,
+                                   const std::vector<double>& goodputMbps,
+                                   const std::vector<double>& tputMbps)
+{
+    // as in the sampler, the window straddling the end of the warm-up is not used
+    if (!m_stopTime.IsZero() || now - m_window < m_warmup)
+    {
+        return;
+    }
+
+    std::vector<double> goodput(goodputMbps);
+    goodput.push_back(std::accumulate(goodputMbps.cbegin(), goodputMbps.cend(), 0.0));
+    if (m_recentSums.empty())
+    {
+        m_recentSums.resize(goodput.size(), 0);
+        m_previousSums.resize(goodput.size(), 0);
+    }
+    m_nWindows++;
+
+    //* The window entering the last K moves the oldest of them to the K before, whose
+    //* oldest window leaves the history
+    for (std::size_t i = 0; i < goodput.size(); i++)
+    {
+        m_recentSums[i] += goodput[i];
+    }
+    m_history.push_back(std::move(goodput));
+    if (m_history.size() > m_k)
+    {
+        const auto& moved = m_history[m_history.size() - m_k - 1];
+        for (std::size_t i = 0; i < moved.size(); i++)
+        {
+            m_recentSums[i] -= moved[i];
+            m_previousSums[i] += moved[i];
+        }
+    }
+    if (m_history.size() > 2 * m_k)
+    {
+        const auto& oldest = m_history.front();
+        for (std::size_t i = 0; i < oldest.size(); i++)
+        {
+            m_previousSums[i] -= oldest[i];
+        }
+        m_history.pop_front();
+    }
+    if (m_history.size() < 2 * m_k)
+    {
+        return;
+    }
+
+    //* Both blocks have K windows, hence their sums compare like their means
+    std::size_t first = (m_perClient ? 0 : m_recentSums.size() - 1);
+    for (std::size_t i = first; i < m_recentSums.size(); i++)
+    {
+        if (m_recentSums[i] <= 0)
+        {
+            // a client that has not delivered anything lately cannot be declared converged
+            return;
+        }
+        if (std::abs(m_recentSums[i] - m_previousSums[i]) / m_recentSums[i] > m_threshold)
+        {
+            return;
+        }
+    }
+
+    NS_LOG_INFO("Throughput converged after " << m_nWindows << " windows, stopping at "
+                                              << now.As(Time::S));
+    m_stopTime = now;
+    Simulator::Stop();
+}
+
+Time
+ConvergenceController::GetStopTime() const
+{
+    return m_stopTime;
+}
+
+} // namespace ns3
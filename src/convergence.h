@@ -0,0 +1,75 @@
+#ifndef CONVERGENCE_H
+#define CONVERGENCE_H
+
+#include "tput_sampler.h"
+
+#include "ns3/nstime.h"
+
+#include <deque>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Early-termination controller for steady-state runs.
+ *
+ * The controller is fed by the windows of a ThroughputSampler and tracks the post-warm-up
+ * goodput of the aggregate and, optionally, of every client. The simulation is stopped
+ * (by calling Simulator::Stop) as soon as, for every tracked series, the mean goodput of
+ * the last K windows differs by at most the given relative threshold from the mean of
+ * the K windows before them. Unlike cumulative running means, whose changes shrink as
+ * 1/n whatever the load, the two blocks keep detecting a drift or an oscillation with a
+ * period longer than a window.
+ */
+class ConvergenceController
+{
+  public:
+    /**
+     * \param k the number of windows of each of the two compared blocks
+     * \param threshold the relative change below which a series is converged
+     * \param warmup windows starting before this time are ignored
+     * \param perClient whether every client (and not only the aggregate) must converge
+     */
+    ConvergenceController(std::size_t k, double threshold, Time warmup, bool perClient);
+
+    /**
+     * Register the controller with the given sampler.
+     *
+     * \param sampler the sampler providing the windows (must outlive the controller's use)
+     */
+    void Attach(ThroughputSampler& sampler);
+
+    /**
+     * \return the time the simulation was stopped by the controller, or zero
+     */
+    Time GetStopTime() const;
+
+  private:
+    /**
+     * Process the end of a sampler window.
+     *
+     * \param now the end of the window
+     * \param goodputMbps the per-client goodput over the window
+     * \param tputMbps the per-client throughput over the window
+     */
+    void WindowEnded(Time now,
+                     const std::vector<double>& goodputMbps,
+                     const std::vector<double>& tputMbps);
+
+    std::size_t m_k;                            //!< windows to look back
+    double m_threshold;                         //!< relative change threshold
+    Time m_warmup;                              //!< warm-up time
+    Time m_window;                              //!< sampling window of the sampler
+    bool m_perClient;                           //!< track every client, too
+    std::size_t m_nWindows{0};                  //!< number of post-warm-up windows
+    std::deque<std::vector<double>> m_history;  //!< per-client goodput of the last 2K windows
+                                                //!< (last is aggregate)
+    std::vector<double> m_recentSums;           //!< goodput sums of the last K windows
+    std::vector<double> m_previousSums;         //!< goodput sums of the K windows before
+    Time m_stopTime;                            //!< time the simulation was stopped
+};
+
+} // namespace ns3
+
+#endif /* CONVERGENCE_H */
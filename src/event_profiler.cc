@@ -0,0 +1,337 @@
+#include "event_profiler.h"
+
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <map>
+#include <memory>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("ProfilingSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED(ProfilingSimulatorImpl);
+
+/**
+ * Event timing the event it wraps
+ */
+class ProfilingSimulatorImpl::ProfiledEvent : public EventImpl
+{
+  public:
+    /**
+     * \param profiler the simulator the event is scheduled on
+     * \param event the wrapped event, whose reference is taken over
+     * \param frame the index of the frame of the wrapped event
+     */
+    ProfiledEvent(ProfilingSimulatorImpl* profiler, EventImpl* event, std::size_t frame)
+        : m_profiler(profiler),
+          m_event(event),
+          m_frame(frame)
+    {
+    }
+
+  protected:
+    ~ProfiledEvent() override
+    {
+        m_event->Unref();
+    }
+
+  private:
+    void Notify() override
+    {
+        m_profiler->Invoke(m_event, m_frame);
+    }
+
+    ProfilingSimulatorImpl* m_profiler; //!< the simulator the event is scheduled on
+    EventImpl* m_event;                 //!< the wrapped event
+    std::size_t m_frame;                //!< the index of the frame of the wrapped event
+};
+
+namespace
+{
+
+/**
+ * \param name a mangled type name
+ * \return the demangled name, or the mangled one if it cannot be demangled
+ */
+std::string
+Demangle(const char* name)
+{
+    int status = 0;
+    std::unique_ptr<char, decltype(&std::free)> demangled(
+        abi::__cxa_demangle(name, nullptr, nullptr, &status),
+        &std::free);
+    return (status == 0 ? std::string(demangled.get()) : std::string(name));
+}
+
+/**
+ * \param name a demangled name
+ * \return the name without the ns3:: qualifiers
+ */
+std::string
+StripNamespace(std::string name)
+{
+    for (auto pos = name.find("ns3::"); pos != std::string::npos; pos = name.find("ns3::", pos))
+    {
+        name.erase(pos, 5);
+    }
+    return name;
+}
+
+/**
+ * \param name a demangled name
+ * \param open the position of an opening '<' or '('
+ * \return the position of the first ',' at the same nesting level or of the matching
+ *         closing bracket (the size of the name if there is none)
+ */
+std::size_t
+FindArgumentEnd(const std::string& name, std::size_t open)
+{
+    int depth = 0;
+    for (auto pos = open + 1; pos < name.size(); pos++)
+    {
+        char c = name[pos];
+        if (c == '<' || c == '(' || c == '[' || c == '{')
+        {
+            depth++;
+        }
+        else if (c == '>' || c == ')' || c == ']' || c == '}')
+        {
+            if (depth-- == 0)
+            {
+                return pos;
+            }
+        }
+        else if (c == ',' && depth == 0)
+        {
+            return pos;
+        }
+    }
+    return name.size();
+}
+
+/**
+ * Split the demangled type of an event into the class (or the enclosing function) and
+ * the handler it invokes. The events built by MakeEvent are local classes of MakeEvent,
+ * whose first argument is the invoked function.
+ *
+ * \param type the demangled type of an event
+ * \param module filled with the class (or the enclosing function) of the handler
+ * \param handler filled with the handler within its class
+ */
+void
+ParseEventType(const std::string& type, std::string& module, std::string& handler)
+{
+    auto makeEvent = type.find("MakeEvent<");
+    if (makeEvent == std::string::npos)
+    {
+        // A hand-written EventImpl subclass
+        module = StripNamespace(type);
+        handler = "Notify()";
+        return;
+    }
+    // Skip the template arguments, the first function argument is the invoked function
+    auto open = makeEvent + 9;
+    while (open < type.size() && type[open] != '>')
+    {
+        open = FindArgumentEnd(type, open);
+    }
+    open++;
+    auto function = type.substr(open + 1, FindArgumentEnd(type, open) - open - 1);
+    function.erase(function.find_last_not_of(' ') + 1);
+
+    auto member = function.find("::*)");
+    auto lambda = function.find("::{lambda");
+    if (member != std::string::npos)
+    {
+        // "void (Class::*)(Args)"
+        auto classStart = function.rfind('(', member) + 1;
+        module = StripNamespace(function.substr(classStart, member - classStart));
+        handler = "*" + StripNamespace(function.substr(member + 4));
+    }
+    else if (lambda != std::string::npos)
+    {
+        // "Function(Args)::{lambda(Args)#n}", the arguments of the function are dropped
+        auto scope = function.substr(0, lambda);
+        if (!scope.empty() && scope.back() == ')')
+        {
+            int depth = 0;
+            for (auto pos = scope.size(); pos-- > 0;)
+            {
+                depth += (scope[pos] == ')') - (scope[pos] == '(');
+                if (depth == 0)
+                {
+                    scope.erase(pos);
+                    break;
+                }
+            }
+        }
+        module = StripNamespace(scope);
+        handler = StripNamespace(function.substr(lambda + 2));
+    }
+    else if (function.find("(*)") != std::string::npos)
+    {
+        // "void (*)(Args)": free or static functions cannot be told apart
+        module = "function";
+        handler = StripNamespace(function);
+    }
+    else
+    {
+        // Functors, e.g., callbacks
+        module = StripNamespace(function.substr(0, function.find('<')));
+        handler = StripNamespace(function);
+    }
+}
+
+} // namespace
+
+TypeId
+ProfilingSimulatorImpl::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::ProfilingSimulatorImpl")
+                            .SetParent<DefaultSimulatorImpl>()
+                            .SetGroupName("Core")
+                            .AddConstructor<ProfilingSimulatorImpl>();
+    return tid;
+}
+
+ProfilingSimulatorImpl::ProfilingSimulatorImpl()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+EventId
+ProfilingSimulatorImpl::Schedule(const Time& delay, EventImpl* event)
+{
+    return DefaultSimulatorImpl::Schedule(delay, Wrap(event));
+}
+
+void
+ProfilingSimulatorImpl::ScheduleWithContext(uint32_t context, const Time& delay, EventImpl* event)
+{
+    DefaultSimulatorImpl::ScheduleWithContext(context, delay, Wrap(event));
+}
+
+EventId
+ProfilingSimulatorImpl::ScheduleNow(EventImpl* event)
+{
+    return DefaultSimulatorImpl::ScheduleNow(Wrap(event));
+}
+
+std::vector<ProfilingSimulatorImpl::Frame>
+ProfilingSimulatorImpl::GetProfile() const
+{
+    // Different event types (e.g., the same handler bound to other arguments) may
+    // have the same name
+    std::map<std::pair<std::string, std::string>, Frame> merged;
+    for (const auto& frame : m_frames)
+    {
+        if (frame.events == 0)
+        {
+            continue;
+        }
+        auto [it, inserted] = merged.emplace(std::make_pair(frame.module, frame.handler), frame);
+        if (!inserted)
+        {
+            it->second.events += frame.events;
+            it->second.wallNs += frame.wallNs;
+        }
+    }
+    std::vector<Frame> profile;
+    for (const auto& [name, frame] : merged)
+    {
+        profile.push_back(frame);
+    }
+    std::stable_sort(profile.begin(), profile.end(), [](const Frame& a, const Frame& b) {
+        return a.wallNs > b.wallNs;
+    });
+    return profile;
+}
+
+std::string
+ProfilingSimulatorImpl::GetSubsystem(const std::string& module)
+{
+    // The first matching subsystem wins, e.g., ChannelAccessManager is in the MAC
+    static const std::vector<std::pair<std::string, std::vector<std::string>>> subsystems{
+        {"scheduler", {"MultiUserScheduler"}},
+        {"harness",
+         {"ThroughputSampler",
+          "ConvergenceController",
+          "LatencyRecorder",
+          "MisbehaviorEmulator",
+          "RunSweepPoint",
+          "RunExperiment"}},
+        {"apps", {"App", "OnOff", "UdpClient", "UdpServer", "PacketSink", "BulkSend"}},
+        {"tcp", {"Tcp"}},
+        {"mac",
+         {"ChannelAccess",
+          "FrameExchange",
+          "Txop",
+          "BlockAck",
+          "Mac",
+          "Mpdu",
+          "Psdu",
+          "WifiRemoteStation",
+          "WifiNetDevice"}},
+        {"spectrum", {"Spectrum", "YansWifiChannel", "Propagation"}},
+        {"phy", {"Phy", "Interference", "Ppdu", "Preamble"}},
+        {"network",
+         {"Ipv4", "Ipv6", "Arp", "Udp", "Icmp", "TrafficControl", "Queue", "Socket", "Node"}},
+    };
+    for (const auto& [subsystem, patterns] : subsystems)
+    {
+        for (const auto& pattern : patterns)
+        {
+            if (module.find(pattern) != std::string::npos)
+            {
+                return subsystem;
+            }
+        }
+    }
+    return "other";
+}
+
+EventImpl*
+ProfilingSimulatorImpl::Wrap(EventImpl* event)
+{
+    const auto& type = typeid(*event);
+    if (type == typeid(ProfiledEvent))
+    {
+        return event;
+    }
+    return new ProfiledEvent(this, event, GetFrame(type));
+}
+
+std::size_t
+ProfilingSimulatorImpl::GetFrame(const std::type_info& type)
+{
+    auto [it, inserted] = m_frameOf.emplace(std::type_index(type), m_frames.size());
+    if (inserted)
+    {
+        Frame frame{};
+        ParseEventType(Demangle(type.name()), frame.module, frame.handler);
+        frame.subsystem = GetSubsystem(frame.module);
+        NS_LOG_DEBUG("New handler " << frame.subsystem << ";" << frame.module << ";"
+                                    << frame.handler);
+        m_frames.push_back(frame);
+    }
+    return it->second;
+}
+
+void
+ProfilingSimulatorImpl::Invoke(EventImpl* event, std::size_t frame)
+{
+    auto start = std::chrono::steady_clock::now();
+    event->Invoke();
+    auto wallNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+    m_frames[frame].events++;
+    m_frames[frame].wallNs += wallNs;
+}
+
+} // namespace ns3
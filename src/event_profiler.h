@@ -0,0 +1,97 @@
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include "ns3/default-simulator-impl.h"
+#include "ns3/event-impl.h"
+
+#include <cstdint>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Default simulator that attributes the wall-clock time and the number of the events it
+ * executes to their handlers. Every scheduled event is wrapped in an event timing the
+ * original one, and the handler is identified by the type of the original event, i.e.,
+ * the class and the signature of the member function (or the function, lambda or
+ * functor) it invokes: the member function itself is not part of the type, hence the
+ * member functions of a class with the same signature share their frame.
+ *
+ * The handlers are grouped by subsystem (spectrum, phy, mac, scheduler, tcp, network,
+ * apps, harness or other) according to their class, which gives a three-level profile
+ * (subsystem, class, handler) that can be written as folded stacks for flame graphs.
+ * It is selected by setting the SimulatorImplementationType global value to
+ * ns3::ProfilingSimulatorImpl before the simulator is created.
+ */
+class ProfilingSimulatorImpl : public DefaultSimulatorImpl
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+    ProfilingSimulatorImpl();
+
+    EventId Schedule(const Time& delay, EventImpl* event) override;
+    void ScheduleWithContext(uint32_t context, const Time& delay, EventImpl* event) override;
+    EventId ScheduleNow(EventImpl* event) override;
+
+    /**
+     * Events executed by a handler
+     */
+    struct Frame
+    {
+        std::string subsystem; //!< the subsystem of the handler
+        std::string module;    //!< the class (or enclosing function) of the handler
+        std::string handler;   //!< the handler within its class
+        uint64_t events;       //!< the number of events executed
+        uint64_t wallNs;       //!< the wall-clock time spent executing them, in ns
+    };
+
+    /**
+     * \return the handlers that executed at least one event, merged by name and sorted
+     *         by decreasing wall-clock time
+     */
+    std::vector<Frame> GetProfile() const;
+
+    /**
+     * \param module the class (or enclosing function) of a handler
+     * \return the subsystem of the handler
+     */
+    static std::string GetSubsystem(const std::string& module);
+
+  private:
+    class ProfiledEvent;
+
+    /**
+     * \param event a scheduled event
+     * \return the event timing it (the event itself if it already is one)
+     */
+    EventImpl* Wrap(EventImpl* event);
+
+    /**
+     * \param type the type of a scheduled event
+     * \return the index of the frame of its handler in m_frames, created if needed
+     */
+    std::size_t GetFrame(const std::type_info& type);
+
+    /**
+     * Execute an event and charge it to a frame.
+     *
+     * \param event the event
+     * \param frame the index of the frame in m_frames
+     */
+    void Invoke(EventImpl* event, std::size_t frame);
+
+    std::vector<Frame> m_frames;                                //!< frame of each event type
+    std::unordered_map<std::type_index, std::size_t> m_frameOf; //!< event type to frame index
+};
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
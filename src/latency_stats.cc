@@ -0,0 +1,334 @@
+#include "latency_stats.h"
+
+#include "ns3/abort.h"
+#include "ns3/callback.h"
+#include "ns3/log.h"
+#include "ns3/qos-utils.h"
+#include "ns3/simulator.h"
+#include "ns3/wifi-mac-queue.h"
+#include "ns3/wifi-mpdu.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("LatencyStats");
+
+NS_OBJECT_ENSURE_REGISTERED(TxTimestampTag);
+
+TypeId
+TxTimestampTag::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::TxTimestampTag")
+                            .SetParent<Tag>()
+                            .SetGroupName("Applications")
+                            .AddConstructor<TxTimestampTag>();
+    return tid;
+}
+
+TypeId
+TxTimestampTag::GetInstanceTypeId() const
+{
+    return GetTypeId();
+}
+
+uint32_t
+TxTimestampTag::GetSerializedSize() const
+{
+    return 8;
+}
+
+void
+TxTimestampTag::Serialize(TagBuffer i) const
+{
+    i.WriteU64(m_time.GetTimeStep());
+}
+
+void
+TxTimestampTag::Deserialize(TagBuffer i)
+{
+    m_time = TimeStep(i.ReadU64());
+}
+
+void
+TxTimestampTag::Print(std::ostream& os) const
+{
+    os << "TxTime=" << m_time;
+}
+
+void
+TxTimestampTag::SetTime(Time time)
+{
+    m_time = time;
+}
+
+Time
+TxTimestampTag::GetTime() const
+{
+    return m_time;
+}
+
+LogLinearHistogram::LogLinearHistogram()
+    : m_counts((MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS),
+      m_count(0),
+      m_max(0)
+{
+}
+
+std::size_t
+LogLinearHistogram::GetIndex(uint64_t value)
+{
+    if (value < (2ULL << SUB_BUCKET_BITS))
+    {
+        return value; // the first two ranges have a unit resolution
+    }
+    // the SUB_BUCKET_BITS + 1 most significant bits of the value
+    uint32_t shift = 63 - __builtin_clzll(value) - SUB_BUCKET_BITS;
+    return (static_cast<std::size_t>(shift) << SUB_BUCKET_BITS) + (value >> shift);
+}
+
+uint64_t
+LogLinearHistogram::GetHighestEquivalentValue(std::size_t index)
+{
+    if (index < (2ULL << SUB_BUCKET_BITS))
+    {
+        return index;
+    }
+    uint32_t shift = (index >> SUB_BUCKET_BITS) - 1;
+    uint64_t mantissa = index - (static_cast<std::size_t>(shift) << SUB_BUCKET_BITS);
+    return ((mantissa + 1) << shift) - 1;
+}
+
+void
+LogLinearHistogram::Record(uint64_t value)
+{
+    value = std::min(value, MAX_VALUE);
+    m_counts[GetIndex(value)]++;
+    m_count++;
+    m_max = std::max(m_max, value);
+}
+
+uint64_t
+LogLinearHistogram::GetCount() const
+{
+    return m_count;
+}
+
+uint64_t
+LogLinearHistogram::GetMax() const
+{
+    return m_max;
+}
+
+uint64_t
+LogLinearHistogram::GetValueAtPercentile(double p) const
+{
+    if (m_count == 0)
+    {
+        return 0;
+    }
+    auto rank = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(p * m_count)), 1);
+    uint64_t total = 0;
+    for (std::size_t index = 0; index < m_counts.size(); index++)
+    {
+        total += m_counts[index];
+        if (total >= rank)
+        {
+            return std::min(GetHighestEquivalentValue(index), m_max);
+        }
+    }
+    return m_max;
+}
+
+std::size_t
+LogLinearHistogram::GetMemoryBytes() const
+{
+    return m_counts.size() * sizeof(uint64_t);
+}
+
+LatencyRecorder::LatencyRecorder(std::size_t nClients, Time warmup)
+    : m_warmup(warmup),
+      m_mac(nClients),
+      m_app(nClients)
+{
+    NS_LOG_FUNCTION(this << nClients << warmup);
+}
+
+void
+LatencyRecorder::AttachSource(Ptr<Application> app)
+{
+    NS_LOG_FUNCTION(this << app);
+    app->TraceConnectWithoutContext("Tx",
+                                    Callback<void, Ptr<const Packet>>([](Ptr<const Packet> packet) {
+                                        TxTimestampTag tag;
+                                        tag.SetTime(Simulator::Now());
+                                        packet->AddByteTag(tag);
+                                    }));
+}
+
+void
+LatencyRecorder::AttachSink(std::size_t client, Ptr<Application> sink)
+{
+    NS_LOG_FUNCTION(this << client << sink);
+    NS_ASSERT(client < m_app.size());
+    sink->TraceConnectWithoutContext(
+        "Rx",
+        Callback<void, Ptr<const Packet>, const Address&>(
+            [this, client](Ptr<const Packet> packet, const Address&) {
+                if (Simulator::Now() < m_warmup)
+                {
+                    return;
+                }
+                auto it = packet->GetByteTagIterator();
+                while (it.HasNext())
+                {
+                    auto item = it.Next();
+                    if (item.GetTypeId() == TxTimestampTag::GetTypeId())
+                    {
+                        TxTimestampTag tag;
+                        item.GetTag(tag);
+                        RecordDelay(m_app[client], Simulator::Now() - tag.GetTime());
+                    }
+                }
+            }));
+}
+
+void
+LatencyRecorder::AttachMac(Ptr<WifiMac> mac, ClientGetter client)
+{
+    NS_LOG_FUNCTION(this << mac);
+    // the callback is stored by the MAC itself, hence a Ptr would keep the MAC alive
+    WifiMac* txMac = PeekPointer(mac);
+    mac->TraceConnectWithoutContext(
+        "AckedMpdu",
+        Callback<void, Ptr<const WifiMpdu>>([this, txMac, client](Ptr<const WifiMpdu> mpdu) {
+            if (Simulator::Now() < m_warmup || !mpdu->GetHeader().IsQosData())
+            {
+                return;
+            }
+            auto index = client(mpdu->GetHeader().GetAddr1());
+            if (index < 0)
+            {
+                return;
+            }
+            // the MPDUs expire MaxDelay after being enqueued
+            auto queue = txMac->GetTxopQueue(QosUtilsMapTidToAc(mpdu->GetHeader().GetQosTid()));
+            auto enqueued = mpdu->GetExpiryTime() - queue->GetMaxDelay();
+            RecordDelay(m_mac[index], Simulator::Now() - enqueued);
+        }));
+}
+
+LatencyRecorder::Percentiles
+LatencyRecorder::GetMacDelay(std::size_t client) const
+{
+    return ComputePercentiles(m_mac.at(client));
+}
+
+LatencyRecorder::Percentiles
+LatencyRecorder::GetAppDelay(std::size_t client) const
+{
+    return ComputePercentiles(m_app.at(client));
+}
+
+std::size_t
+LatencyRecorder::GetMemoryBytes() const
+{
+    std::size_t bytes = 0;
+    for (std::size_t i = 0; i < m_mac.size(); i++)
+    {
+        bytes += m_mac[i].GetMemoryBytes() + m_app[i].GetMemoryBytes();
+    }
+    return bytes;
+}
+
+void
+LatencyRecorder::RecordDelay(LogLinearHistogram& histogram, Time delay)
+{
+    histogram.Record(static_cast<uint64_t>(std::max<int64_t>(delay.GetNanoSeconds(), 0)));
+}
+
+LatencyRecorder::Percentiles
+LatencyRecorder::ComputePercentiles(const LogLinearHistogram& histogram)
+{
+    return Percentiles{histogram.GetValueAtPercentile(0.5) / 1e6,
+                       histogram.GetValueAtPercentile(0.99) / 1e6,
+                       histogram.GetValueAtPercentile(0.999) / 1e6};
+}
+
+namespace
+{
+
+/**
+ * \param str a string
+ * \return the string without leading and trailing spaces
+ */
+std::string
+Trim(const std::string& str)
+{
+    auto first = str.find_first_not_of(" \t");
+    if (first == std::string::npos)
+    {
+        return "";
+    }
+    return str.substr(first, str.find_last_not_of(" \t") - first + 1);
+}
+
+} // namespace
+
+std::vector<Time>
+ParseLatencyTargetSpec(const std::string& spec, std::size_t nClients)
+{
+    NS_LOG_FUNCTION(spec << nClients);
+
+    std::vector<Time> targets(nClients, Time{0});
+    std::vector<bool> assigned(nClients, false);
+    std::istringstream iss(spec);
+    std::string entry;
+    while (std::getline(iss, entry, ';'))
+    {
+        entry = Trim(entry);
+        if (entry.empty())
+        {
+            continue;
+        }
+        auto colon = entry.find(':');
+        NS_ABORT_MSG_IF(colon == std::string::npos,
+                        "Missing ':' in latency target entry: " << entry);
+        std::string clients = Trim(entry.substr(0, colon));
+        Time target(Trim(entry.substr(colon + 1)));
+        NS_ABORT_MSG_IF(target.IsStrictlyNegative(),
+                        "Negative latency target in entry: " << entry);
+
+        std::size_t first = 0;
+        std::size_t last = nClients - 1;
+        if (clients != "*")
+        {
+            auto dash = clients.find('-');
+            try
+            {
+                first = std::stoul(clients.substr(0, dash));
+                last = (dash == std::string::npos ? first : std::stoul(clients.substr(dash + 1)));
+            }
+            catch (const std::exception&)
+            {
+                NS_ABORT_MSG("Invalid clients in latency target entry: " << entry);
+            }
+            NS_ABORT_MSG_IF(first > last || last >= nClients,
+                            "Clients out of range in latency target entry: " << entry);
+        }
+        for (std::size_t i = first; i <= last; i++)
+        {
+            if (!assigned[i])
+            {
+                targets[i] = target;
+                assigned[i] = true;
+            }
+        }
+    }
+    return targets;
+}
+
+} // namespace ns3
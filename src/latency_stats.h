@@ -0,0 +1,214 @@
+#ifndef LATENCY_STATS_H
+#define LATENCY_STATS_H
+
+#include "ns3/application.h"
+#include "ns3/mac48-address.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/tag.h"
+#include "ns3/wifi-mac.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Time a packet was handed to the socket by the application. It is a byte tag, hence
+ * it follows the bytes of the packet through TCP segmentation and reassembly.
+ */
+class TxTimestampTag : public Tag
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+    TypeId GetInstanceTypeId() const override;
+    uint32_t GetSerializedSize() const override;
+    void Serialize(TagBuffer i) const override;
+    void Deserialize(TagBuffer i) override;
+    void Print(std::ostream& os) const override;
+
+    /**
+     * \param time the time the packet was sent
+     */
+    void SetTime(Time time);
+    /**
+     * \return the time the packet was sent
+     */
+    Time GetTime() const;
+
+  private:
+    Time m_time; //!< the time the packet was sent
+};
+
+/**
+ * Fixed-memory log-linear histogram of non-negative integer values, in the spirit of
+ * HdrHistogram. The values are split into power-of-two ranges, each divided into
+ * 2^SUB_BUCKET_BITS linear sub-buckets, hence recording is a couple of integer
+ * operations and the percentiles are within 2^-SUB_BUCKET_BITS (about 1.6%) of the
+ * exact ones, whatever the number of recorded values. Values larger than MAX_VALUE are
+ * recorded as MAX_VALUE.
+ */
+class LogLinearHistogram
+{
+  public:
+    static constexpr uint32_t SUB_BUCKET_BITS = 6; //!< log2 of the sub-buckets per range
+    static constexpr uint32_t MAX_VALUE_BITS = 40; //!< log2 of the range of the values
+    static constexpr uint64_t MAX_VALUE = (1ULL << MAX_VALUE_BITS) - 1; //!< largest value
+
+    LogLinearHistogram();
+
+    /**
+     * \param value the value to record
+     */
+    void Record(uint64_t value);
+
+    /**
+     * \return the number of recorded values
+     */
+    uint64_t GetCount() const;
+    /**
+     * \return the largest recorded value (0 if none)
+     */
+    uint64_t GetMax() const;
+    /**
+     * \param p the percentile, between 0 and 1
+     * \return the largest value equivalent (i.e., in the same sub-bucket) to the value at
+     *         the given percentile, capped to the largest recorded value (0 if none)
+     */
+    uint64_t GetValueAtPercentile(double p) const;
+    /**
+     * \return the memory used by the counts of the histogram, in bytes
+     */
+    std::size_t GetMemoryBytes() const;
+
+  private:
+    /**
+     * \param value a value
+     * \return the index of the sub-bucket of the value
+     */
+    static std::size_t GetIndex(uint64_t value);
+    /**
+     * \param index the index of a sub-bucket
+     * \return the largest value of the sub-bucket
+     */
+    static uint64_t GetHighestEquivalentValue(std::size_t index);
+
+    std::vector<uint64_t> m_counts; //!< the counts of the sub-buckets
+    uint64_t m_count;               //!< the number of recorded values
+    uint64_t m_max;                 //!< the largest recorded value
+};
+
+/**
+ * Per-client MAC and application delays.
+ *
+ * The MAC delay of an MPDU goes from its enqueue in the MAC queue to its
+ * acknowledgment, including the retransmissions. The application delay goes from the
+ * time the source hands a packet to the socket to the time the sink receives it; with
+ * TCP, it is recorded for every received segment of the packet. Only the packets
+ * received after the warm-up are recorded. The delays are recorded with a nanosecond
+ * resolution in log-linear histograms, hence the memory does not grow with the number
+ * of packets.
+ */
+class LatencyRecorder
+{
+  public:
+    /**
+     * Delay percentiles of a client, in milliseconds (0 if no delay was recorded)
+     */
+    struct Percentiles
+    {
+        double p50;  //!< median
+        double p99;  //!< 99th percentile
+        double p999; //!< 99.9th percentile
+    };
+
+    /**
+     * Callback returning the index of the client a MPDU with the given receiver
+     * belongs to, or a negative value if none
+     */
+    typedef std::function<int(Mac48Address)> ClientGetter;
+
+    /**
+     * \param nClients the number of clients
+     * \param warmup the delays of the packets received before this time are not recorded
+     */
+    LatencyRecorder(std::size_t nClients, Time warmup);
+
+    /**
+     * Tag the packets sent by the given application (if it has a "Tx" trace source).
+     *
+     * \param app the traffic source of a client
+     */
+    void AttachSource(Ptr<Application> app);
+    /**
+     * Record the application delay of the packets received by the given sink.
+     *
+     * \param client the index of the client
+     * \param sink the sink of the client (if it has a "Rx" trace source)
+     */
+    void AttachSink(std::size_t client, Ptr<Application> sink);
+    /**
+     * Record the MAC delay of the QoS data frames acknowledged to the given MAC.
+     *
+     * \param mac the MAC of the transmitter
+     * \param client returns the client of the acknowledged frames
+     */
+    void AttachMac(Ptr<WifiMac> mac, ClientGetter client);
+
+    /**
+     * \param client the index of the client
+     * \return the MAC delay percentiles of the client
+     */
+    Percentiles GetMacDelay(std::size_t client) const;
+    /**
+     * \param client the index of the client
+     * \return the application delay percentiles of the client
+     */
+    Percentiles GetAppDelay(std::size_t client) const;
+
+    /**
+     * \return the memory used by the histograms, in bytes
+     */
+    std::size_t GetMemoryBytes() const;
+
+  private:
+    /**
+     * \param histogram the delays, in nanoseconds
+     * \return the percentiles of the delays
+     */
+    static Percentiles ComputePercentiles(const LogLinearHistogram& histogram);
+
+    /**
+     * \param histogram the histogram to record the delay into
+     * \param delay the delay
+     */
+    static void RecordDelay(LogLinearHistogram& histogram, Time delay);
+
+    Time m_warmup;                         //!< the end of the warm-up
+    std::vector<LogLinearHistogram> m_mac; //!< per-client MAC delays (ns)
+    std::vector<LogLinearHistogram> m_app; //!< per-client application delays (ns)
+};
+
+/**
+ * Parse a per-client latency target specification, i.e., a ';' separated list of
+ * "<clients>:<target>" entries where <clients> is a client index, a range of indices
+ * ("1-3") or '*' for all the clients, and <target> is a time (e.g., "5ms"). The first
+ * entry matching a client wins and the clients without an entry keep the LatencyTarget
+ * attribute of the scheduler. Aborts if the specification is invalid.
+ *
+ * \param spec the latency target specification (empty for the default targets)
+ * \param nClients the number of clients
+ * \return the latency target of each client, zero for the attribute of the scheduler
+ */
+std::vector<Time> ParseLatencyTargetSpec(const std::string& spec, std::size_t nClients);
+
+} // namespace ns3
+
+#endif /* LATENCY_STATS_H */
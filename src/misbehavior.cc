@@ -0,0 +1,315 @@
+#include "misbehavior.h"
+
+#include "ns3/abort.h"
+#include "ns3/boolean.h"
+#include "ns3/log.h"
+#include "ns3/mgt-headers.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/wifi-mac-header.h"
+#include "ns3/wifi-phy.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("Misbehavior");
+
+NS_OBJECT_ENSURE_REGISTERED(FrameDropErrorModel);
+
+TypeId
+FrameDropErrorModel::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::FrameDropErrorModel")
+            .SetParent<ErrorModel>()
+            .SetGroupName("Wifi")
+            .AddConstructor<FrameDropErrorModel>()
+            .AddAttribute("DropTriggers",
+                          "Whether to drop the Trigger Frames",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&FrameDropErrorModel::m_dropTriggers),
+                          MakeBooleanChecker())
+            .AddAttribute("DropAddbaRequests",
+                          "Whether to drop the ADDBA Requests",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&FrameDropErrorModel::m_dropAddbaRequests),
+                          MakeBooleanChecker());
+    return tid;
+}
+
+FrameDropErrorModel::FrameDropErrorModel()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+FrameDropErrorModel::AddTransmitter(Mac48Address address)
+{
+    NS_LOG_FUNCTION(this << address);
+    m_transmitters.insert(address);
+}
+
+bool
+FrameDropErrorModel::DoCorrupt(Ptr<Packet> p)
+{
+    WifiMacHeader hdr;
+    p->RemoveHeader(hdr);
+    bool drop = (m_dropTriggers && hdr.IsTrigger());
+    if (m_dropAddbaRequests && hdr.IsAction())
+    {
+        WifiActionHeader action;
+        p->PeekHeader(action);
+        drop = (action.GetCategory() == WifiActionHeader::BLOCK_ACK &&
+                action.GetAction().blockAck == WifiActionHeader::BLOCK_ACK_ADDBA_REQUEST);
+    }
+    if (drop && (m_transmitters.empty() || m_transmitters.count(hdr.GetAddr2()) > 0))
+    {
+        NS_LOG_DEBUG("Dropping " << hdr.GetTypeString() << " from " << hdr.GetAddr2());
+        return true;
+    }
+    return false;
+}
+
+void
+FrameDropErrorModel::DoReset()
+{
+}
+
+std::string
+GetMisbehaviorName(Misbehavior misbehavior)
+{
+    switch (misbehavior)
+    {
+    case Misbehavior::NONE:
+        return "none";
+    case Misbehavior::INFLATED_BSR:
+        return "bsr";
+    case Misbehavior::SKIP_EXPLOIT:
+        return "skip";
+    case Misbehavior::IGNORE_TRIGGER:
+        return "trigger";
+    case Misbehavior::WITHHOLD_BA:
+        return "ba";
+    }
+    return "unknown";
+}
+
+namespace
+{
+
+/**
+ * \param name the name of a misbehavior
+ * \return the misbehavior
+ */
+Misbehavior
+ParseMisbehavior(const std::string& name)
+{
+    for (auto misbehavior : {Misbehavior::NONE,
+                             Misbehavior::INFLATED_BSR,
+                             Misbehavior::SKIP_EXPLOIT,
+                             Misbehavior::IGNORE_TRIGGER,
+                             Misbehavior::WITHHOLD_BA})
+    {
+        if (GetMisbehaviorName(misbehavior) == name)
+        {
+            return misbehavior;
+        }
+    }
+    NS_ABORT_MSG("Unknown misbehavior (must be none, bsr, skip, trigger or ba): " << name);
+    return Misbehavior::NONE;
+}
+
+/**
+ * \param str a string
+ * \return the string without leading and trailing spaces
+ */
+std::string
+Trim(const std::string& str)
+{
+    auto first = str.find_first_not_of(" \t");
+    if (first == std::string::npos)
+    {
+        return "";
+    }
+    return str.substr(first, str.find_last_not_of(" \t") - first + 1);
+}
+
+} // namespace
+
+std::vector<Misbehavior>
+ParseMisbehaviorSpec(const std::string& spec, std::size_t nAttackers, std::size_t nClients)
+{
+    NS_LOG_FUNCTION(spec << nAttackers << nClients);
+
+    std::vector<Misbehavior> misbehaviors(nClients, Misbehavior::NONE);
+    if (Trim(spec).empty())
+    {
+        return misbehaviors;
+    }
+    if (spec.find(':') == std::string::npos)
+    {
+        NS_ABORT_MSG_IF(nAttackers > nClients,
+                        "More attackers (" << nAttackers << ") than clients (" << nClients
+                                           << ")");
+        std::fill_n(misbehaviors.begin(), nAttackers, ParseMisbehavior(Trim(spec)));
+        return misbehaviors;
+    }
+
+    std::vector<bool> assigned(nClients, false);
+    std::istringstream iss(spec);
+    std::string entry;
+    while (std::getline(iss, entry, ';'))
+    {
+        entry = Trim(entry);
+        if (entry.empty())
+        {
+            continue;
+        }
+        auto colon = entry.find(':');
+        NS_ABORT_MSG_IF(colon == std::string::npos, "Missing ':' in misbehavior entry: " << entry);
+        std::string clients = Trim(entry.substr(0, colon));
+        auto misbehavior = ParseMisbehavior(Trim(entry.substr(colon + 1)));
+
+        std::size_t first = 0;
+        std::size_t last = nClients - 1;
+        if (clients != "*")
+        {
+            auto dash = clients.find('-');
+            try
+            {
+                first = std::stoul(clients.substr(0, dash));
+                last = (dash == std::string::npos ? first : std::stoul(clients.substr(dash + 1)));
+            }
+            catch (const std::exception&)
+            {
+                NS_ABORT_MSG("Invalid clients in misbehavior entry: " << entry);
+            }
+            NS_ABORT_MSG_IF(first > last || last >= nClients,
+                            "Clients out of range in misbehavior entry: " << entry);
+        }
+        for (std::size_t i = first; i <= last; i++)
+        {
+            if (!assigned[i])
+            {
+                misbehaviors[i] = misbehavior;
+                assigned[i] = true;
+            }
+        }
+    }
+    return misbehaviors;
+}
+
+MisbehaviorEmulator::MisbehaviorEmulator(Time period)
+    : m_period(period)
+{
+    NS_LOG_FUNCTION(this << period);
+}
+
+void
+MisbehaviorEmulator::Install(Misbehavior misbehavior,
+                             Ptr<WifiNetDevice> sta,
+                             Ptr<WifiNetDevice> ap)
+{
+    NS_LOG_FUNCTION(this << GetMisbehaviorName(misbehavior) << sta << ap);
+
+    auto address = sta->GetMac()->GetAddress();
+    switch (misbehavior)
+    {
+    case Misbehavior::NONE:
+        break;
+    case Misbehavior::INFLATED_BSR:
+    case Misbehavior::SKIP_EXPLOIT: {
+        auto index = m_reporters.size();
+        m_reporters.push_back({misbehavior, DynamicCast<ApWifiMac>(ap->GetMac()), address});
+        // the AP stores the buffer status of a received QoS frame after the PHY notifies
+        // the sniffers, hence it is overwritten in a later event at the same time
+        ap->GetPhy()->TraceConnectWithoutContext(
+            "MonitorSnifferRx",
+            Callback<void,
+                     Ptr<const Packet>,
+                     uint16_t,
+                     WifiTxVector,
+                     MpduInfo,
+                     SignalNoiseDbm,
+                     uint16_t>([this, index, address](Ptr<const Packet> packet,
+                                                      uint16_t,
+                                                      WifiTxVector,
+                                                      MpduInfo,
+                                                      SignalNoiseDbm,
+                                                      uint16_t) {
+                WifiMacHeader hdr;
+                packet->PeekHeader(hdr);
+                if (hdr.IsQosData() && hdr.GetAddr2() == address)
+                {
+                    Simulator::ScheduleNow(&MisbehaviorEmulator::Report, this, index);
+                }
+            }));
+        if (misbehavior == Misbehavior::SKIP_EXPLOIT)
+        {
+            NS_ABORT_MSG_IF(!m_period.IsStrictlyPositive(),
+                            "The period of the skip misbehavior must be positive");
+            Simulator::ScheduleNow(&MisbehaviorEmulator::RefreshReport, this, index);
+        }
+        else
+        {
+            Simulator::ScheduleNow(&MisbehaviorEmulator::Report, this, index);
+        }
+        break;
+    }
+    case Misbehavior::IGNORE_TRIGGER: {
+        auto errorModel = CreateObject<FrameDropErrorModel>();
+        errorModel->SetAttribute("DropTriggers", BooleanValue(true));
+        sta->GetPhy()->SetPostReceptionErrorModel(errorModel);
+        break;
+    }
+    case Misbehavior::WITHHOLD_BA: {
+        auto errorModel = CreateObject<FrameDropErrorModel>();
+        errorModel->SetAttribute("DropAddbaRequests", BooleanValue(true));
+        sta->GetPhy()->SetPostReceptionErrorModel(errorModel);
+        GetApErrorModel(ap)->AddTransmitter(address);
+        break;
+    }
+    }
+}
+
+void
+MisbehaviorEmulator::Report(std::size_t index)
+{
+    const auto& reporter = m_reporters.at(index);
+    uint8_t queueSize = 254; // not limited
+    if (reporter.misbehavior == Misbehavior::SKIP_EXPLOIT)
+    {
+        // the empty buffer is reported during the first half of each period
+        auto phase = Simulator::Now().GetTimeStep() / (m_period / 2).GetTimeStep();
+        queueSize = (phase % 2 == 0 ? 0 : 254);
+    }
+    for (uint8_t tid = 0; tid < 8; tid++)
+    {
+        reporter.apMac->SetBufferStatus(tid, reporter.address, queueSize);
+    }
+}
+
+void
+MisbehaviorEmulator::RefreshReport(std::size_t index)
+{
+    Report(index);
+    Simulator::Schedule(m_period / 2, &MisbehaviorEmulator::RefreshReport, this, index);
+}
+
+Ptr<FrameDropErrorModel>
+MisbehaviorEmulator::GetApErrorModel(Ptr<WifiNetDevice> ap)
+{
+    auto [it, inserted] = m_apErrorModels.emplace(ap, nullptr);
+    if (inserted)
+    {
+        it->second = CreateObject<FrameDropErrorModel>();
+        it->second->SetAttribute("DropAddbaRequests", BooleanValue(true));
+        ap->GetPhy()->SetPostReceptionErrorModel(it->second);
+    }
+    return it->second;
+}
+
+} // namespace ns3
@@ -0,0 +1,155 @@
+#ifndef MISBEHAVIOR_H
+#define MISBEHAVIOR_H
+
+#include "ns3/ap-wifi-mac.h"
+#include "ns3/error-model.h"
+#include "ns3/mac48-address.h"
+#include "ns3/nstime.h"
+#include "ns3/wifi-net-device.h"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Post-reception error model of a PHY that drops the Trigger Frames and/or the ADDBA
+ * Requests it receives, optionally only from a set of transmitters. Only frames that
+ * are not aggregated in an A-MPDU are inspected, which is the case of the Trigger
+ * Frames and of the management frames (unless the TFs are aggregated to DL MU PPDUs,
+ * as with the AGGR-MU-BAR acknowledgment sequence).
+ */
+class FrameDropErrorModel : public ErrorModel
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+    FrameDropErrorModel();
+
+    /**
+     * Only drop the frames of the given transmitter (and of the others added before).
+     *
+     * \param address the MAC address of the transmitter
+     */
+    void AddTransmitter(Mac48Address address);
+
+  private:
+    bool DoCorrupt(Ptr<Packet> p) override;
+    void DoReset() override;
+
+    bool m_dropTriggers;                   //!< whether to drop the Trigger Frames
+    bool m_dropAddbaRequests;              //!< whether to drop the ADDBA Requests
+    std::set<Mac48Address> m_transmitters; //!< the transmitters of the dropped frames
+                                           //!< (all of them if empty)
+};
+
+/**
+ * Misbehaviors a client can emulate to game the MU scheduler of its AP
+ */
+enum class Misbehavior : uint8_t
+{
+    NONE = 0,       //!< well-behaved client
+    INFLATED_BSR,   //!< "bsr": always reports a non-limited buffer
+    SKIP_EXPLOIT,   //!< "skip": alternately reports an empty buffer, hence cannot be
+                    //!< solicited while the others pay for the TB PPDUs, and a
+                    //!< non-limited buffer
+    IGNORE_TRIGGER, //!< "trigger": ignores the Trigger Frames
+    WITHHOLD_BA     //!< "ba": never establishes a Block Ack agreement
+};
+
+/**
+ * \param misbehavior a misbehavior
+ * \return the name of the misbehavior in the specifications
+ */
+std::string GetMisbehaviorName(Misbehavior misbehavior);
+
+/**
+ * Parse a per-client misbehavior specification, i.e., a ';' separated list of
+ * "<clients>:<misbehavior>" entries where <clients> is a client index, a range of
+ * indices ("1-3") or '*' for all the clients, and <misbehavior> is one of none, bsr,
+ * skip, trigger and ba. The first entry matching a client wins and the clients without
+ * an entry are well-behaved. A single misbehavior without clients applies to the first
+ * nAttackers clients. Aborts if the specification is invalid.
+ *
+ * \param spec the misbehavior specification (empty if all the clients are well-behaved)
+ * \param nAttackers the number of attackers of a specification without clients
+ * \param nClients the number of clients
+ * \return the misbehavior of each client
+ */
+std::vector<Misbehavior> ParseMisbehaviorSpec(const std::string& spec,
+                                              std::size_t nAttackers,
+                                              std::size_t nClients);
+
+/**
+ * Emulation of misbehaving clients on top of regular stations.
+ *
+ * The buffer status reports are emulated on the AP side: the buffer status the AP
+ * stores for an attacker is overwritten right after the AP receives a QoS frame from
+ * it (and at every half period for SKIP_EXPLOIT), which is what the AP would store if
+ * the attacker lied in the Queue Size subfield. The ignored Trigger Frames are dropped
+ * by the PHY of the attacker. The withheld Block Ack agreements are emulated by
+ * dropping the ADDBA Requests in both directions: the attacker ignores those of the
+ * AP and the AP never hears those of the attacker.
+ */
+class MisbehaviorEmulator
+{
+  public:
+    /**
+     * \param period the period of the SKIP_EXPLOIT misbehavior (the buffer is reported
+     *               empty during the first half of each period)
+     */
+    explicit MisbehaviorEmulator(Time period);
+
+    /**
+     * \param misbehavior the misbehavior of the client
+     * \param sta the device of the client
+     * \param ap the device of the AP of the client
+     */
+    void Install(Misbehavior misbehavior, Ptr<WifiNetDevice> sta, Ptr<WifiNetDevice> ap);
+
+  private:
+    /**
+     * A client misbehaving in its buffer status reports
+     */
+    struct Reporter
+    {
+        Misbehavior misbehavior; //!< the misbehavior of the client
+        Ptr<ApWifiMac> apMac;    //!< the MAC of the AP of the client
+        Mac48Address address;    //!< the MAC address of the client
+    };
+
+    /**
+     * Overwrite the buffer status of all the TIDs of a client.
+     *
+     * \param index the index of the client in m_reporters
+     */
+    void Report(std::size_t index);
+    /**
+     * Overwrite the buffer status of all the TIDs of a client now and at every half
+     * period.
+     *
+     * \param index the index of the client in m_reporters
+     */
+    void RefreshReport(std::size_t index);
+
+    /**
+     * \param ap the device of an AP
+     * \return the post-reception error model of the PHY of the AP, created if needed
+     */
+    Ptr<FrameDropErrorModel> GetApErrorModel(Ptr<WifiNetDevice> ap);
+
+    Time m_period;                     //!< the period of the SKIP_EXPLOIT misbehavior
+    std::vector<Reporter> m_reporters; //!< the clients misbehaving in their reports
+    std::map<Ptr<WifiNetDevice>, Ptr<FrameDropErrorModel>> m_apErrorModels; //!< per-AP
+                                                                            //!< error models
+};
+
+} // namespace ns3
+
+#endif /* MISBEHAVIOR_H */
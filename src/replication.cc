@@ -0,0 +1,210 @@
+#include "replication.h"
+
+#include "ns3/abort.h"
+#include "ns3/fatal-error.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+#include <poll.h>
+#include <sstream>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("Replication");
+
+namespace
+{
+
+/**
+ * Write the whole buffer to the given file descriptor.
+ *
+ * \param fd the file descriptor
+ * \param data the buffer
+ * \return true if the whole buffer was written
+ */
+bool
+WriteAll(int fd, const std::string& data)
+{
+    std::size_t written = 0;
+    while (written < data.size())
+    {
+        ssize_t ret = write(fd, data.data() + written, data.size() - written);
+        if (ret < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (ret <= 0)
+        {
+            return false;
+        }
+        written += ret;
+    }
+    return true;
+}
+
+} // namespace
+
+std::vector<std::string>
+RunReplications(const std::vector<uint32_t>& runs, std::size_t maxWorkers, const ReplicationJob& job)
+{
+    NS_LOG_FUNCTION(runs.size() << maxWorkers);
+
+    std::vector<std::string> results(runs.size());
+    if (maxWorkers == 0)
+    {
+        maxWorkers = runs.size();
+    }
+
+    // buffered output would otherwise be duplicated by every worker
+    std::cout.flush();
+    std::cerr.flush();
+
+    // a pool of workers: a new replication is started as soon as a worker exits. The
+    // workers block once their pipe is full, hence all the pipes are drained together
+    struct Worker
+    {
+        pid_t pid;         //!< the process of the worker
+        int fd;            //!< the read end of its pipe
+        std::size_t index; //!< the index of its run
+    };
+
+    std::vector<Worker> workers;
+    std::vector<uint32_t> failed;
+    std::size_t next = 0;
+    while (next < runs.size() || !workers.empty())
+    {
+        // no new replication is started after a failure, the running ones are collected
+        while (failed.empty() && next < runs.size() && workers.size() < maxWorkers)
+        {
+            int fds[2];
+            NS_ABORT_MSG_IF(pipe(fds) != 0, "Failed to create a pipe for run " << runs[next]);
+
+            pid_t pid = fork();
+            NS_ABORT_MSG_IF(pid < 0, "Failed to fork the worker of run " << runs[next]);
+
+            if (pid == 0)
+            {
+                // worker process: run the job, ship the result and leave without running
+                // the destructors (and flushing the buffers) inherited from the parent
+                close(fds[0]);
+                for (const auto& worker : workers)
+                {
+                    close(worker.fd);
+                }
+                bool ok = WriteAll(fds[1], job(runs[next]));
+                close(fds[1]);
+                _exit(ok ? 0 : 1);
+            }
+
+            close(fds[1]);
+            workers.push_back({pid, fds[0], next});
+            NS_LOG_DEBUG("Started worker " << pid << " for run " << runs[next]);
+            next++;
+        }
+        if (workers.empty())
+        {
+            break;
+        }
+
+        std::vector<pollfd> fds;
+        for (const auto& worker : workers)
+        {
+            fds.push_back({worker.fd, POLLIN, 0});
+        }
+        if (poll(fds.data(), fds.size(), -1) < 0)
+        {
+            NS_ABORT_MSG_IF(errno != EINTR, "Failed to poll the workers");
+            continue;
+        }
+
+        for (std::size_t k = fds.size(); k-- > 0;)
+        {
+            if (fds[k].revents == 0)
+            {
+                continue;
+            }
+            auto worker = workers[k];
+            char buf[65536];
+            ssize_t ret = read(worker.fd, buf, sizeof(buf));
+            if (ret < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (ret > 0)
+            {
+                results[worker.index].append(buf, ret);
+                continue;
+            }
+
+            // EOF (or error): the worker is exiting, reap it and free its slot
+            close(worker.fd);
+            int status = 0;
+            while (waitpid(worker.pid, &status, 0) < 0 && errno == EINTR)
+            {
+            }
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            {
+                failed.push_back(runs[worker.index]);
+            }
+            NS_LOG_DEBUG("Worker " << worker.pid << " of run " << runs[worker.index]
+                                   << " exited");
+            workers.erase(workers.begin() + k);
+        }
+    }
+
+    if (!failed.empty())
+    {
+        std::ostringstream oss;
+        for (auto run : failed)
+        {
+            oss << " " << run;
+        }
+        NS_FATAL_ERROR("Workers of runs" << oss.str() << " failed");
+    }
+
+    return results;
+}
+
+SampleStats
+ComputeSampleStats(std::vector<double> samples)
+{
+    SampleStats stats{samples.size(), 0, 0, 0, 0, 0, 0, 0};
+    if (samples.empty())
+    {
+        return stats;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double p) {
+        double rank = p * (samples.size() - 1);
+        auto lo = static_cast<std::size_t>(std::floor(rank));
+        auto hi = std::min(lo + 1, samples.size() - 1);
+        return samples[lo] + (rank - lo) * (samples[hi] - samples[lo]);
+    };
+
+    stats.mean = std::accumulate(samples.cbegin(), samples.cend(), 0.0) / samples.size();
+    if (samples.size() > 1)
+    {
+        double var = 0;
+        for (auto x : samples)
+        {
+            var += (x - stats.mean) * (x - stats.mean);
+        }
+        stats.stddev = std::sqrt(var / (samples.size() - 1));
+    }
+    stats.min = samples.front();
+    stats.p5 = percentile(0.05);
+    stats.p50 = percentile(0.5);
+    stats.p95 = percentile(0.95);
+    stats.max = samples.back();
+    return stats;
+}
+
+} // namespace ns3
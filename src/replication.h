@@ -0,0 +1,58 @@
+#ifndef REPLICATION_H
+#define REPLICATION_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * A job run by a worker process: it gets the RNG run number of the replication and
+ * returns a serialized result that is shipped back to the parent process.
+ */
+typedef std::function<std::string(uint32_t run)> ReplicationJob;
+
+/**
+ * Run the given job once per RNG run, each in a forked worker process, with at most
+ * maxWorkers processes running at the same time: the next run is started as soon as a
+ * worker exits. If a worker fails, no further run is started and the running workers are
+ * collected before aborting. The simulator must not be running when this function is
+ * called, since each worker gets a copy of the whole process.
+ *
+ * \param runs the RNG run numbers of the replications
+ * \param maxWorkers the maximum number of concurrent worker processes (0 means one per run)
+ * \param job the job to run in every worker process
+ * \return the serialized results, in the same order as the runs
+ */
+std::vector<std::string> RunReplications(const std::vector<uint32_t>& runs,
+                                         std::size_t maxWorkers,
+                                         const ReplicationJob& job);
+
+/**
+ * Summary statistics of a set of samples
+ */
+struct SampleStats
+{
+    std::size_t n;  //!< number of samples
+    double mean;    //!< sample mean
+    double stddev;  //!< sample standard deviation (0 with less than two samples)
+    double min;     //!< minimum
+    double p5;      //!< 5th percentile
+    double p50;     //!< median
+    double p95;     //!< 95th percentile
+    double max;     //!< maximum
+};
+
+/**
+ * \param samples the samples
+ * \return the summary statistics of the given samples (percentiles are linearly
+ *         interpolated between the closest ranks)
+ */
+SampleStats ComputeSampleStats(std::vector<double> samples);
+
+} // namespace ns3
+
+#endif /* REPLICATION_H */
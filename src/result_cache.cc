@@ -0,0 +1,203 @@
+#include "result_cache.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <unistd.h>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("ResultCache");
+
+namespace
+{
+
+/**
+ * Read the header of an entry.
+ *
+ * \param path the path of the file of the entry
+ * \param entry filled with the revision and the description of the entry
+ * \return the stream positioned at the beginning of the result
+ */
+std::ifstream
+ReadHeader(const std::filesystem::path& path, ResultCache::Entry& entry)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::getline(file, entry.revision);
+    std::getline(file, entry.description);
+    return file;
+}
+
+/**
+ * \param description the description of a run
+ * \return the "key=value" tokens of the description
+ */
+std::vector<std::string>
+Tokenize(const std::string& description)
+{
+    std::vector<std::string> tokens;
+    std::istringstream iss(description);
+    std::string token;
+    while (iss >> token)
+    {
+        tokens.push_back(token);
+    }
+    return tokens;
+}
+
+} // namespace
+
+ResultCache::ResultCache(const std::string& dir)
+    : m_dir(dir)
+{
+    NS_LOG_FUNCTION(this << dir);
+    std::error_code ec;
+    std::filesystem::create_directories(m_dir, ec);
+    NS_ABORT_MSG_IF(ec, "Failed to create the cache directory " << m_dir << ": " << ec.message());
+}
+
+uint64_t
+ResultCache::Hash(const std::string& data, uint64_t hash)
+{
+    for (unsigned char c : data)
+    {
+        hash ^= c;
+        hash *= 1099511628211ULL; // FNV prime
+    }
+    return hash;
+}
+
+std::string
+ResultCache::GetRevision()
+{
+    static std::string revision;
+    if (revision.empty())
+    {
+        std::ifstream exe("/proc/self/exe", std::ios::binary);
+        NS_ABORT_MSG_IF(!exe.is_open(), "Failed to read the executable to compute its revision");
+        uint64_t hash = 14695981039346656037ULL;
+        std::string buf(1 << 20, '\0');
+        while (exe.read(buf.data(), buf.size()) || exe.gcount() > 0)
+        {
+            hash = Hash(buf.substr(0, exe.gcount()), hash);
+        }
+        std::ostringstream oss;
+        oss << std::hex << std::setw(16) << std::setfill('0') << hash;
+        revision = oss.str();
+    }
+    return revision;
+}
+
+std::string
+ResultCache::GetKey(const std::string& description) const
+{
+    std::ostringstream oss;
+    oss << std::hex << std::setw(16) << std::setfill('0')
+        << Hash(description, Hash(GetRevision() + "\n"));
+    return oss.str();
+}
+
+std::string
+ResultCache::GetPath(const std::string& key) const
+{
+    return m_dir + "/" + key + ".txt";
+}
+
+bool
+ResultCache::Lookup(const std::string& key,
+                    const std::string& description,
+                    std::string& result) const
+{
+    NS_LOG_FUNCTION(this << key);
+    Entry entry;
+    auto file = ReadHeader(GetPath(key), entry);
+    if (!file.is_open() || entry.revision != GetRevision())
+    {
+        return false;
+    }
+    if (entry.description != description)
+    {
+        NS_LOG_WARN("The entry " << key << " describes another run, ignoring it");
+        return false;
+    }
+    std::ostringstream oss;
+    oss << file.rdbuf();
+    result = oss.str();
+    return !result.empty();
+}
+
+void
+ResultCache::Store(const std::string& key,
+                   const std::string& description,
+                   const std::string& result) const
+{
+    NS_LOG_FUNCTION(this << key);
+    NS_ABORT_MSG_IF(description.find('\n') != std::string::npos,
+                    "The description of a run must be a single line");
+    auto tmpPath = GetPath(key) + ".tmp" + std::to_string(getpid());
+    {
+        std::ofstream file(tmpPath, std::ios::binary);
+        NS_ABORT_MSG_IF(!file.is_open(), "Failed to write the cache entry " << tmpPath);
+        file << GetRevision() << "\n" << description << "\n" << result;
+    }
+    std::filesystem::rename(tmpPath, GetPath(key));
+}
+
+std::vector<ResultCache::Entry>
+ResultCache::List() const
+{
+    std::vector<Entry> entries;
+    for (const auto& file : std::filesystem::directory_iterator(m_dir))
+    {
+        if (!file.is_regular_file() || file.path().extension() != ".txt")
+        {
+            continue;
+        }
+        Entry entry;
+        ReadHeader(file.path(), entry);
+        entry.key = file.path().stem().string();
+        entry.bytes = file.file_size();
+        entries.push_back(entry);
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.key < b.key;
+    });
+    return entries;
+}
+
+std::size_t
+ResultCache::Evict(const std::string& filter) const
+{
+    NS_LOG_FUNCTION(this << filter);
+    auto filterTokens = Tokenize(filter);
+    std::size_t removed = 0;
+    for (const auto& entry : List())
+    {
+        bool match = true;
+        if (filter == "stale")
+        {
+            match = (entry.revision != GetRevision());
+        }
+        else if (filter != "*")
+        {
+            auto tokens = Tokenize(entry.description);
+            for (const auto& token : filterTokens)
+            {
+                match = match && (std::find(tokens.cbegin(), tokens.cend(), token) != tokens.cend());
+            }
+        }
+        if (match && std::filesystem::remove(GetPath(entry.key)))
+        {
+            removed++;
+        }
+    }
+    return removed;
+}
+
+} // namespace ns3
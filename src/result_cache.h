@@ -0,0 +1,107 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Content-addressed cache of the results of simulation runs.
+ *
+ * A run is described by a single-line string of space separated "key=value" tokens
+ * listing everything its results depend on (the resolved configuration, the sweep point
+ * and the RNG run). The cache key is the 64-bit FNV-1a hash of the description and of
+ * the revision of the simulator, i.e., of the executable itself: rebuilding with any
+ * change to the scenario code invalidates the entries. Each entry is a file named after
+ * its key that holds the revision, the description and the serialized result.
+ */
+class ResultCache
+{
+  public:
+    /**
+     * An entry of the cache
+     */
+    struct Entry
+    {
+        std::string key;         //!< the key of the entry
+        std::string revision;    //!< the revision the entry was computed with
+        std::string description; //!< the description of the run
+        uint64_t bytes;          //!< the size of the entry
+    };
+
+    /**
+     * \param dir the directory of the cache, created if needed
+     */
+    explicit ResultCache(const std::string& dir);
+
+    /**
+     * \param description the description of a run
+     * \return the key of the run
+     */
+    std::string GetKey(const std::string& description) const;
+
+    /**
+     * \param key the key of a run
+     * \param description the description of the run, which must match the one stored
+     *        with the entry (a mismatch, e.g., a key collision, is a miss)
+     * \param result filled with the serialized result, if found
+     * \return true if the cache holds a result for the given run
+     */
+    bool Lookup(const std::string& key, const std::string& description, std::string& result) const;
+
+    /**
+     * Store the result of a run. The entry is written to a temporary file first and
+     * then renamed, hence concurrent runs never see partial entries.
+     *
+     * \param key the key of the run
+     * \param description the description of the run
+     * \param result the serialized result
+     */
+    void Store(const std::string& key,
+               const std::string& description,
+               const std::string& result) const;
+
+    /**
+     * \return the entries of the cache, sorted by key
+     */
+    std::vector<Entry> List() const;
+
+    /**
+     * Remove the entries matching the given filter: "*" matches every entry, "stale"
+     * matches the entries computed by other revisions of the simulator and any other
+     * filter is a list of space separated "key=value" tokens that must all be part of
+     * the description of the entry (e.g., "clients=8 mcs=2").
+     *
+     * \param filter the filter
+     * \return the number of removed entries
+     */
+    std::size_t Evict(const std::string& filter) const;
+
+    /**
+     * \return the revision of the simulator, i.e., the hash of the running executable
+     */
+    static std::string GetRevision();
+
+    /**
+     * \param data the data to hash
+     * \param hash the hash to continue from (the FNV offset basis by default)
+     * \return the 64-bit FNV-1a hash of the data
+     */
+    static uint64_t Hash(const std::string& data, uint64_t hash = 14695981039346656037ULL);
+
+  private:
+    /**
+     * \param key the key of an entry
+     * \return the path of the file of the entry
+     */
+    std::string GetPath(const std::string& key) const;
+
+    std::string m_dir; //!< the directory of the cache
+};
+
+} // namespace ns3
+
+#endif /* RESULT_CACHE_H */
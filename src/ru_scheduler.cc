@@ -4,6 +4,8 @@
 #include "he-frame-exchange-manager.h"
 #include "he-phy.h"
 
+#include "ns3/double.h"
+#include "ns3/enum.h"
 #include "ns3/log.h"
 #include "ns3/wifi-acknowledgment.h"
 #include "ns3/wifi-mac-queue.h"
@@ -11,7 +13,10 @@
 #include "ns3/wifi-psdu.h"
 
 #include <algorithm>
+#include <chrono>
+#include <limits>
 #include <numeric>
+#include <tuple>
 
 namespace ns3
 {
@@ -20,6 +25,40 @@ NS_LOG_COMPONENT_DEFINE("RrMultiUserScheduler");
 
 NS_OBJECT_ENSURE_REGISTERED(RrMultiUserScheduler);
 
+namespace
+{
+
+/**
+ * \param ruType an RU type
+ * \return the number of tones of an RU of the given type
+ */
+uint16_t
+GetNTones(HeRu::RuType ruType)
+{
+    switch (ruType)
+    {
+    case HeRu::RU_26_TONE:
+        return 26;
+    case HeRu::RU_52_TONE:
+        return 52;
+    case HeRu::RU_106_TONE:
+        return 106;
+    case HeRu::RU_242_TONE:
+        return 242;
+    case HeRu::RU_484_TONE:
+        return 484;
+    case HeRu::RU_996_TONE:
+        return 996;
+    case HeRu::RU_2x996_TONE:
+        return 2 * 996;
+    default:
+        NS_ABORT_MSG("Unknown RU type");
+    }
+    return 0;
+}
+
+} // namespace
+
 TypeId
 RrMultiUserScheduler::GetTypeId()
 {
@@ -29,11 +68,12 @@ RrMultiUserScheduler::GetTypeId()
             .SetGroupName("Wifi")
             .AddConstructor<RrMultiUserScheduler>()
             .AddAttribute("NStations",
-                          "The maximum number of stations that can be granted an RU in a DL MU "
-                          "OFDMA transmission",
+                          "The maximum number of stations that can be granted an RU in a MU "
+                          "OFDMA transmission. If 0, it is the number of 26-tone RUs (central "
+                          "ones included) of the width allowed at the time of each decision.",
                           UintegerValue(4),
                           MakeUintegerAccessor(&RrMultiUserScheduler::m_nStations),
-                          MakeUintegerChecker<uint8_t>(1, 74))
+                          MakeUintegerChecker<uint8_t>(0, 74))
             .AddAttribute("EnableTxopSharing",
                           "If enabled, allow A-MPDUs of different TIDs in a DL MU PPDU.",
                           BooleanValue(true),
@@ -75,7 +115,287 @@ RrMultiUserScheduler::GetTypeId()
                 "duration (in microseconds) times the allocated bandwidth share",
                 TimeValue(Seconds(1)),
                 MakeTimeAccessor(&RrMultiUserScheduler::m_maxCredits),
-                MakeTimeChecker());
+                MakeTimeChecker())
+            .AddAttribute("ValidateRus",
+                          "Abort the simulation if the RUs of a MU PPDU overlap or do not fit "
+                          "the allowed width (slow, meant for regression runs)",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RrMultiUserScheduler::m_validateRus),
+                          MakeBooleanChecker())
+            .AddAttribute("LoadAwareRus",
+                          "Choose the RU size that delivers the queued data (DL queues, UL "
+                          "buffer status reports) with the least airtime per byte, possibly "
+                          "serving fewer stations with larger RUs, instead of the smallest RU "
+                          "size that serves all the candidate stations",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RrMultiUserScheduler::m_loadAwareRus),
+                          MakeBooleanChecker())
+            .AddAttribute("LoadAwareOverhead",
+                          "Airtime spent by a MU transmission besides the data (preamble, "
+                          "trigger frames, acknowledgments and SIFSs), used by LoadAwareRus",
+                          TimeValue(MicroSeconds(150)),
+                          MakeTimeAccessor(&RrMultiUserScheduler::m_loadAwareOverhead),
+                          MakeTimeChecker(Seconds(0)))
+            .AddAttribute("BalancedDlAmpdu",
+                          "Aggregate the A-MPDUs of a DL MU PPDU starting from the station "
+                          "needing the longest PSDU, so that the other A-MPDUs are sized to the "
+                          "PPDU duration it sets",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RrMultiUserScheduler::m_balancedDlAmpdu),
+                          MakeBooleanChecker())
+            .AddAttribute("EqualizeDlMuPpdu",
+                          "Size the A-MPDUs of a DL MU PPDU to a common duration, trimming the "
+                          "longest PSDUs and topping up the shortest ones, chosen to deliver "
+                          "the queued data with the least airtime per byte",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RrMultiUserScheduler::m_equalizeDlMuPpdu),
+                          MakeBooleanChecker())
+            .AddAttribute("LatencyAware",
+                          "Select the stations by earliest deadline (arrival of the head-of-line "
+                          "data plus the latency target of the station) instead of by credits, "
+                          "which only break ties. Credits are still updated",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RrMultiUserScheduler::m_latencyAware),
+                          MakeBooleanChecker())
+            .AddAttribute("LatencyTarget",
+                          "Latency target of the stations without a target set by "
+                          "SetLatencyTarget(), used by LatencyAware",
+                          TimeValue(MilliSeconds(10)),
+                          MakeTimeAccessor(&RrMultiUserScheduler::m_latencyTarget),
+                          MakeTimeChecker(NanoSeconds(1)))
+            .AddAttribute("BsrAnomalyPolicy",
+                          "Policy applied to the stations whose buffer status reports are "
+                          "persistently inflated, i.e., that deliver less than "
+                          "BsrAnomalyThreshold times the bytes they report in the TB PPDUs "
+                          "they are solicited for. Off does not track the reports.",
+                          EnumValue(RrMultiUserScheduler::BSR_OFF),
+                          MakeEnumAccessor(&RrMultiUserScheduler::m_bsrPolicy),
+                          MakeEnumChecker(RrMultiUserScheduler::BSR_OFF,
+                                          "Off",
+                                          RrMultiUserScheduler::BSR_DETECT,
+                                          "Detect",
+                                          RrMultiUserScheduler::BSR_CLAMP,
+                                          "Clamp",
+                                          RrMultiUserScheduler::BSR_DEPRIORITIZE,
+                                          "Deprioritize"))
+            .AddAttribute("BsrEwmaWeight",
+                          "Weight of the last report in the moving averages of the delivered "
+                          "bytes",
+                          DoubleValue(0.125),
+                          MakeDoubleAccessor(&RrMultiUserScheduler::m_bsrEwmaWeight),
+                          MakeDoubleChecker<double>(0, 1))
+            .AddAttribute("BsrAnomalyThreshold",
+                          "A station is flagged when the moving average of its delivered to "
+                          "expected bytes falls below this ratio",
+                          DoubleValue(0.25),
+                          MakeDoubleAccessor(&RrMultiUserScheduler::m_bsrThreshold),
+                          MakeDoubleChecker<double>(0, 1))
+            .AddAttribute("BsrMinReports",
+                          "Number of reports of a station needed before flagging it",
+                          UintegerValue(8),
+                          MakeUintegerAccessor(&RrMultiUserScheduler::m_bsrMinReports),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("BsrAnomalyPenalty",
+                          "Factor of the UL debits of the flagged stations (Deprioritize)",
+                          DoubleValue(4),
+                          MakeDoubleAccessor(&RrMultiUserScheduler::m_bsrPenalty),
+                          MakeDoubleChecker<double>(1))
+            .AddAttribute("TxDurationCache",
+                          "Memoize the durations of the HE TB PPDUs computed to set the UL "
+                          "length of the Trigger Frames",
+                          BooleanValue(true),
+                          MakeBooleanAccessor(&RrMultiUserScheduler::m_txDurationCache),
+                          MakeBooleanChecker())
+            .AddAttribute("TxDurationCacheSize",
+                          "Max number of memoized durations (the cache is emptied when full)",
+                          UintegerValue(4096),
+                          MakeUintegerAccessor(&RrMultiUserScheduler::m_txDurationCacheSize),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("StaStateBytes",
+                          "Bytes of scheduler state per associated station (read-only)",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RrMultiUserScheduler::GetStaStateBytes),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("CountersStartTime",
+                          "Time the schedule-efficiency counters are reset at (e.g., the end of "
+                          "the warm-up). The counters can also be reset with ResetCounters()",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&RrMultiUserScheduler::m_countersStart),
+                          MakeTimeChecker())
+            .AddAttribute("MuDecisions",
+                          "Number of DL and UL MU TXVECTORs finalized (read-only)",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RrMultiUserScheduler::m_nMuDecisions),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("TrimmedCandidates",
+                          "Number of candidate stations dropped because they could not be "
+                          "allocated equal-sized RUs (read-only)",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RrMultiUserScheduler::m_nTrimmedCandidates),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("UnsolicitedSkips",
+                          "Number of times a station was skipped because it could not be "
+                          "solicited by a Trigger Frame (read-only)",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RrMultiUserScheduler::m_nUnsolicitedSkips),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("NoTxTxopTooShort",
+                          "Number of NO_TX returned because the remaining TXOP cannot fit the "
+                          "Trigger Frame exchange (read-only)",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RrMultiUserScheduler::m_nNoTxTxopTooShort),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("NoTxUlTooShort",
+                          "Number of NO_TX returned because the time left for the TB PPDU "
+                          "cannot carry UlPsduSize bytes (read-only)",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RrMultiUserScheduler::m_nNoTxUlTooShort),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("NoTxNoDlFrames",
+                          "Number of NO_TX returned because no DL frame met the constraints "
+                          "and ForceDlOfdma is enabled (read-only)",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RrMultiUserScheduler::m_nNoTxNoDlFrames),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("RuUtilization",
+                          "Tones allocated to stations divided by the tones of the MU PPDUs "
+                          "(read-only)",
+                          TypeId::ATTR_GET,
+                          DoubleValue(0),
+                          MakeDoubleAccessor(&RrMultiUserScheduler::GetRuUtilization),
+                          MakeDoubleChecker<double>())
+            .AddAttribute("BsrpAirtime",
+                          "Airtime of the BSRP Trigger Frames and of the solicited QoS Null "
+                          "frames (read-only)",
+                          TypeId::ATTR_GET,
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&RrMultiUserScheduler::m_bsrpAirtime),
+                          MakeTimeChecker())
+            .AddAttribute("DataAirtime",
+                          "Airtime of the DL MU PPDUs and of the solicited TB PPDUs (read-only)",
+                          TypeId::ATTR_GET,
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&RrMultiUserScheduler::m_dataAirtime),
+                          MakeTimeChecker())
+            .AddAttribute("LoadAwareChanges",
+                          "Number of MU PPDUs whose RU size was changed by LoadAwareRus "
+                          "(read-only)",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RrMultiUserScheduler::m_nLoadAwareChanges),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("LoadAwareAirtimeSaved",
+                          "Estimated airtime saved by LoadAwareRus, i.e., the airtime the "
+                          "count-based RU size would have taken to deliver the same data minus "
+                          "the airtime actually taken (read-only)",
+                          TypeId::ATTR_GET,
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&RrMultiUserScheduler::m_loadAwareSaved),
+                          MakeTimeChecker())
+            .AddAttribute("DlMuPpdus",
+                          "Number of DL MU PPDUs built (read-only)",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RrMultiUserScheduler::m_nDlMuPpdus),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("AggregatedMpdus",
+                          "Number of MPDUs aggregated in DL MU PPDUs (read-only)",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RrMultiUserScheduler::m_nAggregatedMpdus),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("SecondaryPsdus",
+                          "Number of PSDUs of DL MU PPDUs other than the longest PSDU of their "
+                          "PPDU (read-only)",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RrMultiUserScheduler::m_nSecondaryPsdus),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("SecondaryMpdus",
+                          "Number of MPDUs aggregated in the SecondaryPsdus (read-only)",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RrMultiUserScheduler::m_nSecondaryMpdus),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("AggregationTime",
+                          "Wall-clock time spent building the A-MSDUs and A-MPDUs of DL MU "
+                          "PPDUs (read-only)",
+                          TypeId::ATTR_GET,
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&RrMultiUserScheduler::m_aggregationTime),
+                          MakeTimeChecker())
+            .AddAttribute("PaddingFraction",
+                          "Mean fraction of the RU airtime of the DL MU PPDUs carrying padding "
+                          "(read-only)",
+                          TypeId::ATTR_GET,
+                          DoubleValue(0),
+                          MakeDoubleAccessor(&RrMultiUserScheduler::GetPaddingFraction),
+                          MakeDoubleChecker<double>())
+            .AddAttribute("BsrAnomalies",
+                          "Number of times a station was flagged as sending inflated buffer "
+                          "status reports (read-only)",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RrMultiUserScheduler::m_nBsrAnomalies),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("SizedTriggerFrames",
+                          "Number of BSRP and Basic Trigger Frames whose UL length was computed "
+                          "(read-only)",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RrMultiUserScheduler::m_nSizedTfs),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("TfSizingTime",
+                          "Wall-clock time spent computing the durations of the HE TB PPDUs "
+                          "solicited by the Trigger Frames (read-only)",
+                          TypeId::ATTR_GET,
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&RrMultiUserScheduler::m_tfSizingTime),
+                          MakeTimeChecker())
+            .AddAttribute("TxDurationHits",
+                          "Number of HE TB PPDU durations read from the cache (read-only)",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RrMultiUserScheduler::m_nTxDurationHits),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("TxDurationMisses",
+                          "Number of HE TB PPDU durations computed by the PHY (read-only)",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RrMultiUserScheduler::m_nTxDurationMisses),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("BsrpToDataRatio",
+                          "BsrpAirtime divided by DataAirtime (read-only)",
+                          TypeId::ATTR_GET,
+                          DoubleValue(0),
+                          MakeDoubleAccessor(&RrMultiUserScheduler::GetBsrpToDataRatio),
+                          MakeDoubleChecker<double>())
+            .AddTraceSource("ScheduleStats",
+                            "Outcome of the selection of the stations to solicit in an UL MU "
+                            "transmission",
+                            MakeTraceSourceAccessor(&RrMultiUserScheduler::m_scheduleStatsTrace),
+                            "ns3::RrMultiUserScheduler::ScheduleStatsCallback")
+            .AddTraceSource("DlPadding",
+                            "Fraction of the RU airtime of a DL MU PPDU carrying padding",
+                            MakeTraceSourceAccessor(&RrMultiUserScheduler::m_paddingTrace),
+                            "ns3::RrMultiUserScheduler::PaddingCallback")
+            .AddTraceSource("AirtimeCharged",
+                            "Airtime charged to a station: its bandwidth share of a DL MU PPDU, "
+                            "of a solicited TB PPDU or of a BSRP TF exchange, or a DL SU PPDU",
+                            MakeTraceSourceAccessor(&RrMultiUserScheduler::m_airtimeTrace),
+                            "ns3::RrMultiUserScheduler::AirtimeCallback")
+            .AddTraceSource("BsrAnomaly",
+                            "A station was flagged or unflagged as sending inflated buffer "
+                            "status reports",
+                            MakeTraceSourceAccessor(&RrMultiUserScheduler::m_bsrAnomalyTrace),
+                            "ns3::RrMultiUserScheduler::BsrAnomalyCallback");
     return tid;
 }
 
@@ -102,7 +422,24 @@ RrMultiUserScheduler::DoInitialize()
         MakeCallback(&RrMultiUserScheduler::NotifyStationDeassociated, this));
     for (const auto& ac : wifiAcList)
     {
-        m_staListDl.insert({ac.first, {}});
+        m_staListDl.insert({ac.first, StaList{{}, 0, ac.first}});
+    }
+    m_staListUl.column = N_STA_LISTS - 1;
+    for (uint8_t linkId = 0; linkId < m_apMac->GetNLinks(); linkId++)
+    {
+        m_phys.push_back(m_apMac->GetWifiPhy(linkId));
+        m_phys.back()->TraceConnectWithoutContext(
+            "PhyTxPsduBegin",
+            MakeCallback(&RrMultiUserScheduler::NotifyPsduTxBegin, this).Bind(linkId));
+        m_phys.back()->TraceConnectWithoutContext(
+            "MonitorSnifferRx",
+            MakeCallback(&RrMultiUserScheduler::NotifyMonitorSnifferRx, this).Bind(linkId));
+    }
+    if (m_countersStart.IsStrictlyPositive())
+    {
+        m_resetCountersEvent = Simulator::Schedule(m_countersStart - Simulator::Now(),
+                                                   &RrMultiUserScheduler::ResetCounters,
+                                                   this);
     }
     MultiUserScheduler::DoInitialize();
 }
@@ -112,15 +449,32 @@ RrMultiUserScheduler::DoDispose()
 {
     NS_LOG_FUNCTION(this);
     m_staListDl.clear();
-    m_staListUl.clear();
+    m_staListUl = StaList{{}, 0, N_STA_LISTS - 1};
+    m_staTable = StaTable{};
+    m_slotByAid.clear();
+    m_slotByAddress.clear();
+    m_deadlines.clear();
     m_candidates.clear();
     m_txParams.Clear();
+    m_txDurations.clear();
+    m_resetCountersEvent.Cancel();
     m_apMac->TraceDisconnectWithoutContext(
         "AssociatedSta",
         MakeCallback(&RrMultiUserScheduler::NotifyStationAssociated, this));
     m_apMac->TraceDisconnectWithoutContext(
         "DeAssociatedSta",
         MakeCallback(&RrMultiUserScheduler::NotifyStationDeassociated, this));
+    // the PHYs are kept since the links of the MAC may have been disposed already
+    for (uint8_t linkId = 0; linkId < m_phys.size(); linkId++)
+    {
+        m_phys[linkId]->TraceDisconnectWithoutContext(
+            "PhyTxPsduBegin",
+            MakeCallback(&RrMultiUserScheduler::NotifyPsduTxBegin, this).Bind(linkId));
+        m_phys[linkId]->TraceDisconnectWithoutContext(
+            "MonitorSnifferRx",
+            MakeCallback(&RrMultiUserScheduler::NotifyMonitorSnifferRx, this).Bind(linkId));
+    }
+    m_phys.clear();
     MultiUserScheduler::DoDispose();
 }
 
@@ -167,24 +521,21 @@ RrMultiUserScheduler::GetTxVectorForUlMu(Func canBeSolicited)
 
     NS_LOG_DEBUG("\n--------------------------");
     NS_LOG_DEBUG("\tUL OFDMA enabled: " << (m_enableUlOfdma ? "Yes" : "No"));
-    NS_LOG_DEBUG("\t m_nStations=" << uint(m_nStations) << ", m_staListUl.size()=" << m_staListUl.size());
+    NS_LOG_DEBUG("\t max stations=" << GetMaxNStations() << ", m_staListUl.size()=" << m_staListUl.stas.size());
     // determine RUs to allocate to stations
-    auto count = std::min<std::size_t>(m_nStations, m_staListUl.size());
+    auto nStas = std::min(GetMaxNStations(), m_staListUl.stas.size());
+    auto count = nStas;
     std::size_t nCentral26TonesRus;
     NS_LOG_DEBUG("\tAllowed width (MHz): " << m_allowedWidth);
     HeRu::RuType ruType = HeRu::GetEqualSizedRusForStations(m_allowedWidth, count, nCentral26TonesRus);
     NS_ASSERT(count >= 1);
     NS_LOG_DEBUG("\t[First schedule] " << count << " stations are being assigned a " << ruType << " RU");
+    nCentral26TonesRus = GetNCentral26TonesRus(nStas, count, nCentral26TonesRus);
     if (nCentral26TonesRus > 0)
     {
         NS_LOG_DEBUG("\t[26-tone schedule] " << nCentral26TonesRus << " stations are being assigned a 26-tone RU");
     }
 
-    if (!m_useCentral26TonesRus)
-    {
-        nCentral26TonesRus = 0;
-    }
-
     Ptr<HeConfiguration> heConfiguration = m_apMac->GetHeConfiguration();
     NS_ASSERT(heConfiguration);
 
@@ -194,29 +545,35 @@ RrMultiUserScheduler::GetTxVectorForUlMu(Func canBeSolicited)
     txVector.SetGuardInterval(heConfiguration->GetGuardInterval().GetNanoSeconds());
     txVector.SetBssColor(heConfiguration->GetBssColor());
 
+    if (m_latencyAware)
+    {
+        SortByDeadline(m_staListUl, AC_UNDEF);
+    }
+
     // iterate over the associated stations until an enough number of stations is identified
-    auto staIt = m_staListUl.begin();
+    auto staIt = m_staListUl.stas.begin();
     //* Here, the list of stations is cleared and to be added below.
     m_candidates.clear();
 
     uint unsolictedStas = 0;
 
-    while (staIt != m_staListUl.end() &&
-           txVector.GetHeMuUserInfoMap().size() <
-               std::min<std::size_t>(m_nStations, count + nCentral26TonesRus))
+    while (staIt != m_staListUl.stas.end() &&
+           txVector.GetHeMuUserInfoMap().size() < count + nCentral26TonesRus)
     {
-        NS_LOG_DEBUG("Next candidate STA (MAC=" << staIt->address << ", AID=" << staIt->aid << ")");
+        NS_LOG_DEBUG("Next candidate STA (MAC=" << m_staTable.address[*staIt]
+                                                << ", AID=" << m_staTable.aid[*staIt] << ")");
 
-        if (!canBeSolicited(*staIt))
+        if (!canBeSolicited(m_staTable.aid[*staIt], m_staTable.address[*staIt]))
         {
             NS_LOG_DEBUG("Skipping the STA since it cannot be solicited");
             staIt++;
             unsolictedStas++;
+            m_nUnsolicitedSkips++;
             continue;
         }
 
         if (txVector.GetPreambleType() == WIFI_PREAMBLE_EHT_TB &&
-            !m_apMac->GetEhtSupported(staIt->address))
+            !m_apMac->GetEhtSupported(m_staTable.address[*staIt]))
         {
             NS_LOG_DEBUG(
                 "Skipping non-EHT STA because this Trigger Frame is only soliciting EHT STAs");
@@ -229,7 +586,7 @@ RrMultiUserScheduler::GetTxVectorForUlMu(Func canBeSolicited)
         {
             // check that a BA agreement is established with the receiver for the
             // considered TID, since ack sequences for UL MU require block ack
-            if (m_apMac->GetBaAgreementEstablishedAsRecipient(staIt->address, tid))
+            if (m_apMac->GetBaAgreementEstablishedAsRecipient(m_staTable.address[*staIt], tid))
             {
                 break;
             }
@@ -237,7 +594,7 @@ RrMultiUserScheduler::GetTxVectorForUlMu(Func canBeSolicited)
         }
         if (tid == 8) //* Only first 8 values are actually used in practice.
         {
-            NS_LOG_DEBUG("No Block Ack agreement established with " << staIt->address);
+            NS_LOG_DEBUG("No Block Ack agreement established with " << m_staTable.address[*staIt]);
             staIt++;
             continue;
         }
@@ -245,7 +602,7 @@ RrMultiUserScheduler::GetTxVectorForUlMu(Func canBeSolicited)
         // if the first candidate STA is an EHT STA, we switch to soliciting EHT TB PPDUs
         if (txVector.GetHeMuUserInfoMap().empty())
         {
-            if (m_apMac->GetEhtSupported() && m_apMac->GetEhtSupported(staIt->address))
+            if (m_apMac->GetEhtSupported() && m_apMac->GetEhtSupported(m_staTable.address[*staIt]))
             {
                 txVector.SetPreambleType(WIFI_PREAMBLE_EHT_TB);
                 txVector.SetEhtPpduType(0);
@@ -257,12 +614,12 @@ RrMultiUserScheduler::GetTxVectorForUlMu(Func canBeSolicited)
         // just for the purpose of retrieving the TXVECTOR used to transmit to that station
         WifiMacHeader hdr(WIFI_MAC_QOSDATA);
         hdr.SetAddr1(GetWifiRemoteStationManager(m_linkId)
-                         ->GetAffiliatedStaAddress(staIt->address)
-                         .value_or(staIt->address));
+                         ->GetAffiliatedStaAddress(m_staTable.address[*staIt])
+                         .value_or(m_staTable.address[*staIt]));
         hdr.SetAddr2(m_apMac->GetFrameExchangeManager(m_linkId)->GetAddress());
         WifiTxVector suTxVector =
             GetWifiRemoteStationManager(m_linkId)->GetDataTxVector(hdr, m_allowedWidth);
-        txVector.SetHeMuUserInfo(staIt->aid,
+        txVector.SetHeMuUserInfo(m_staTable.aid[*staIt],
                                  {HeRu::RuSpec(), // assigned later by FinalizeTxVector
                                   suTxVector.GetMode().GetMcsValue(),
                                   suTxVector.GetNss()});
@@ -280,8 +637,11 @@ RrMultiUserScheduler::GetTxVectorForUlMu(Func canBeSolicited)
 
     size_t initial_candidates = m_candidates.size();
     FinalizeTxVector(txVector);
-    std::cout << Simulator::Now().GetMicroSeconds() << "," << m_staListUl.size() << "," << unsolictedStas << "," 
-              << count << "," << initial_candidates << "," << m_candidates.size() << "\n";
+    m_scheduleStatsTrace(m_staListUl.stas.size(),
+                         unsolictedStas,
+                         count,
+                         initial_candidates,
+                         m_candidates.size());
     // for (const auto& entry : txVector.GetHeMuUserInfoMap()) {
     //     uint16_t staId = entry.first;
     //     const HeMuUserInfo& info = entry.second;
@@ -304,16 +664,16 @@ RrMultiUserScheduler::TrySendingBsrpTf()
 {
     NS_LOG_FUNCTION(this);
 
-    if (m_staListUl.empty())
+    if (m_staListUl.stas.empty())
     {
         NS_LOG_DEBUG("No HE stations associated: return SU_TX");
         return TxFormat::SU_TX;
     }
 
     // only consider stations that have setup the current link
-    WifiTxVector txVector = GetTxVectorForUlMu([this](const MasterInfo& info) {
+    WifiTxVector txVector = GetTxVectorForUlMu([this](uint16_t aid, const Mac48Address&) {
         const auto& staList = m_apMac->GetStaList(m_linkId);
-        return staList.find(info.aid) != staList.cend();
+        return staList.find(aid) != staList.cend();
     });
 
     if (txVector.GetHeMuUserInfoMap().empty())
@@ -339,19 +699,23 @@ RrMultiUserScheduler::TrySendingBsrpTf()
         // this way, no transmission will occur now and the next time we will
         // try again sending a BSRP Trigger Frame.
         NS_LOG_DEBUG("Remaining TXOP duration is not enough for BSRP TF exchange");
+        m_nNoTxTxopTooShort++;
         return NO_TX;
     }
 
     // Compute the time taken by each station to transmit 8 QoS Null frames
+    auto start = std::chrono::steady_clock::now();
+    uint32_t qosNullSize = GetMaxSizeOfQosNullAmpdu(m_trigger);
     Time qosNullTxDuration = Seconds(0);
     for (const auto& userInfo : m_trigger)
     {
-        Time duration = WifiPhy::CalculateTxDuration(GetMaxSizeOfQosNullAmpdu(m_trigger),
-                                                     txVector,
-                                                     m_apMac->GetWifiPhy(m_linkId)->GetPhyBand(),
-                                                     userInfo.GetAid12());
+        Time duration = GetTbPpduDuration(qosNullSize, txVector, userInfo.GetAid12());
         qosNullTxDuration = Max(qosNullTxDuration, duration);
     }
+    m_tfSizingTime += NanoSeconds(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                      std::chrono::steady_clock::now() - start)
+                                      .count());
+    m_nSizedTfs++;
 
     if (m_availableTime != Time::Min())
     {
@@ -367,6 +731,7 @@ RrMultiUserScheduler::TrySendingBsrpTf()
             m_availableTime)
         {
             NS_LOG_DEBUG("Remaining TXOP duration is not enough for BSRP TF exchange");
+            m_nNoTxTxopTooShort++;
             return NO_TX;
         }
     }
@@ -378,6 +743,23 @@ RrMultiUserScheduler::TrySendingBsrpTf()
         m_apMac->GetWifiPhy(m_linkId)->GetPhyBand());
     NS_LOG_DEBUG("Duration of QoS Null frames: " << qosNullTxDuration.As(Time::MS));
     m_trigger.SetUlLength(ulLength);
+    Time bsrpAirtime =
+        m_txParams.m_txDuration + m_apMac->GetWifiPhy(m_linkId)->GetSifs() + qosNullTxDuration;
+    m_bsrpAirtime += bsrpAirtime;
+
+    // the exchange is charged to the solicited stations in proportion to their RU
+    uint16_t totalMhz = 0;
+    for (const auto& userInfo : txVector.GetHeMuUserInfoMap())
+    {
+        totalMhz += HeRu::GetBandwidth(userInfo.second.ru.GetRuType());
+    }
+    for (const auto& candidate : m_candidates)
+    {
+        auto userInfo = txVector.GetHeMuUserInfo(m_staTable.aid[*candidate.first]);
+        ChargeAirtime(*candidate.first,
+                      AIRTIME_BSRP,
+                      bsrpAirtime * HeRu::GetBandwidth(userInfo.ru.GetRuType()) / totalMhz);
+    }
 
     return UL_MU_TX;
 }
@@ -387,7 +769,7 @@ RrMultiUserScheduler::TrySendingBasicTf()
 {
     NS_LOG_FUNCTION(this);
 
-    if (m_staListUl.empty())
+    if (m_staListUl.stas.empty())
     {
         NS_LOG_DEBUG("No HE stations associated: return SU_TX");
         return TxFormat::SU_TX;
@@ -398,11 +780,12 @@ RrMultiUserScheduler::TrySendingBasicTf()
 
     // only consider stations that have setup the current link and do not have
     // reported a null queue size
-    WifiTxVector txVector = GetTxVectorForUlMu([this](const MasterInfo& info) {
-        const auto& staList = m_apMac->GetStaList(m_linkId);
-        return staList.find(info.aid) != staList.cend() &&
-               m_apMac->GetMaxBufferStatus(info.address) > 0;
-    });
+    WifiTxVector txVector =
+        GetTxVectorForUlMu([this](uint16_t aid, const Mac48Address& address) {
+            const auto& staList = m_apMac->GetStaList(m_linkId);
+            return staList.find(aid) != staList.cend() &&
+                   m_apMac->GetMaxBufferStatus(address) > 0;
+        });
 
     if (txVector.GetHeMuUserInfoMap().empty())
     {
@@ -418,7 +801,13 @@ RrMultiUserScheduler::TrySendingBasicTf()
         NS_ASSERT_MSG(address, "AID " << candidate.first << " not found");
 
         uint8_t queueSize = m_apMac->GetMaxBufferStatus(*address);
-        if (queueSize == 255)
+        if (auto clamped = GetClampedUlBuffer(m_slotByAid[candidate.first]))
+        {
+            NS_LOG_DEBUG("Buffer status of station " << *address << " is clamped to "
+                                                     << *clamped);
+            maxBufferSize = std::max(maxBufferSize, *clamped);
+        }
+        else if (queueSize == 255)
         {
             NS_LOG_DEBUG("Buffer status of station " << *address << " is unknown");
             maxBufferSize = std::max(maxBufferSize, m_ulPsduSize);
@@ -461,6 +850,7 @@ RrMultiUserScheduler::TrySendingBasicTf()
         // this way, no transmission will occur now and the next time we will
         // try again performing an UL OFDMA transmission.
         NS_LOG_DEBUG("Remaining TXOP duration is not enough for UL MU exchange");
+        m_nNoTxTxopTooShort++;
         return NO_TX;
     }
 
@@ -480,20 +870,20 @@ RrMultiUserScheduler::TrySendingBasicTf()
         if (maxDuration.IsNegative())
         {
             NS_LOG_DEBUG("Remaining TXOP duration is not enough for UL MU exchange");
+            m_nNoTxTxopTooShort++;
             return NO_TX;
         }
     }
 
     // Compute the time taken by each station to transmit a frame of maxBufferSize size
+    auto start = std::chrono::steady_clock::now();
     Time bufferTxTime = Seconds(0);
     for (const auto& userInfo : m_trigger)
     {
-        Time duration = WifiPhy::CalculateTxDuration(maxBufferSize,
-                                                     txVector,
-                                                     m_apMac->GetWifiPhy(m_linkId)->GetPhyBand(),
-                                                     userInfo.GetAid12());
+        Time duration = GetTbPpduDuration(maxBufferSize, txVector, userInfo.GetAid12());
         bufferTxTime = Max(bufferTxTime, duration);
     }
+    m_nSizedTfs++;
 
     if (bufferTxTime < maxDuration)
     {
@@ -507,24 +897,28 @@ RrMultiUserScheduler::TrySendingBasicTf()
         Time minDuration = Seconds(0);
         for (const auto& userInfo : m_trigger)
         {
-            Time duration =
-                WifiPhy::CalculateTxDuration(m_ulPsduSize,
-                                             txVector,
-                                             m_apMac->GetWifiPhy(m_linkId)->GetPhyBand(),
-                                             userInfo.GetAid12());
+            Time duration = GetTbPpduDuration(m_ulPsduSize, txVector, userInfo.GetAid12());
             minDuration = (minDuration.IsZero() ? duration : Min(minDuration, duration));
         }
 
         if (maxDuration < minDuration)
         {
+            m_tfSizingTime += NanoSeconds(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                              std::chrono::steady_clock::now() - start)
+                                              .count());
             // maxDuration is a too short time, hence return NO_TX. In this way,
             // no transmission will occur now and the next time we will try again
             // performing an UL OFDMA transmission.
             NS_LOG_DEBUG("Available time " << maxDuration.As(Time::MS) << " is too short");
+            m_nNoTxUlTooShort++;
             return NO_TX;
         }
     }
 
+    m_tfSizingTime += NanoSeconds(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                      std::chrono::steady_clock::now() - start)
+                                      .count());
+
     // maxDuration is the time to grant to the stations. Finalize the Trigger Frame
     uint16_t ulLength;
     std::tie(ulLength, maxDuration) =
@@ -540,6 +934,24 @@ RrMultiUserScheduler::TrySendingBasicTf()
     }
 
     UpdateCredits(m_staListUl, maxDuration, txVector);
+    m_dataAirtime += maxDuration;
+
+    // the solicited stations are expected to fill their RU up to what they reported
+    for (auto it = m_candidates.cbegin(); m_bsrPolicy != BSR_OFF && it != m_candidates.cend(); it++)
+    {
+        auto slot = *it->first;
+        auto userInfo = txVector.GetHeMuUserInfo(m_staTable.aid[slot]);
+        double capacity = HePhy::GetDataRate(userInfo.mcs,
+                                             HeRu::GetBandwidth(userInfo.ru.GetRuType()),
+                                             txVector.GetGuardInterval(),
+                                             userInfo.nss) /
+                          8.0 * maxDuration.GetSeconds();
+        uint8_t queueSize = m_apMac->GetMaxBufferStatus(m_staTable.address[slot]);
+        UpdateUlReport(slot,
+                       (queueSize == 255   ? 0
+                        : queueSize == 254 ? capacity
+                                           : std::min(queueSize * 256.0, capacity)));
+    }
 
     return UL_MU_TX;
 }
@@ -557,26 +969,70 @@ RrMultiUserScheduler::NotifyStationAssociated(uint16_t aid, Mac48Address address
     auto mldOrLinkAddress = m_apMac->GetMldOrLinkAddressByAid(aid);
     NS_ASSERT_MSG(mldOrLinkAddress, "AID " << aid << " not found");
 
+    // if this is not the first STA of a non-AP MLD to be notified, an entry for this
+    // non-AP MLD already exists in all the lists. Looking up the slot of the AID avoids
+    // scanning the lists, which becomes quadratic with hundreds of stations
+    if (aid >= m_slotByAid.size())
+    {
+        m_slotByAid.resize(aid + 1, NO_SLOT);
+    }
+    if (m_slotByAid[aid] != NO_SLOT)
+    {
+        m_slotByAddress[address] = m_slotByAid[aid];
+        return;
+    }
+
+    uint32_t slot;
+    if (!m_staTable.freeSlots.empty())
+    {
+        slot = m_staTable.freeSlots.back();
+        m_staTable.freeSlots.pop_back();
+        m_staTable.aid[slot] = aid;
+        m_staTable.address[slot] = *mldOrLinkAddress;
+        m_staTable.ulBacklogSince[slot] = Time::Max();
+        m_staTable.airtime[slot] = {};
+        m_staTable.ulReports[slot] = {};
+    }
+    else
+    {
+        slot = m_staTable.aid.size();
+        m_staTable.aid.push_back(aid);
+        m_staTable.address.push_back(*mldOrLinkAddress);
+        m_staTable.credits.emplace_back();
+        m_staTable.latencyTarget.emplace_back();
+        m_staTable.ulBacklogSince.push_back(Time::Max());
+        m_staTable.airtime.emplace_back();
+        m_staTable.ulReports.emplace_back();
+    }
+    auto targetIt = m_latencyTargets.find(*mldOrLinkAddress);
+    m_staTable.latencyTarget[slot] =
+        (targetIt != m_latencyTargets.end() ? targetIt->second : Time());
+    m_slotByAid[aid] = slot;
+    m_slotByAddress[address] = slot;
+    m_slotByAddress[*mldOrLinkAddress] = slot;
+
     for (auto& staList : m_staListDl)
     {
-        // if this is not the first STA of a non-AP MLD to be notified, an entry
-        // for this non-AP MLD already exists
-        const auto staIt = std::find_if(staList.second.cbegin(),
-                                        staList.second.cend(),
-                                        [aid](auto&& info) { return info.aid == aid; });
-        if (staIt == staList.second.cend())
-        {
-            staList.second.push_back(MasterInfo{aid, *mldOrLinkAddress, 0.0});
-        }
+        AddStation(staList.second, slot);
     }
+    AddStation(m_staListUl, slot);
+}
 
-    const auto staIt = std::find_if(m_staListUl.cbegin(), m_staListUl.cend(), [aid](auto&& info) {
-        return info.aid == aid;
-    });
-    if (staIt == m_staListUl.cend())
+void
+RrMultiUserScheduler::AddStation(StaList& staList, uint32_t slot)
+{
+    // new stations start with zero credits, hence compensate for the list offset
+    auto& credits = m_staTable.credits[slot][staList.column];
+    credits = -staList.creditOffset;
+
+    // keep the list sorted; stations with negative credits (if any) are at the end
+    auto it = staList.stas.end();
+    while (it != staList.stas.begin() &&
+           m_staTable.credits[*std::prev(it)][staList.column] < credits)
     {
-        m_staListUl.push_back(MasterInfo{aid, *mldOrLinkAddress, 0.0});
+        --it;
     }
+    staList.stas.insert(it, slot);
 }
 
 void
@@ -591,6 +1047,7 @@ RrMultiUserScheduler::NotifyStationDeassociated(uint16_t aid, Mac48Address addre
 
     auto mldOrLinkAddress = m_apMac->GetMldOrLinkAddressByAid(aid);
     NS_ASSERT_MSG(mldOrLinkAddress, "AID " << aid << " not found");
+    m_slotByAddress.erase(address);
 
     if (m_apMac->IsAssociated(*mldOrLinkAddress))
     {
@@ -598,11 +1055,71 @@ RrMultiUserScheduler::NotifyStationDeassociated(uint16_t aid, Mac48Address addre
         return;
     }
 
+    if (aid >= m_slotByAid.size() || m_slotByAid[aid] == NO_SLOT)
+    {
+        return;
+    }
+    uint32_t slot = m_slotByAid[aid];
+
     for (auto& staList : m_staListDl)
     {
-        staList.second.remove_if([&aid](const MasterInfo& info) { return info.aid == aid; });
+        staList.second.stas.remove(slot);
+    }
+    m_staListUl.stas.remove(slot);
+    m_slotByAid[aid] = NO_SLOT;
+    m_slotByAddress.erase(*mldOrLinkAddress);
+    m_staTable.freeSlots.push_back(slot);
+}
+
+void
+RrMultiUserScheduler::NotifyPsduTxBegin(uint8_t linkId,
+                                        WifiConstPsduMap psduMap,
+                                        WifiTxVector txVector,
+                                        double txPowerW)
+{
+    // MU PPDUs are charged by UpdateCredits
+    if (txVector.IsMu() || psduMap.size() != 1 ||
+        !psduMap.begin()->second->GetHeader(0).IsQosData())
+    {
+        return;
+    }
+    auto psdu = psduMap.begin()->second;
+    auto slotIt = m_slotByAddress.find(psdu->GetAddr1());
+    if (slotIt == m_slotByAddress.end())
+    {
+        return;
+    }
+    ChargeAirtime(slotIt->second,
+                  AIRTIME_SU,
+                  WifiPhy::CalculateTxDuration(psdu->GetSize(),
+                                               txVector,
+                                               m_apMac->GetWifiPhy(linkId)->GetPhyBand()));
+}
+
+void
+RrMultiUserScheduler::NotifyMonitorSnifferRx(uint8_t linkId,
+                                             Ptr<const Packet> packet,
+                                             uint16_t channelFreqMhz,
+                                             WifiTxVector txVector,
+                                             MpduInfo aMpdu,
+                                             SignalNoiseDbm signalNoise,
+                                             uint16_t staId)
+{
+    if (m_bsrPolicy == BSR_OFF || !txVector.IsUlMu())
+    {
+        return;
+    }
+    WifiMacHeader hdr;
+    packet->PeekHeader(hdr);
+    if (!hdr.IsQosData() || !hdr.HasData())
+    {
+        return;
+    }
+    auto slotIt = m_slotByAddress.find(hdr.GetAddr2());
+    if (slotIt != m_slotByAddress.end())
+    {
+        m_staTable.ulReports[slotIt->second].delivered += packet->GetSize();
     }
-    m_staListUl.remove_if([&aid](const MasterInfo& info) { return info.aid == aid; });
 }
 
 MultiUserScheduler::TxFormat
@@ -612,26 +1129,22 @@ RrMultiUserScheduler::TrySendingDlMuPpdu()
 
     AcIndex primaryAc = m_edca->GetAccessCategory();
     NS_LOG_DEBUG("\t primaryAc=" << +primaryAc);
-    NS_LOG_DEBUG("\t m_staListDl[AC].size()=" << m_staListDl[primaryAc].size());
+    NS_LOG_DEBUG("\t m_staListDl[AC].size()=" << m_staListDl[primaryAc].stas.size());
 
-    if (m_staListDl[primaryAc].empty())
+    if (m_staListDl[primaryAc].stas.empty())
     {
         NS_LOG_DEBUG("No HE stations associated: return SU_TX");
         return TxFormat::SU_TX;
     }
 
-    std::size_t count =
-        std::min(static_cast<std::size_t>(m_nStations), m_staListDl[primaryAc].size());
+    std::size_t nStas = std::min(GetMaxNStations(), m_staListDl[primaryAc].stas.size());
+    std::size_t count = nStas;
     std::size_t nCentral26TonesRus;
     HeRu::RuType ruType =
         //! The scheduling has been run multiple times in different places instead of reusing the result.
         HeRu::GetEqualSizedRusForStations(m_allowedWidth, count, nCentral26TonesRus);
     NS_ASSERT(count >= 1);
-
-    if (!m_useCentral26TonesRus)
-    {
-        nCentral26TonesRus = 0;
-    }
+    nCentral26TonesRus = GetNCentral26TonesRus(nStas, count, nCentral26TonesRus);
 
     uint8_t currTid = wifiAcList.at(primaryAc).GetHighTid();
 
@@ -678,8 +1191,13 @@ RrMultiUserScheduler::TrySendingDlMuPpdu()
     // For the moment, we are considering just one MPDU per receiver.
     Time actualAvailableTime = (m_initialFrame ? Time::Min() : m_availableTime);
 
+    if (m_latencyAware)
+    {
+        SortByDeadline(m_staListDl[primaryAc], primaryAc);
+    }
+
     // iterate over the associated stations until an enough number of stations is identified
-    auto staIt = m_staListDl[primaryAc].begin();
+    auto staIt = m_staListDl[primaryAc].stas.begin();
     m_candidates.clear();
 
     std::vector<uint8_t> ruAllocations;
@@ -688,14 +1206,14 @@ RrMultiUserScheduler::TrySendingDlMuPpdu()
     ruAllocations.resize(numRuAllocs);
     NS_ASSERT((m_candidates.size() % numRuAllocs) == 0);
 
-    while (staIt != m_staListDl[primaryAc].end() &&
-           m_candidates.size() <
-               std::min(static_cast<std::size_t>(m_nStations), count + nCentral26TonesRus))
+    while (staIt != m_staListDl[primaryAc].stas.end() &&
+           m_candidates.size() < count + nCentral26TonesRus)
     {
-        NS_LOG_DEBUG("Next candidate STA (MAC=" << staIt->address << ", AID=" << staIt->aid << ")");
+        NS_LOG_DEBUG("Next candidate STA (MAC=" << m_staTable.address[*staIt]
+                                                << ", AID=" << m_staTable.aid[*staIt] << ")");
 
         if (m_txParams.m_txVector.GetPreambleType() == WIFI_PREAMBLE_EHT_MU &&
-            !m_apMac->GetEhtSupported(staIt->address))
+            !m_apMac->GetEhtSupported(m_staTable.address[*staIt]))
         {
             //* Skip Wifi 7 frames
             NS_LOG_DEBUG("Skipping non-EHT STA because this DL MU PPDU is sent to EHT STAs only");
@@ -712,9 +1230,11 @@ RrMultiUserScheduler::TrySendingDlMuPpdu()
             NS_ASSERT(ac >= primaryAc);
             // check that a BA agreement is established with the receiver for the
             // considered TID, since ack sequences for DL MU PPDUs require block ack
-            if (m_apMac->GetBaAgreementEstablishedAsOriginator(staIt->address, tid))
+            if (m_apMac->GetBaAgreementEstablishedAsOriginator(m_staTable.address[*staIt], tid))
             {
-                mpdu = m_apMac->GetQosTxop(ac)->PeekNextMpdu(m_linkId, tid, staIt->address);
+                mpdu = m_apMac->GetQosTxop(ac)->PeekNextMpdu(m_linkId,
+                                                             tid,
+                                                             m_staTable.address[*staIt]);
 
                 // we only check if the first frame of the current TID meets the size
                 // and duration constraints. We do not explore the queues further.
@@ -739,7 +1259,7 @@ RrMultiUserScheduler::TrySendingDlMuPpdu()
                         m_txParams.m_txVector.SetEhtPpduType(0); // indicates DL OFDMA transmission
                     }
 
-                    m_txParams.m_txVector.SetHeMuUserInfo(staIt->aid,
+                    m_txParams.m_txVector.SetHeMuUserInfo(m_staTable.aid[*staIt],
                                                           {{currRuType, 1, true},
                                                            suTxVector.GetMode().GetMcsValue(),
                                                            suTxVector.GetNss()});
@@ -752,8 +1272,8 @@ RrMultiUserScheduler::TrySendingDlMuPpdu()
                     else
                     {
                         // the frame meets the constraints
-                        NS_LOG_DEBUG("Adding candidate STA (MAC=" << staIt->address
-                                                                  << ", AID=" << staIt->aid
+                        NS_LOG_DEBUG("Adding candidate STA (MAC=" << m_staTable.address[*staIt]
+                                                                  << ", AID=" << m_staTable.aid[*staIt]
                                                                   << ") TID=" << +tid);
                         m_candidates.emplace_back(staIt, mpdu);
                         break; // terminate the for loop
@@ -761,7 +1281,8 @@ RrMultiUserScheduler::TrySendingDlMuPpdu()
                 }
                 else
                 {
-                    NS_LOG_DEBUG("No frames to send to " << staIt->address << " with TID=" << +tid);
+                    NS_LOG_DEBUG("No frames to send to " << m_staTable.address[*staIt]
+                                                         << " with TID=" << +tid);
                 }
             }
         }
@@ -775,6 +1296,7 @@ RrMultiUserScheduler::TrySendingDlMuPpdu()
         if (m_forceDlOfdma)
         {
             NS_LOG_DEBUG("The AP does not have suitable frames to transmit: return NO_TX");
+            m_nNoTxNoDlFrames++;
             return NO_TX;
         }
         NS_LOG_DEBUG("The AP does not have suitable frames to transmit: return SU_TX");
@@ -802,15 +1324,14 @@ RrMultiUserScheduler::FinalizeTxVector(WifiTxVector& txVector)
     NS_LOG_DEBUG("\t[Final schedule] " << nRusAssigned << " stations are being assigned a " << ruType << " RU");
     // std::cout << nRusAssigned << " stations are being assigned a " << ruType << " RU" << std::endl;
 
-    if (!m_useCentral26TonesRus || m_candidates.size() == nRusAssigned)
+    nCentral26TonesRus = GetNCentral26TonesRus(m_candidates.size(), nRusAssigned, nCentral26TonesRus);
+    if (m_loadAwareRus)
     {
-        nCentral26TonesRus = 0;
+        ruType = SelectRuTypeByLoad(txVector, ruType, nRusAssigned, nCentral26TonesRus);
     }
-    else
+    if (nCentral26TonesRus > 0)
     {
-        nCentral26TonesRus = std::min(m_candidates.size() - nRusAssigned, nCentral26TonesRus);
         NS_LOG_DEBUG("\t[Final schedule] " << nCentral26TonesRus << " stations are being assigned a 26-tone RU");
-        // std::cout << nCentral26TonesRus << " stations are being assigned a 26-tone RU\n" << std::endl;
     }
 
     // re-allocate RUs based on the actual number of candidate stations
@@ -826,7 +1347,7 @@ RrMultiUserScheduler::FinalizeTxVector(WifiTxVector& txVector)
     for (std::size_t i = 0; i < nRusAssigned + nCentral26TonesRus; i++)
     {
         NS_ASSERT(candidateIt != m_candidates.end());
-        auto mapIt = heMuUserInfoMap.find(candidateIt->first->aid);
+        auto mapIt = heMuUserInfoMap.find(m_staTable.aid[*candidateIt->first]);
         NS_ASSERT(mapIt != heMuUserInfoMap.end());
 
         txVector.SetHeMuUserInfo(mapIt->first,
@@ -837,13 +1358,594 @@ RrMultiUserScheduler::FinalizeTxVector(WifiTxVector& txVector)
     }
 
     // remove candidates that will not be served
+    m_nTrimmedCandidates += std::distance(candidateIt, m_candidates.end());
     m_candidates.erase(candidateIt, m_candidates.end());
+    m_nMuDecisions++;
+    CountAllocatedTones(txVector);
+    if (m_validateRus)
+    {
+        ValidateRuAllocation(txVector);
+    }
+}
+
+std::size_t
+RrMultiUserScheduler::GetMaxNStations() const
+{
+    if (m_nStations > 0)
+    {
+        return m_nStations;
+    }
+    // the smallest RUs serve the most stations; the allowed width may change at every
+    // channel access (e.g., when secondary channels are busy)
+    return HeRu::GetNRus(m_allowedWidth, HeRu::RU_26_TONE);
+}
+
+std::size_t
+RrMultiUserScheduler::GetNCentral26TonesRus(std::size_t nStas,
+                                            std::size_t nRus,
+                                            std::size_t nCentral26TonesRus) const
+{
+    if (!m_useCentral26TonesRus)
+    {
+        return 0;
+    }
+    // the central 26-tone RUs serve the stations left without an equal-sized RU
+    return std::min(nStas - nRus, nCentral26TonesRus);
+}
+
+HeRu::RuType
+RrMultiUserScheduler::SelectRuTypeByLoad(const WifiTxVector& txVector,
+                                         HeRu::RuType ruType,
+                                         std::size_t& nRus,
+                                         std::size_t& nCentral26TonesRus)
+{
+    NS_LOG_FUNCTION(this << ruType << nRus << nCentral26TonesRus);
+
+    // RUs of DL candidates were tentatively assigned when checking the time limits,
+    // hence they cannot shrink; RUs of UL candidates are still undefined
+    bool isUl = txVector.IsUlMu();
+    std::vector<HeRu::RuType> minRuTypes;
+
+    // demand (bytes), MCS and NSS of the candidates, in the order they are served
+    std::vector<std::tuple<double, uint8_t, uint8_t>> candidates;
+    for (const auto& candidate : m_candidates)
+    {
+        auto slot = *candidate.first;
+        const auto& userInfo = txVector.GetHeMuUserInfo(m_staTable.aid[slot]);
+        double demand;
+        if (isUl)
+        {
+            uint8_t queueSize = m_apMac->GetMaxBufferStatus(m_staTable.address[slot]);
+            auto clamped = GetClampedUlBuffer(slot);
+            demand = (clamped            ? *clamped
+                      : queueSize == 255 ? m_ulPsduSize
+                      : queueSize == 254 ? std::numeric_limits<double>::infinity()
+                                         : queueSize * 256.0);
+            minRuTypes.push_back(HeRu::RU_26_TONE);
+        }
+        else
+        {
+            minRuTypes.push_back(userInfo.ru.GetRuType());
+            uint8_t tid = candidate.second->GetHeader().GetQosTid();
+            demand = std::max<double>(
+                m_apMac->GetQosTxop(QosUtilsMapTidToAc(tid))
+                    ->GetQosQueueSize(tid, m_staTable.address[slot]),
+                candidate.second->GetSize());
+        }
+        candidates.emplace_back(demand, userInfo.mcs, userInfo.nss);
+    }
+
+    // the PPDU lasts until the largest demand is delivered, within the TXOP and the
+    // maximum PPDU duration
+    double maxDuration = GetPpduMaxTime(txVector.GetPreambleType()).GetSeconds();
+    if (m_availableTime.IsStrictlyPositive())
+    {
+        maxDuration = std::min(maxDuration, m_availableTime.GetSeconds());
+    }
+    auto gi = txVector.GetGuardInterval();
+
+    // return the airtime (seconds) of a MU transmission using the given RUs and set
+    // the delivered bytes
+    auto evaluate = [&](HeRu::RuType type, std::size_t n, std::size_t nCentral, double& bytes) {
+        std::vector<double> rates(n + nCentral); // bytes per second
+        double duration = 0;
+        for (std::size_t i = 0; i < rates.size(); i++)
+        {
+            const auto& [demand, mcs, nss] = candidates[i];
+            auto bw = HeRu::GetBandwidth(i < n ? type : HeRu::RU_26_TONE);
+            rates[i] = HePhy::GetDataRate(mcs, bw, gi, nss) / 8.0;
+            duration = std::max(duration, std::min(demand / rates[i], maxDuration));
+        }
+        bytes = 0;
+        for (std::size_t i = 0; i < rates.size(); i++)
+        {
+            bytes += std::min(std::get<0>(candidates[i]), rates[i] * duration);
+        }
+        return duration + m_loadAwareOverhead.GetSeconds();
+    };
+
+    double baseBytes;
+    double baseAirtime = evaluate(ruType, nRus, nCentral26TonesRus, baseBytes);
+    double bestBytes = baseBytes;
+    double bestAirtime = baseAirtime;
+    auto bestRuType = ruType;
+
+    for (auto type : {HeRu::RU_26_TONE,
+                      HeRu::RU_52_TONE,
+                      HeRu::RU_106_TONE,
+                      HeRu::RU_242_TONE,
+                      HeRu::RU_484_TONE,
+                      HeRu::RU_996_TONE,
+                      HeRu::RU_2x996_TONE})
+    {
+        if (type == ruType || HeRu::GetBandwidth(type) > m_allowedWidth)
+        {
+            continue;
+        }
+        auto n = std::min(candidates.size(), HeRu::GetNRus(m_allowedWidth, type));
+        auto nCentral = GetNCentral26TonesRus(
+            candidates.size(),
+            n,
+            (type == HeRu::RU_26_TONE ? 0
+                                      : HeRu::GetCentral26TonesRus(m_allowedWidth, type).size()));
+        bool shrinks = false;
+        for (std::size_t i = 0; i < n + nCentral; i++)
+        {
+            shrinks = shrinks || (i < n ? type : HeRu::RU_26_TONE) < minRuTypes[i];
+        }
+        if (shrinks)
+        {
+            continue;
+        }
+        double bytes;
+        double airtime = evaluate(type, n, nCentral, bytes);
+        // maximize the delivered bytes per unit of airtime
+        if (bytes * bestAirtime > bestBytes * airtime)
+        {
+            bestBytes = bytes;
+            bestAirtime = airtime;
+            bestRuType = type;
+            nRus = n;
+            nCentral26TonesRus = nCentral;
+        }
+    }
+
+    if (bestRuType != ruType && baseBytes > 0)
+    {
+        NS_LOG_DEBUG("\t[Load-aware schedule] " << nRus << " stations are being assigned a "
+                                                << bestRuType << " RU");
+        m_nLoadAwareChanges++;
+        m_loadAwareSaved += Seconds(bestBytes * baseAirtime / baseBytes - bestAirtime);
+    }
+    return bestRuType;
+}
+
+std::vector<double>
+RrMultiUserScheduler::GetDlPsduDurations(const WifiTxVector& txVector) const
+{
+    std::vector<double> psduDurations(m_staTable.aid.size());
+    for (const auto& [staIt, mpdu] : m_candidates)
+    {
+        auto slot = *staIt;
+        uint8_t tid = mpdu->GetHeader().GetQosTid();
+        const auto& userInfo = txVector.GetHeMuUserInfo(m_staTable.aid[slot]);
+        psduDurations[slot] =
+            m_apMac->GetQosTxop(QosUtilsMapTidToAc(tid))
+                ->GetQosQueueSize(tid, m_staTable.address[slot]) *
+            8.0 /
+            HePhy::GetDataRate(userInfo.mcs,
+                               HeRu::GetBandwidth(userInfo.ru.GetRuType()),
+                               txVector.GetGuardInterval(),
+                               userInfo.nss);
+    }
+    return psduDurations;
+}
+
+Time
+RrMultiUserScheduler::GetEqualizedDlMuPpduTime(const WifiTxParameters& txParams,
+                                               const std::vector<double>& psduDurations) const
+{
+    NS_LOG_FUNCTION(this);
+
+    // the PPDU cannot be shorter than the MPDUs already added to it
+    double minDuration = (txParams.m_txDuration - WifiPhy::CalculatePhyPreambleAndHeaderDuration(
+                                                      txParams.m_txVector))
+                             .GetSeconds();
+    Time overhead = WifiPhy::CalculatePhyPreambleAndHeaderDuration(txParams.m_txVector);
+    // if the protection or the acknowledgment time is unknown, the remaining TXOP cannot
+    // be compared against and only the maximum PPDU duration bounds the payload
+    NS_ASSERT(txParams.m_protection && txParams.m_acknowledgment);
+    bool knownOverhead = txParams.m_protection->protectionTime != Time::Min() &&
+                         txParams.m_acknowledgment->acknowledgmentTime != Time::Min();
+    if (knownOverhead)
+    {
+        overhead += txParams.m_protection->protectionTime +
+                    txParams.m_acknowledgment->acknowledgmentTime;
+    }
+    // the maximum PPDU duration only bounds the PPDU itself (preamble and payload)
+    double maxDuration =
+        (GetPpduMaxTime(txParams.m_txVector.GetPreambleType()) -
+         WifiPhy::CalculatePhyPreambleAndHeaderDuration(txParams.m_txVector))
+            .GetSeconds();
+    if (m_availableTime != Time::Min() && knownOverhead)
+    {
+        maxDuration = std::min(maxDuration, (m_availableTime - overhead).GetSeconds());
+    }
+    maxDuration = std::max(maxDuration, minDuration);
+
+    // the common duration is the one of a PSDU (or the maximum), trimming the longer
+    // PSDUs and topping up the shorter ones, that delivers the most data per unit of
+    // airtime (rates are normalized: a station with a PSDU of duration d delivers
+    // min(d, D) seconds worth of data within a PPDU of duration D)
+    std::vector<double> durations{maxDuration};
+    for (const auto& [staIt, mpdu] : m_candidates)
+    {
+        durations.push_back(std::clamp(psduDurations[*staIt], minDuration, maxDuration));
+    }
+    double bestDuration = maxDuration;
+    double bestEfficiency = -1;
+    for (auto duration : durations)
+    {
+        double delivered = 0;
+        for (const auto& [staIt, mpdu] : m_candidates)
+        {
+            delivered += std::min(psduDurations[*staIt], duration);
+        }
+        double efficiency = delivered / (duration + overhead.GetSeconds());
+        if (efficiency > bestEfficiency)
+        {
+            bestEfficiency = efficiency;
+            bestDuration = duration;
+        }
+    }
+    NS_LOG_DEBUG("Equalized DL MU PPDU payload duration: " << bestDuration * 1e6 << " us");
+    return Seconds(bestDuration) + overhead;
+}
+
+void
+RrMultiUserScheduler::CountSecondaryMpdus(const DlMuInfo& dlMuInfo)
+{
+    const auto& txVector = dlMuInfo.txParams.m_txVector;
+    double longestDuration = -1;
+    std::size_t longestMpdus = 0;
+    std::size_t mpdus = 0;
+    for (const auto& [aid, psdu] : dlMuInfo.psduMap)
+    {
+        const auto& userInfo = txVector.GetHeMuUserInfo(aid);
+        double duration = psdu->GetSize() * 8.0 /
+                          HePhy::GetDataRate(userInfo.mcs,
+                                             HeRu::GetBandwidth(userInfo.ru.GetRuType()),
+                                             txVector.GetGuardInterval(),
+                                             userInfo.nss);
+        if (duration > longestDuration)
+        {
+            longestDuration = duration;
+            longestMpdus = psdu->GetNMpdus();
+        }
+        mpdus += psdu->GetNMpdus();
+    }
+    if (!dlMuInfo.psduMap.empty())
+    {
+        m_nSecondaryPsdus += dlMuInfo.psduMap.size() - 1;
+        m_nSecondaryMpdus += mpdus - longestMpdus;
+    }
+}
+
+void
+RrMultiUserScheduler::TracePadding(const DlMuInfo& dlMuInfo)
+{
+    // fraction of the tones times the payload duration of the PPDU that carry padding
+    const auto& txVector = dlMuInfo.txParams.m_txVector;
+    std::vector<std::pair<double, double>> psdus; // bandwidth and duration of the PSDUs
+    double ppduDuration = 0;
+    for (const auto& [aid, psdu] : dlMuInfo.psduMap)
+    {
+        const auto& userInfo = txVector.GetHeMuUserInfo(aid);
+        auto bw = HeRu::GetBandwidth(userInfo.ru.GetRuType());
+        double duration = psdu->GetSize() * 8.0 /
+                          HePhy::GetDataRate(userInfo.mcs, bw, txVector.GetGuardInterval(), userInfo.nss);
+        psdus.emplace_back(bw, duration);
+        ppduDuration = std::max(ppduDuration, duration);
+    }
+    double used = 0;
+    double available = 0;
+    for (const auto& [bw, duration] : psdus)
+    {
+        used += bw * duration;
+        available += bw * ppduDuration;
+    }
+    double padding = (available > 0 ? 1 - used / available : 0);
+    m_paddingSum += padding;
+    m_paddingTrace(padding);
+}
+
+double
+RrMultiUserScheduler::GetPaddingFraction() const
+{
+    return (m_nDlMuPpdus > 0 ? m_paddingSum / m_nDlMuPpdus : 0);
+}
+
+void
+RrMultiUserScheduler::ValidateRuAllocation(const WifiTxVector& txVector) const
+{
+    std::vector<HeRu::RuSpec> rus;
+    for (const auto& [aid, userInfo] : txVector.GetHeMuUserInfoMap())
+    {
+        auto ruType = userInfo.ru.GetRuType();
+        NS_ABORT_MSG_IF(HeRu::GetBandwidth(ruType) > m_allowedWidth,
+                        "RU " << userInfo.ru << " assigned to AID " << aid << " exceeds "
+                              << m_allowedWidth << " MHz");
+        // the indices are relative to the 80 MHz segment selected by the primary80 flag,
+        // except for the 2x996-tone RU, which spans both segments of 160 MHz
+        auto nRus = (ruType == HeRu::RU_2x996_TONE
+                         ? HeRu::GetNRus(m_allowedWidth, ruType)
+                         : HeRu::GetNRus(std::min<uint16_t>(m_allowedWidth, 80), ruType));
+        NS_ABORT_MSG_IF(userInfo.ru.GetIndex() < 1 || userInfo.ru.GetIndex() > nRus,
+                        "Invalid index of RU " << userInfo.ru << " assigned to AID " << aid);
+        NS_ABORT_MSG_IF(HeRu::DoesOverlap(m_allowedWidth, userInfo.ru, rus),
+                        "RU " << userInfo.ru << " assigned to AID " << aid
+                              << " overlaps with another RU of the same PPDU");
+        rus.push_back(userInfo.ru);
+    }
+}
+
+void
+RrMultiUserScheduler::CountAllocatedTones(const WifiTxVector& txVector)
+{
+    for (const auto& userInfo : txVector.GetHeMuUserInfoMap())
+    {
+        m_allocatedTones += GetNTones(userInfo.second.ru.GetRuType());
+    }
+    m_availableTones += GetNTones(HeRu::GetRuType(m_allowedWidth));
+}
+
+double
+RrMultiUserScheduler::GetRuUtilization() const
+{
+    return (m_availableTones > 0 ? static_cast<double>(m_allocatedTones) / m_availableTones : 0);
+}
+
+double
+RrMultiUserScheduler::GetBsrpToDataRatio() const
+{
+    return (m_dataAirtime.IsStrictlyPositive()
+                ? m_bsrpAirtime.GetSeconds() / m_dataAirtime.GetSeconds()
+                : 0);
+}
+
+void
+RrMultiUserScheduler::ResetCounters()
+{
+    NS_LOG_FUNCTION(this);
+    m_nMuDecisions = 0;
+    m_nTrimmedCandidates = 0;
+    m_nUnsolicitedSkips = 0;
+    m_nNoTxTxopTooShort = 0;
+    m_nNoTxUlTooShort = 0;
+    m_nNoTxNoDlFrames = 0;
+    m_allocatedTones = 0;
+    m_availableTones = 0;
+    m_bsrpAirtime = Seconds(0);
+    m_dataAirtime = Seconds(0);
+    m_nLoadAwareChanges = 0;
+    m_loadAwareSaved = Seconds(0);
+    m_nDlMuPpdus = 0;
+    m_nAggregatedMpdus = 0;
+    m_nSecondaryPsdus = 0;
+    m_nSecondaryMpdus = 0;
+    m_aggregationTime = Seconds(0);
+    m_paddingSum = 0;
+    m_nBsrAnomalies = 0;
+    m_nSizedTfs = 0;
+    m_tfSizingTime = Seconds(0);
+    m_nTxDurationHits = 0;
+    m_nTxDurationMisses = 0;
+    for (auto& airtime : m_staTable.airtime)
+    {
+        airtime = {};
+    }
+}
+
+double
+RrMultiUserScheduler::GetCredits(const StaList& staList, uint32_t slot) const
+{
+    return std::min(m_staTable.credits[slot][staList.column] + staList.creditOffset,
+                    m_maxCredits.ToDouble(Time::US));
+}
+
+void
+RrMultiUserScheduler::SetLatencyTarget(const Mac48Address& address, Time target)
+{
+    NS_LOG_FUNCTION(this << address << target);
+    m_latencyTargets[address] = target;
+    if (auto slotIt = m_slotByAddress.find(address); slotIt != m_slotByAddress.end())
+    {
+        m_staTable.latencyTarget[slotIt->second] = target;
+    }
+}
+
+Time
+RrMultiUserScheduler::GetAirtime(const Mac48Address& address, AirtimeKind kind) const
+{
+    auto slotIt = m_slotByAddress.find(address);
+    return (slotIt != m_slotByAddress.end() ? m_staTable.airtime[slotIt->second][kind]
+                                            : Seconds(0));
+}
+
+void
+RrMultiUserScheduler::UpdateUlReport(uint32_t slot, double expected)
+{
+    auto& report = m_staTable.ulReports[slot];
+    if (report.expected > 0)
+    {
+        double ratio = std::min(report.delivered / report.expected, 1.0);
+        double weight = (report.nReports == 0 ? 1.0 : m_bsrEwmaWeight);
+        report.ratio = weight * ratio + (1 - weight) * report.ratio;
+        report.bytes = weight * report.delivered + (1 - weight) * report.bytes;
+        report.nReports++;
+        bool flagged = (report.nReports >= m_bsrMinReports && report.ratio < m_bsrThreshold);
+        if (flagged != report.flagged)
+        {
+            NS_LOG_DEBUG("Station " << m_staTable.address[slot]
+                                    << (flagged ? " flagged" : " unflagged")
+                                    << ", delivered/expected=" << report.ratio);
+            report.flagged = flagged;
+            m_nBsrAnomalies += (flagged ? 1 : 0);
+            m_bsrAnomalyTrace(m_staTable.address[slot], report.ratio, flagged);
+        }
+    }
+    report.expected = expected;
+    report.delivered = 0;
+}
+
+std::optional<uint32_t>
+RrMultiUserScheduler::GetClampedUlBuffer(uint32_t slot) const
+{
+    const auto& report = m_staTable.ulReports[slot];
+    if (m_bsrPolicy != BSR_CLAMP || !report.flagged)
+    {
+        return std::nullopt;
+    }
+    // never below UlPsduSize, so that the station can prove it is backlogged again
+    return std::max(static_cast<uint32_t>(report.bytes), m_ulPsduSize);
+}
+
+Time
+RrMultiUserScheduler::GetTbPpduDuration(uint32_t size, const WifiTxVector& txVector, uint16_t staId)
+{
+    auto band = m_apMac->GetWifiPhy(m_linkId)->GetPhyBand();
+    if (!m_txDurationCache)
+    {
+        return WifiPhy::CalculateTxDuration(size, txVector, band, staId);
+    }
+
+    // the other fields of the TXVECTOR and the RU index do not change the duration
+    const auto& userInfo = txVector.GetHeMuUserInfo(staId);
+    uint64_t key = size;
+    key |= static_cast<uint64_t>(userInfo.mcs & 0x0f) << 32;
+    key |= static_cast<uint64_t>(userInfo.nss & 0x0f) << 36;
+    key |= static_cast<uint64_t>(userInfo.ru.GetRuType()) << 40;
+    key |= static_cast<uint64_t>(txVector.GetGuardInterval() / 800) << 43;
+    key |= static_cast<uint64_t>(txVector.GetChannelWidth() / 20) << 46;
+    key |= static_cast<uint64_t>(band) << 51;
+    key |= static_cast<uint64_t>(txVector.GetPreambleType()) << 54;
+    key |= static_cast<uint64_t>(txVector.GetNssMax() & 0x0f) << 58;
+
+    if (auto it = m_txDurations.find(key); it != m_txDurations.end())
+    {
+        m_nTxDurationHits++;
+        return it->second;
+    }
+    if (m_txDurations.size() >= m_txDurationCacheSize)
+    {
+        NS_LOG_DEBUG("TX duration cache full, clearing " << m_txDurations.size() << " entries");
+        m_txDurations.clear();
+    }
+    m_nTxDurationMisses++;
+    Time duration = WifiPhy::CalculateTxDuration(size, txVector, band, staId);
+    m_txDurations.emplace(key, duration);
+    return duration;
+}
+
+void
+RrMultiUserScheduler::ChargeAirtime(uint32_t slot, AirtimeKind kind, Time airtime)
+{
+    m_staTable.airtime[slot][kind] += airtime;
+    m_airtimeTrace(m_staTable.address[slot], kind, airtime);
+}
+
+Time
+RrMultiUserScheduler::GetLatencyTarget(uint32_t slot) const
+{
+    return (m_staTable.latencyTarget[slot].IsStrictlyPositive() ? m_staTable.latencyTarget[slot]
+                                                                : m_latencyTarget);
+}
+
+void
+RrMultiUserScheduler::SortByDeadline(StaList& staList, AcIndex ac)
+{
+    NS_LOG_FUNCTION(this << ac);
+
+    // only the slots of the list are read by the sort, hence only they are reset
+    m_deadlines.resize(m_staTable.aid.size());
+    for (auto slot : staList.stas)
+    {
+        const auto& address = m_staTable.address[slot];
+        m_deadlines[slot] = Time::Max();
+        if (ac == AC_UNDEF)
+        {
+            auto& since = m_staTable.ulBacklogSince[slot];
+            if (m_apMac->GetMaxBufferStatus(address) == 0)
+            {
+                since = Time::Max();
+                continue;
+            }
+            if (since == Time::Max())
+            {
+                since = Simulator::Now();
+            }
+            m_deadlines[slot] = since + GetLatencyTarget(slot);
+        }
+        else
+        {
+            // the MPDUs expire MaxDelay after being enqueued
+            auto queue = m_apMac->GetQosTxop(ac)->GetWifiMacQueue();
+            for (uint8_t tid : {wifiAcList.at(ac).GetHighTid(), wifiAcList.at(ac).GetLowTid()})
+            {
+                if (auto mpdu = queue->PeekByTidAndAddress(tid, address))
+                {
+                    m_deadlines[slot] =
+                        std::min(m_deadlines[slot],
+                                 mpdu->GetExpiryTime() - queue->GetMaxDelay() +
+                                     GetLatencyTarget(slot));
+                }
+            }
+        }
+    }
+
+    staList.stas.sort([this, &staList](uint32_t a, uint32_t b) {
+        if (m_deadlines[a] != m_deadlines[b])
+        {
+            return m_deadlines[a] < m_deadlines[b];
+        }
+        return GetCredits(staList, a) > GetCredits(staList, b);
+    });
+}
+
+uint32_t
+RrMultiUserScheduler::GetStaStateBytes() const
+{
+    std::size_t nStas = m_staTable.aid.size() - m_staTable.freeSlots.size();
+    if (nStas == 0)
+    {
+        return 0;
+    }
+
+    std::size_t bytes = m_staTable.aid.capacity() * sizeof(uint16_t) +
+                        m_staTable.address.capacity() * sizeof(Mac48Address) +
+                        m_staTable.credits.capacity() * sizeof(m_staTable.credits[0]) +
+                        m_staTable.freeSlots.capacity() * sizeof(uint32_t) +
+                        m_staTable.latencyTarget.capacity() * sizeof(Time) +
+                        m_staTable.ulBacklogSince.capacity() * sizeof(Time) +
+                        m_staTable.airtime.capacity() * sizeof(m_staTable.airtime[0]) +
+                        m_staTable.ulReports.capacity() * sizeof(UlReportStats) +
+                        m_slotByAid.capacity() * sizeof(uint32_t) +
+                        m_deadlines.capacity() * sizeof(Time) +
+                        m_slotByAddress.bucket_count() * sizeof(void*);
+    // a hash node stores the link to the next node besides the address and the slot
+    bytes += m_slotByAddress.size() * (sizeof(void*) + sizeof(Mac48Address) + sizeof(uint32_t));
+    // a list node stores the links to the previous and next nodes besides the slot
+    std::size_t nodeBytes = 2 * sizeof(void*) + sizeof(uint32_t);
+    for (const auto& staList : m_staListDl)
+    {
+        bytes += staList.second.stas.size() * nodeBytes;
+    }
+    bytes += m_staListUl.stas.size() * nodeBytes;
+    return bytes / nStas;
 }
 
 void
-RrMultiUserScheduler::UpdateCredits(std::list<MasterInfo>& staList,
-                                    Time txDuration,
-                                    const WifiTxVector& txVector)
+RrMultiUserScheduler::UpdateCredits(StaList& staList, Time txDuration, const WifiTxVector& txVector)
 {
     NS_LOG_FUNCTION(this << txDuration.As(Time::US) << txVector);
 
@@ -856,33 +1958,66 @@ RrMultiUserScheduler::UpdateCredits(std::list<MasterInfo>& staList,
 
     // The amount of credits received by each station equals the TX duration (in
     // microseconds) divided by the number of stations.
-    double creditsPerSta = txDuration.ToDouble(Time::US) / staList.size();
+    double creditsPerSta = txDuration.ToDouble(Time::US) / staList.stas.size();
     // Transmitting stations have to pay a number of credits equal to the TX duration
     // (in microseconds) times the allocated bandwidth share.
-    double debitsPerMhz =
-        txDuration.ToDouble(Time::US) /
+    uint16_t totalMhz =
         std::accumulate(ruMap.begin(), ruMap.end(), 0, [](uint16_t sum, auto pair) {
             return sum + pair.second * HeRu::GetBandwidth(pair.first);
         });
+    double debitsPerMhz = txDuration.ToDouble(Time::US) / totalMhz;
 
-    // assign credits to all stations
-    for (auto& sta : staList)
-    {
-        sta.credits += creditsPerSta;
-        sta.credits = std::min(sta.credits, m_maxCredits.ToDouble(Time::US));
-    }
+    // assign credits to all stations. This is done lazily through the list offset:
+    // min(credits + offset, maxCredits) is monotonic in the offset, hence the order
+    // of the stations is not affected
+    staList.creditOffset += creditsPerSta;
 
-    // subtract debits to the selected stations
+    // subtract debits to the selected stations, which are moved to a separate list
+    // (splicing keeps the iterators stored in m_candidates valid)
+    std::list<uint32_t> debited;
     for (auto& candidate : m_candidates)
     {
-        auto mapIt = txVector.GetHeMuUserInfoMap().find(candidate.first->aid);
+        auto mapIt = txVector.GetHeMuUserInfoMap().find(m_staTable.aid[*candidate.first]);
         NS_ASSERT(mapIt != txVector.GetHeMuUserInfoMap().end());
 
-        candidate.first->credits -= debitsPerMhz * HeRu::GetBandwidth(mapIt->second.ru.GetRuType());
+        auto ruMhz = HeRu::GetBandwidth(mapIt->second.ru.GetRuType());
+        double debits = debitsPerMhz * ruMhz;
+        if (&staList == &m_staListUl && m_bsrPolicy == BSR_DEPRIORITIZE &&
+            m_staTable.ulReports[*candidate.first].flagged)
+        {
+            debits *= m_bsrPenalty;
+        }
+        double credits = GetCredits(staList, *candidate.first) - debits;
+        m_staTable.credits[*candidate.first][staList.column] = credits - staList.creditOffset;
+        // the debit is the airtime share of the station
+        ChargeAirtime(*candidate.first,
+                      (&staList == &m_staListUl ? AIRTIME_UL_TB : AIRTIME_DL_MU),
+                      txDuration * ruMhz / totalMhz);
+        debited.splice(debited.end(), staList.stas, candidate.first);
+    }
+
+    if (&staList == &m_staListUl)
+    {
+        // the buffer status reported by the stations after being served is fresh
+        for (auto slot : debited)
+        {
+            m_staTable.ulBacklogSince[slot] = Time::Max();
+        }
+    }
+    if (m_latencyAware)
+    {
+        // the list is sorted by deadline before every selection
+        staList.stas.splice(staList.stas.end(), debited);
+        return;
     }
 
-    // sort the list in decreasing order of credits
-    staList.sort([](const MasterInfo& a, const MasterInfo& b) { return a.credits > b.credits; });
+    // the other stations are still sorted in decreasing order of credits, hence only
+    // the debited stations need to be sorted before merging them back
+    auto byCredits = [this, &staList](uint32_t a, uint32_t b) {
+        return GetCredits(staList, a) > GetCredits(staList, b);
+    };
+    debited.sort(byCredits);
+    staList.stas.merge(debited, byCredits);
 }
 
 MultiUserScheduler::DlMuInfo
@@ -918,15 +2053,42 @@ RrMultiUserScheduler::ComputeDlMuInfo()
     }
 
     // We have to complete the PSDUs to send
-    Ptr<WifiMacQueue> queue;
-
+    auto start = std::chrono::steady_clock::now();
+    std::vector<const CandidateInfo*> aggregationOrder;
+    aggregationOrder.reserve(m_candidates.size());
     for (const auto& candidate : m_candidates)
     {
+        aggregationOrder.push_back(&candidate);
+    }
+    Time aggregationTime = m_availableTime;
+    if (m_balancedDlAmpdu || m_equalizeDlMuPpdu)
+    {
+        auto psduDurations = GetDlPsduDurations(dlMuInfo.txParams.m_txVector);
+        if (m_balancedDlAmpdu)
+        {
+            // the longest PSDU is aggregated first and sets the duration of the DL MU
+            // PPDU, the others are then only filled up to it (see below)
+            std::stable_sort(aggregationOrder.begin(),
+                             aggregationOrder.end(),
+                             [&psduDurations](const CandidateInfo* a, const CandidateInfo* b) {
+                                 return psduDurations[*a->first] > psduDurations[*b->first];
+                             });
+        }
+        if (m_equalizeDlMuPpdu)
+        {
+            aggregationTime = GetEqualizedDlMuPpduTime(dlMuInfo.txParams, psduDurations);
+        }
+    }
+
+    for (const auto* candidatePtr : aggregationOrder)
+    {
+        const auto& candidate = *candidatePtr;
         // Let us try first A-MSDU aggregation if possible
         mpdu = candidate.second;
         NS_ASSERT(mpdu);
         uint8_t tid = mpdu->GetHeader().GetQosTid();
-        NS_ASSERT_MSG(mpdu->GetOriginal()->GetHeader().GetAddr1() == candidate.first->address,
+        NS_ASSERT_MSG(mpdu->GetOriginal()->GetHeader().GetAddr1() ==
+                          m_staTable.address[*candidate.first],
                       "RA of the stored MPDU must match the stored address");
 
         NS_ASSERT(mpdu->IsQueued());
@@ -938,7 +2100,7 @@ RrMultiUserScheduler::ComputeDlMuInfo()
             // A-MSDU aggregation
             item = GetHeFem(m_linkId)->GetMsduAggregator()->GetNextAmsdu(mpdu,
                                                                          dlMuInfo.txParams,
-                                                                         m_availableTime);
+                                                                         aggregationTime);
 
             if (!item)
             {
@@ -952,25 +2114,53 @@ RrMultiUserScheduler::ComputeDlMuInfo()
         std::vector<Ptr<WifiMpdu>> mpduList =
             GetHeFem(m_linkId)->GetMpduAggregator()->GetNextAmpdu(item,
                                                                   dlMuInfo.txParams,
-                                                                  m_availableTime);
+                                                                  aggregationTime);
+        m_nAggregatedMpdus += std::max<std::size_t>(mpduList.size(), 1);
 
         if (mpduList.size() > 1)
         {
             // A-MPDU aggregation succeeded, update psduMap
-            dlMuInfo.psduMap[candidate.first->aid] = Create<WifiPsdu>(std::move(mpduList));
+            dlMuInfo.psduMap[m_staTable.aid[*candidate.first]] =
+                Create<WifiPsdu>(std::move(mpduList));
         }
         else
         {
-            dlMuInfo.psduMap[candidate.first->aid] = Create<WifiPsdu>(item, true);
+            dlMuInfo.psduMap[m_staTable.aid[*candidate.first]] = Create<WifiPsdu>(item, true);
+        }
+
+        if (m_balancedDlAmpdu && candidatePtr == aggregationOrder.front())
+        {
+            // the aggregators limit the duration of the whole MU PPDU, hence the other
+            // PSDUs would otherwise be aggregated up to the available time as well
+            const auto& txParams = dlMuInfo.txParams;
+            NS_ASSERT(txParams.m_protection && txParams.m_acknowledgment);
+            if (txParams.m_protection->protectionTime != Time::Min() &&
+                txParams.m_acknowledgment->acknowledgmentTime != Time::Min())
+            {
+                Time ppduTime = txParams.m_protection->protectionTime + txParams.m_txDuration +
+                                txParams.m_acknowledgment->acknowledgmentTime;
+                aggregationTime =
+                    (aggregationTime == Time::Min() ? ppduTime : Min(aggregationTime, ppduTime));
+                NS_LOG_DEBUG("PSDUs aggregated within " << aggregationTime.As(Time::US)
+                                                        << " after the longest one");
+            }
         }
     }
+    m_aggregationTime += NanoSeconds(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::steady_clock::now() - start)
+                                         .count());
+    m_nDlMuPpdus++;
+    TracePadding(dlMuInfo);
+    CountSecondaryMpdus(dlMuInfo);
 
     AcIndex primaryAc = m_edca->GetAccessCategory();
     UpdateCredits(m_staListDl[primaryAc],
                   dlMuInfo.txParams.m_txDuration,
                   dlMuInfo.txParams.m_txVector);
+    m_dataAirtime += dlMuInfo.txParams.m_txDuration;
 
-    NS_LOG_DEBUG("Next station to serve has AID=" << m_staListDl[primaryAc].front().aid);
+    NS_LOG_DEBUG("Next station to serve has AID="
+                 << m_staTable.aid[m_staListDl[primaryAc].stas.front()]);
 
     return dlMuInfo;
 }
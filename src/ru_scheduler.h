@@ -1,7 +1,11 @@
 #ifndef RU_SCHEDULER_H
 #define RU_SCHEDULER_H
 
+#include <array>
 #include <list>
+#include <optional>
+#include <unordered_map>
+#include <vector>
 
 namespace ns3
 {
@@ -21,6 +25,115 @@ class RrMultiUserScheduler:
     RrMultiUserScheduler();
     ~RrMultiUserScheduler() override;
 
+    /**
+     * \return the bytes of scheduler state per associated station
+     */
+    uint32_t GetStaStateBytes() const;
+
+    /**
+     * Set the latency target of the given station, overriding the LatencyTarget
+     * attribute. It can be set before the station associates.
+     *
+     * \param address the MAC address (MLD address for non-AP MLDs) of the station
+     * \param target the latency target
+     */
+    void SetLatencyTarget(const Mac48Address& address, Time target);
+
+    /**
+     * Kinds of airtime charged to the stations
+     */
+    enum AirtimeKind : uint8_t
+    {
+        AIRTIME_DL_MU = 0, //!< share of the DL MU PPDUs
+        AIRTIME_UL_TB,     //!< share of the solicited TB PPDUs
+        AIRTIME_BSRP,      //!< share of the BSRP TF exchanges
+        AIRTIME_SU,        //!< DL SU PPDUs (e.g., fallbacks to SU_TX)
+        N_AIRTIME_KINDS
+    };
+
+    /**
+     * Policies applied to the stations whose buffer status reports are persistently
+     * inflated, i.e., that deliver much less than they report in the TB PPDUs they are
+     * solicited for
+     */
+    enum BsrAnomalyPolicy : uint8_t
+    {
+        BSR_OFF = 0,     //!< do not track the buffer status reports
+        BSR_DETECT,      //!< only detect the offenders
+        BSR_CLAMP,       //!< replace the reports of the offenders by what they deliver
+        BSR_DEPRIORITIZE //!< multiply the UL debits of the offenders by BsrAnomalyPenalty
+    };
+
+    /**
+     * \param address the MAC address (MLD address for non-AP MLDs) of a station
+     * \param kind the kind of airtime
+     * \return the airtime of the given kind charged to the station since the counters
+     *         were last reset (0 if the station is not associated)
+     */
+    Time GetAirtime(const Mac48Address& address, AirtimeKind kind) const;
+
+    /**
+     * \return the ratio of the tones allocated to stations to the tones of the MU PPDUs
+     *         (0 if no MU PPDU was scheduled)
+     */
+    double GetRuUtilization() const;
+    /**
+     * \return the ratio of the airtime of BSRP exchanges to the airtime of data MU PPDUs
+     *         (0 if no data MU PPDU was scheduled)
+     */
+    double GetBsrpToDataRatio() const;
+    /**
+     * \return the mean fraction of the RU airtime of the DL MU PPDUs carrying padding
+     */
+    double GetPaddingFraction() const;
+    /**
+     * Reset the schedule-efficiency counters. This happens automatically at
+     * CountersStartTime, if set.
+     */
+    void ResetCounters();
+
+    /**
+     * TracedCallback signature for the outcome of the selection of the stations to
+     * solicit in an UL MU transmission.
+     *
+     * \param total the number of stations in the UL list
+     * \param unsolicited the number of stations skipped because they cannot be solicited
+     * \param nRus the number of equal-sized RUs the selection was sized for
+     * \param candidates the number of candidate stations
+     * \param scheduled the number of candidate stations that are allocated an RU
+     */
+    typedef void (*ScheduleStatsCallback)(uint32_t total,
+                                          uint32_t unsolicited,
+                                          uint32_t nRus,
+                                          uint32_t candidates,
+                                          uint32_t scheduled);
+
+    /**
+     * TracedCallback signature for the padding of a DL MU PPDU.
+     *
+     * \param padding the fraction of the RU airtime of the PPDU carrying padding
+     */
+    typedef void (*PaddingCallback)(double padding);
+
+    /**
+     * TracedCallback signature for the airtime charged to a station.
+     *
+     * \param address the MAC address (MLD address for non-AP MLDs) of the station
+     * \param kind the kind of airtime (an AirtimeKind)
+     * \param airtime the airtime charged to the station
+     */
+    typedef void (*AirtimeCallback)(Mac48Address address, uint8_t kind, Time airtime);
+
+    /**
+     * TracedCallback signature for a station being flagged or unflagged as sending
+     * inflated buffer status reports.
+     *
+     * \param address the MAC address (MLD address for non-AP MLDs) of the station
+     * \param ratio the moving average of the delivered to expected bytes
+     * \param flagged whether the station is flagged
+     */
+    typedef void (*BsrAnomalyCallback)(Mac48Address address, double ratio, bool flagged);
+
   protected:
     void DoDispose() override;
     void DoInitialize() override;
@@ -63,7 +176,8 @@ class RrMultiUserScheduler:
      * BlockAck agreement with the AP and for which the given predicate returns true.
      *
      * \tparam Func \deduced the type of the given predicate
-     * \param canBeSolicited a predicate returning false for stations that shall not be solicited
+     * \param canBeSolicited a predicate taking the AID and the MAC address of a station
+     *        and returning false for stations that shall not be solicited
      * \return a TXVECTOR that can be used to construct a Trigger Frame to solicit
      *         transmissions from suitable stations
      */
@@ -84,15 +198,93 @@ class RrMultiUserScheduler:
      * \param address the MAC address of the station
      */
     void NotifyStationDeassociated(uint16_t aid, Mac48Address address);
+    /**
+     * Charge the airtime of the SU PPDUs carrying QoS data sent by the AP to their
+     * receiver.
+     *
+     * \param linkId the ID of the link the PPDU is sent on
+     * \param psduMap the PSDU map of the PPDU
+     * \param txVector the TXVECTOR of the PPDU
+     * \param txPowerW the TX power in Watts
+     */
+    void NotifyPsduTxBegin(uint8_t linkId,
+                           WifiConstPsduMap psduMap,
+                           WifiTxVector txVector,
+                           double txPowerW);
+    /**
+     * Count the bytes of the QoS data frames received in TB PPDUs towards the buffer
+     * status report of their transmitter.
+     *
+     * \param linkId the ID of the link the MPDU is received on
+     * \param packet the received MPDU
+     * \param channelFreqMhz the frequency of the channel
+     * \param txVector the TXVECTOR of the PPDU
+     * \param aMpdu the A-MPDU information
+     * \param signalNoise the signal and noise powers
+     * \param staId the STA-ID of the transmitter
+     */
+    void NotifyMonitorSnifferRx(uint8_t linkId,
+                                Ptr<const Packet> packet,
+                                uint16_t channelFreqMhz,
+                                WifiTxVector txVector,
+                                MpduInfo aMpdu,
+                                SignalNoiseDbm signalNoise,
+                                uint16_t staId);
+
+    /// Number of lists of stations (one per AC for DL, plus one for UL)
+    static constexpr std::size_t N_STA_LISTS = 5;
+    /// Value of m_slotByAid for AIDs without a slot
+    static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+    /**
+     * Streaming statistics of the buffer status reports of a station. A report is the
+     * buffer status used to solicit the station in a Basic TF, and it is closed when
+     * the station is solicited again.
+     */
+    struct UlReportStats
+    {
+        double expected{0};   //!< bytes expected in the pending TB PPDU (0 if none)
+        double delivered{0};  //!< bytes received since the pending report
+        double ratio{1};      //!< moving average of delivered over expected bytes
+        double bytes{0};      //!< moving average of the bytes delivered per report
+        uint32_t nReports{0}; //!< number of closed reports
+        bool flagged{false};  //!< whether the reports are persistently inflated
+    };
 
     /**
-     * Information used to sort stations
+     * Per-station state, stored as a struct of arrays indexed by the slot a station is
+     * given upon association (slots of deassociated stations are reused). The lists of
+     * stations only store slots, hence the AID and the MAC address are stored once
+     * rather than once per list.
      */
-    struct MasterInfo
+    struct StaTable
     {
-        uint16_t aid;         //!< station's AID
-        Mac48Address address; //!< station's MAC Address
-        double credits;       //!< credits accumulated by the station
+        std::vector<uint16_t> aid;         //!< station's AID
+        std::vector<Mac48Address> address; //!< station's MAC Address
+        std::vector<std::array<double, N_STA_LISTS>> credits; //!< per-list credits accumulated
+                                                              //!< by the station, net of the
+                                                              //!< list offset
+        std::vector<uint32_t> freeSlots;                      //!< slots that can be reused
+        std::vector<Time> latencyTarget;   //!< station's latency target (0 for the default)
+        std::vector<Time> ulBacklogSince;  //!< time the station was first seen reporting a
+                                           //!< non-null buffer since it was last served
+                                           //!< (Time::Max() if none)
+        std::vector<std::array<Time, N_AIRTIME_KINDS>> airtime; //!< airtime charged to the
+                                                                //!< station, per kind
+        std::vector<UlReportStats> ulReports; //!< statistics of the buffer status reports
+    };
+
+    /**
+     * A list of stations sorted in decreasing order of credits. Credits assigned to all
+     * the stations of the list are accumulated in a per-list offset rather than being
+     * added to every station, so that the actual credits of a station are
+     * min(credits + offset, m_maxCredits).
+     */
+    struct StaList
+    {
+        std::list<uint32_t> stas; //!< slots of the stations (next to serve first)
+        double creditOffset{0};   //!< credits assigned to all the stations of the list
+        std::size_t column{0};    //!< index of the credits of this list in the station table
     };
 
     /**
@@ -107,6 +299,78 @@ class RrMultiUserScheduler:
      * \param txVector the given TXVECTOR
      */
     void FinalizeTxVector(WifiTxVector& txVector);
+    /**
+     * Update the RU utilization counters with the given finalized MU TXVECTOR.
+     *
+     * \param txVector the finalized TXVECTOR
+     */
+    void CountAllocatedTones(const WifiTxVector& txVector);
+    /**
+     * \return the maximum number of stations that can be granted an RU in the current
+     *         MU transmission (NStations, or derived from the allowed width if it is 0)
+     */
+    std::size_t GetMaxNStations() const;
+    /**
+     * \param nStas the number of stations that can be granted an RU
+     * \param nRus the number of equal-sized RUs allocated to them
+     * \param nCentral26TonesRus the number of central 26-tone RUs left idle by the
+     *                           equal-sized RUs
+     * \return the number of central 26-tone RUs to allocate
+     */
+    std::size_t GetNCentral26TonesRus(std::size_t nStas,
+                                      std::size_t nRus,
+                                      std::size_t nCentral26TonesRus) const;
+    /**
+     * Select the RU size that maximizes the bytes delivered per unit of airtime, given
+     * the demand of the candidate stations (the DL queue sizes or the UL buffer status
+     * reports), their MCS and the overhead of a MU transmission. Larger RUs serve fewer
+     * stations, the remaining ones being left to the next transmissions.
+     *
+     * \param txVector the TXVECTOR holding the MCS and NSS of the candidate stations
+     * \param ruType the RU size based on the number of candidate stations
+     * \param nRus the number of equal-sized RUs, updated to the selected RU size
+     * \param nCentral26TonesRus the number of central 26-tone RUs, updated to the
+     *                           selected RU size
+     * \return the selected RU size
+     */
+    HeRu::RuType SelectRuTypeByLoad(const WifiTxVector& txVector,
+                                    HeRu::RuType ruType,
+                                    std::size_t& nRus,
+                                    std::size_t& nCentral26TonesRus);
+    /**
+     * \param txVector the finalized TXVECTOR of a DL MU PPDU
+     * \return the duration of the PSDU that would carry the whole queue of each
+     *         candidate station, in seconds, indexed by the slot of the station
+     */
+    std::vector<double> GetDlPsduDurations(const WifiTxVector& txVector) const;
+    /**
+     * \param txParams the TX parameters of a DL MU PPDU holding the first MPDU of
+     *                 every candidate station
+     * \param psduDurations the durations returned by GetDlPsduDurations
+     * \return the available time to aggregate against so that the PSDUs have a
+     *         common duration
+     */
+    Time GetEqualizedDlMuPpduTime(const WifiTxParameters& txParams,
+                                  const std::vector<double>& psduDurations) const;
+    /**
+     * Fire the DlPadding trace for the given DL MU PPDU.
+     *
+     * \param dlMuInfo the information of the DL MU PPDU
+     */
+    void TracePadding(const DlMuInfo& dlMuInfo);
+    /**
+     * Count the PSDUs of the given DL MU PPDU other than the longest one, and their MPDUs.
+     *
+     * \param dlMuInfo the information of the DL MU PPDU
+     */
+    void CountSecondaryMpdus(const DlMuInfo& dlMuInfo);
+    /**
+     * Abort if the RUs of the given finalized MU TXVECTOR overlap or do not fit the
+     * allowed width.
+     *
+     * \param txVector the finalized TXVECTOR
+     */
+    void ValidateRuAllocation(const WifiTxVector& txVector) const;
     /**
      * Update credits of the stations in the given list considering that a PPDU having
      * the given duration is being transmitted or solicited by using the given TXVECTOR.
@@ -115,30 +379,154 @@ class RrMultiUserScheduler:
      * \param txDuration the TX duration of the PPDU being transmitted or solicited
      * \param txVector the TXVECTOR for the PPDU being transmitted or solicited
      */
-    void UpdateCredits(std::list<MasterInfo>& staList,
-                       Time txDuration,
-                       const WifiTxVector& txVector);
+    void UpdateCredits(StaList& staList, Time txDuration, const WifiTxVector& txVector);
+    /**
+     * Add the given airtime to the ledger of a station and fire the AirtimeCharged trace.
+     *
+     * \param slot the slot of the station
+     * \param kind the kind of airtime
+     * \param airtime the airtime charged to the station
+     */
+    void ChargeAirtime(uint32_t slot, AirtimeKind kind, Time airtime);
+    /**
+     * Close the pending buffer status report of a station, if any, updating its moving
+     * averages and its flag in constant time, and open a new one.
+     *
+     * \param slot the slot of the station
+     * \param expected the bytes expected in the TB PPDU the station is solicited for
+     *                 (0 if the buffer status is unknown)
+     */
+    void UpdateUlReport(uint32_t slot, double expected);
+    /**
+     * \param slot the slot of a station
+     * \return the bytes the buffered data of the station is clamped to, if the station
+     *         is flagged and the policy is BSR_CLAMP
+     */
+    std::optional<uint32_t> GetClampedUlBuffer(uint32_t slot) const;
+    /**
+     * Get the duration of the HE TB PPDU carrying a PSDU of the given size sent by the
+     * given station, memoized if TxDurationCache is enabled. The duration only depends
+     * on the PSDU size, on the MCS, NSS and RU of the station and on the GI, the channel
+     * width, the preamble and the max NSS of the TXVECTOR, which form the key.
+     *
+     * \param size the size of the PSDU in bytes
+     * \param txVector the TXVECTOR of the UL MU transmission
+     * \param staId the AID of the station
+     * \return the duration of the HE TB PPDU
+     */
+    Time GetTbPpduDuration(uint32_t size, const WifiTxVector& txVector, uint16_t staId);
+
+    /**
+     * \param staList the list the station belongs to
+     * \param slot the slot of the station
+     * \return the actual amount of credits of the station
+     */
+    double GetCredits(const StaList& staList, uint32_t slot) const;
+
+    /**
+     * Insert a newly associated station with zero credits into the given list,
+     * keeping the list sorted.
+     *
+     * \param staList the list of stations
+     * \param slot the slot of the station to add
+     */
+    void AddStation(StaList& staList, uint32_t slot);
+
+    /**
+     * \param slot the slot of a station
+     * \return the latency target of the station
+     */
+    Time GetLatencyTarget(uint32_t slot) const;
+
+    /**
+     * Sort the given list by increasing deadline, i.e., the arrival of the head-of-line
+     * data plus the latency target. The arrival is the enqueue time of the oldest
+     * frame of the AC (DL) or the time a non-null buffer status was first seen (UL).
+     * Stations without data come last and ties are broken by decreasing credits.
+     *
+     * \param staList the list of stations
+     * \param ac the AC of the DL list, or AC_UNDEF for the UL list
+     */
+    void SortByDeadline(StaList& staList, AcIndex ac);
 
     /**
      * Information stored for candidate stations
      */
-    typedef std::pair<std::list<MasterInfo>::iterator, Ptr<WifiMpdu>> CandidateInfo;
+    typedef std::pair<std::list<uint32_t>::iterator, Ptr<WifiMpdu>> CandidateInfo;
 
-    uint8_t m_nStations;         //!< Number of stations/slots to fill
+    uint8_t m_nStations;         //!< Number of stations/slots to fill (0 for all the 26-tone RUs)
     bool m_enableTxopSharing;    //!< allow A-MPDUs of different TIDs in a DL MU PPDU
     bool m_forceDlOfdma;         //!< return DL_OFDMA even if no DL MU PPDU was built
     bool m_enableUlOfdma;        //!< enable the scheduler to also return UL_OFDMA
     bool m_enableBsrp;           //!< send a BSRP before an UL MU transmission
     bool m_useCentral26TonesRus; //!< whether to allocate central 26-tone RUs
+    bool m_validateRus;          //!< whether to check the RUs of every MU PPDU
+    bool m_loadAwareRus;         //!< whether to select the RU size based on the demand
+    Time m_loadAwareOverhead;    //!< airtime of a MU transmission besides the data
+    bool m_balancedDlAmpdu;      //!< whether to aggregate the longest PSDU first
+    bool m_equalizeDlMuPpdu;     //!< whether to size the PSDUs to a common duration
+    bool m_latencyAware;         //!< whether to serve the earliest deadlines first
+    Time m_latencyTarget;        //!< default latency target of the stations
+    std::map<Mac48Address, Time> m_latencyTargets; //!< latency targets set per station
+    BsrAnomalyPolicy m_bsrPolicy; //!< policy applied to the inflated buffer status reports
+    double m_bsrEwmaWeight;       //!< weight of a new report in the moving averages
+    double m_bsrThreshold;        //!< ratio of delivered to expected bytes below which a
+                                  //!< station is flagged
+    uint32_t m_bsrMinReports;     //!< reports needed before flagging a station
+    double m_bsrPenalty;          //!< factor of the UL debits of the flagged stations
     uint32_t m_ulPsduSize;       //!< the size in byte of the solicited PSDU
-    std::map<AcIndex, std::list<MasterInfo>>
-        m_staListDl;                       //!< Per-AC list of stations (next to serve for DL first)
-    std::list<MasterInfo> m_staListUl;     //!< List of stations to serve for UL
+    bool m_txDurationCache;       //!< whether to memoize the durations of the HE TB PPDUs
+    uint32_t m_txDurationCacheSize; //!< max number of memoized durations
+    std::unordered_map<uint64_t, Time> m_txDurations; //!< memoized durations of the HE TB PPDUs
+    std::map<AcIndex, StaList> m_staListDl; //!< Per-AC list of stations (next to serve for DL first)
+    StaList m_staListUl;                   //!< List of stations to serve for UL
+    StaTable m_staTable;                   //!< state of the stations in the lists
+    std::vector<uint32_t> m_slotByAid;     //!< slot of each AID (NO_SLOT if none)
+    std::unordered_map<Mac48Address, uint32_t, WifiAddressHash>
+        m_slotByAddress; //!< slot of each associated link address and MLD address
+    std::vector<Time> m_deadlines;         //!< per-slot deadlines of SortByDeadline
     std::list<CandidateInfo> m_candidates; //!< Candidate stations for MU TX
     Time m_maxCredits;                     //!< Max amount of credits a station can have
     CtrlTriggerHeader m_trigger;           //!< Trigger Frame to send
     WifiMacHeader m_triggerMacHdr;         //!< MAC header for Trigger Frame
     WifiTxParameters m_txParams;           //!< TX parameters
+
+    Time m_countersStart;          //!< time the schedule-efficiency counters are reset at
+    EventId m_resetCountersEvent;  //!< event resetting the counters
+    std::vector<Ptr<WifiPhy>> m_phys; //!< PHYs of the links, whose traces are connected
+    uint64_t m_nMuDecisions{0};    //!< MU TXVECTORs finalized (DL and UL)
+    uint64_t m_nTrimmedCandidates{0}; //!< candidates dropped by FinalizeTxVector
+    uint64_t m_nUnsolicitedSkips{0};  //!< stations skipped because they cannot be solicited
+    uint64_t m_nNoTxTxopTooShort{0};  //!< NO_TX because the TXOP cannot fit the TF exchange
+    uint64_t m_nNoTxUlTooShort{0};    //!< NO_TX because the time left for the TB PPDU is too
+                                      //!< short to carry UlPsduSize bytes
+    uint64_t m_nNoTxNoDlFrames{0};    //!< NO_TX because no DL frame could be added (ForceDlOfdma)
+    uint64_t m_allocatedTones{0};     //!< tones allocated to stations in MU PPDUs
+    uint64_t m_availableTones{0};     //!< tones of the MU PPDUs
+    Time m_bsrpAirtime;               //!< airtime of the BSRP TFs and of the solicited QoS Nulls
+    Time m_dataAirtime;               //!< airtime of the DL MU PPDUs and of the solicited TB PPDUs
+    uint64_t m_nLoadAwareChanges{0};  //!< MU PPDUs whose RU size was changed by LoadAwareRus
+    Time m_loadAwareSaved;            //!< airtime saved by LoadAwareRus
+    uint64_t m_nDlMuPpdus{0};         //!< DL MU PPDUs built
+    uint64_t m_nAggregatedMpdus{0};   //!< MPDUs aggregated in DL MU PPDUs
+    uint64_t m_nSecondaryPsdus{0};    //!< PSDUs of DL MU PPDUs other than the longest one
+    uint64_t m_nSecondaryMpdus{0};    //!< MPDUs of these PSDUs
+    Time m_aggregationTime;           //!< wall-clock time spent aggregating DL MU PPDUs
+    double m_paddingSum{0};           //!< sum of the padding fractions of the DL MU PPDUs
+    uint64_t m_nBsrAnomalies{0};      //!< stations flagged as sending inflated reports
+    uint64_t m_nSizedTfs{0};          //!< BSRP and Basic TFs whose UL length was computed
+    Time m_tfSizingTime;              //!< wall-clock time spent computing the TB PPDU
+                                      //!< durations of the TFs
+    uint64_t m_nTxDurationHits{0};    //!< TB PPDU durations read from the cache
+    uint64_t m_nTxDurationMisses{0};  //!< TB PPDU durations computed by the PHY
+
+    /// outcome of the selection of the stations to solicit in an UL MU transmission
+    TracedCallback<uint32_t, uint32_t, uint32_t, uint32_t, uint32_t> m_scheduleStatsTrace;
+    TracedCallback<double> m_paddingTrace; //!< padding fraction of the DL MU PPDUs
+    /// airtime charged to a station
+    TracedCallback<Mac48Address, uint8_t, Time> m_airtimeTrace;
+    /// station flagged or unflagged as sending inflated buffer status reports
+    TracedCallback<Mac48Address, double, bool> m_bsrAnomalyTrace;
 };
 
 }
@@ -3,6 +3,7 @@
 #include "ns3/config.h"
 #include "ns3/double.h"
 #include "ns3/enum.h"
+#include "ns3/global-value.h"
 #include "ns3/he-phy.h"
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-address-helper.h"
@@ -13,6 +14,8 @@
 #include "ns3/on-off-helper.h"
 #include "ns3/packet-sink-helper.h"
 #include "ns3/packet-sink.h"
+#include "ns3/position-allocator.h"
+#include "ns3/propagation-delay-model.h"
 #include "ns3/rng-seed-manager.h"
 #include "ns3/spectrum-wifi-helper.h"
 #include "ns3/ssid.h"
@@ -25,17 +28,42 @@
 #include "ns3/trace-helper.h"
 #include "ns3/wifi-module.h" 
 
+#include "abstract_phy.h"
+#include "async_log.h"
+#include "cached_loss_model.h"
+#include "convergence.h"
+#include "event_profiler.h"
+#include "latency_stats.h"
+#include "misbehavior.h"
+#include "replication.h"
+#include "result_cache.h"
+#include "ru_scheduler.h"
+#include "scenario.h"
+#include "tput_sampler.h"
+#include "traffic_models.h"
+
+#include <array>
+#include <chrono>
+#include <cmath>
 #include <functional>
 #include <numeric>
 #include <fstream>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
 
 
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE("wifi6-network");
 
-int
-main(int argc, char* argv[])
+/**
+ * Knobs of the experiment, set from the command line
+ */
+struct SawConfig
 {
     bool enableUlOfdma{true};
     bool udp{false};
@@ -46,128 +74,1681 @@ main(int argc, char* argv[])
     double distance{1.0};      //! Fixed in meters
     double frequency{5};       // whether 2.4, 5 or 6 GHz
     std::size_t clients{3};
-    std::string dlAckSeqType = (enableUlOfdma)? 
-        "MU-BAR" : "NO-OFDMA"; // Shouldn't matter to the attack, but mu-bar seems to be the best.
+    std::string dlAckSeqType{"MU-BAR"}; // Shouldn't matter to the attack, but mu-bar seems to be the best.
     bool enableBsrp{true};
-    bool useCentral26TonesRus{false}; //! Having problems when enabling central subcarriers.
+    bool useCentral26TonesRus{false}; // also allocate the central 26-tone RUs
+    uint32_t muUsers{0};              // max stations per MU PPDU (0: derived from the width)
     int mcs{2}; // -1 indicates an unset value
     int totalChannelWidth = 20;
     int gi_nanosec = 3200;
-    uint32_t payloadSize = (enableUlOfdma)? 700 :
-        700; // must fit in the max TX duration when transmitting at MCS 0 over an RU of 26 tones
+    uint32_t payloadSize = 700; // must fit in the max TX duration when transmitting at MCS 0 over an RU of 26 tones
     std::string phyModel{"Yans"};
     double minExpectedThroughput{0};
     double maxExpectedThroughput{0};
     Time accessReqInterval{0};
+    Time sampleInterval{MilliSeconds(100)}; // 0 disables the periodic sampler
+    double warmup{1.0};                     // seconds
+    double ciTarget{0};                     // relative CI half-width, 0 disables early termination
+    uint32_t ciBatchWindows{10};
+    uint32_t ciMinBatches{5};
+    uint32_t convergenceWindows{0}; // 0 disables the convergence controller
+    double convergenceThreshold{0.01};
+    bool convergencePerClient{true};
+    uint32_t runNumber{1};    // RNG run of the first replication
+    uint32_t replications{1}; // independent RNG runs of each sweep point
+    uint32_t jobs{0};         // concurrent worker processes, 0 means one per core
+    uint32_t nAps{1};           // number of BSSs, each with `clients` stations
+    std::string layout{"line"}; // spatial distribution of the stations around their AP
+    double apSpacing{30};       // distance in meters between neighboring APs
+    bool enablePcap{true};      // capture the traffic of the first AP in ap.pcap
+    bool memProfile{false};     // break the memory per station down by component
+    std::string traffic;        // per-client traffic models, empty for the original setup
+    uint16_t basePort{50000};   // the sink of client i listens on basePort + i
+    double clientStart{-1};     // seconds, -1 keeps the defaults (1 s with UDP, 0.5 s with TCP)
+    std::string scenario;       // scenario file describing the jobs to run
+    int job{-1};                // job of the scenario to run, -1 for all of them
+    bool listJobs{false};       // list the jobs of the scenario and exit
+    std::vector<ScenarioSetting> schedulerAttributes; // set on the MU scheduler of every AP
+    std::string attributeArgs;  // --ns3::... command line options, part of the cache key
+    bool cache{false};          // reuse the results of the runs simulated before
+    std::string cacheDir{"scratch/attacks/cache"};
+    bool cacheInspect{false};   // list the entries of the cache and exit
+    std::string cacheEvict;     // remove the matching entries of the cache and exit
+    bool schedTrace{true};      // write the outcome of every UL MU station selection
+    bool latency{false};        // record the per-client MAC and application delays
+    std::string attack;         // per-client misbehaviors, or a single one for the attackers
+    uint32_t attackers{1};      // misbehaving clients of a single misbehavior
+    Time attackPeriod{MilliSeconds(100)}; // period of the skip misbehavior
+    std::string latencyTargets; // per-client latency targets of the MU scheduler
+    bool profile{false};        // attribute the wall-clock time of the events to their handlers
+    bool linkBudgetCache{true}; // compute the loss of each link once (same results)
+    double maxLossDb{0};        // links with a larger loss are not simulated (0: all of them)
+    bool isolateClients{false}; // abstracted PHY: no links between the stations
+    bool asyncLog{false};       // write the console and the data files from a background thread
+    uint32_t asyncLogBuffer{1024};      // KiB of the ring buffer of every output
+    std::string asyncLogPolicy{"Block"}; // console lines outrunning the writer: Block or Drop
+};
 
-    CommandLine cmd(__FILE__);
+/**
+ * Results of a single run of a sweep point
+ */
+struct PointResult
+{
+    std::vector<double> tputPerClient; //!< per-client throughput in Mbit/s
+    double throughput{0};              //!< total throughput in Mbit/s
+    double stopTime{0};                //!< simulated time the run stopped at, in seconds
+    uint64_t events{0};                //!< number of simulator events executed
+    double wallSeconds{0};             //!< wall-clock time spent in Simulator::Run
+    double rssKbPerSta{0};             //!< resident memory growth per station, in KiB
+    double peakRssKb{0};               //!< peak resident memory of the process, in KiB
+    std::vector<std::pair<std::string, double>> memKbPerSta; //!< KiB per station of each
+                                                             //!< component (memProfile only)
+    std::vector<std::pair<std::string, double>> schedCounters; //!< schedule-efficiency
+                                                               //!< counters (MU scheduler only)
+    std::string schedTrace; //!< rows of the UL MU station selections (schedTrace only)
+    std::string eventProfile; //!< "<folded stack> <wall ns> <events>" rows (profile only)
+    std::vector<std::array<double, 6>> latencyPerClient; //!< per-client p50, p99 and p99.9
+                                                         //!< of the MAC and application
+                                                         //!< delays in ms (latency only)
+    std::vector<std::array<double, 4>> airtimePerClient; //!< per-client DL MU, UL TB, BSRP
+                                                         //!< and SU airtime in us (MU
+                                                         //!< scheduler only)
+};
+
+/**
+ * \param field the name of a field of /proc/self/status (e.g., VmRSS)
+ * \return the value of the field in KiB, or 0 if it is not available
+ */
+static double
+ReadProcStatusKb(const std::string& field)
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+    {
+        if (line.compare(0, field.size() + 1, field + ":") == 0)
+        {
+            return std::stod(line.substr(field.size() + 1));
+        }
+    }
+    return 0;
+}
+
+/**
+ * \param cfg the experiment knobs
+ * \param i the index of the client (stations of the same BSS are contiguous)
+ * \return the label of the client in the output files
+ */
+static std::string
+GetClientLabel(const SawConfig& cfg, std::size_t i)
+{
+    if (cfg.nAps == 1)
+    {
+        return "client" + std::to_string(i + 1);
+    }
+    return "ap" + std::to_string(i / cfg.clients + 1) + ".client" +
+           std::to_string(i % cfg.clients + 1);
+}
+
+/**
+ * Compute the positions of the stations of a BSS.
+ *
+ * \param cfg the experiment knobs
+ * \param ap the position of the AP of the BSS
+ * \param stream the first random stream used by the allocator
+ * \return the position allocator of the stations
+ */
+static Ptr<PositionAllocator>
+CreateStaPositionAllocator(const SawConfig& cfg, Vector ap, int64_t stream)
+{
+    if (cfg.layout == "disc")
+    {
+        //* Uniformly distributed within `distance` from the AP
+        auto disc = CreateObject<UniformDiscPositionAllocator>();
+        disc->SetRho(cfg.distance);
+        disc->SetX(ap.x);
+        disc->SetY(ap.y);
+        disc->AssignStreams(stream);
+        return disc;
+    }
+
+    auto list = CreateObject<ListPositionAllocator>();
+    if (cfg.layout == "ring")
+    {
+        //* Evenly spaced on a circle of radius `distance` centered on the AP
+        for (std::size_t j = 0; j < cfg.clients; j++)
+        {
+            double angle = 2 * M_PI * j / cfg.clients;
+            list->Add(Vector(ap.x + cfg.distance * std::cos(angle),
+                             ap.y + cfg.distance * std::sin(angle),
+                             0.0));
+        }
+    }
+    else if (cfg.layout == "grid")
+    {
+        //* Square grid covering [-distance, distance] on both axes around the AP
+        auto side = static_cast<std::size_t>(std::ceil(std::sqrt(cfg.clients)));
+        double step = 2 * cfg.distance / side;
+        for (std::size_t j = 0; j < cfg.clients; j++)
+        {
+            list->Add(Vector(ap.x - cfg.distance + step * (j % side + 0.5),
+                             ap.y - cfg.distance + step * (j / side + 0.5),
+                             0.0));
+        }
+    }
+    else
+    {
+        //* All the stations at (distance, 0, 0) from the AP
+        for (std::size_t j = 0; j < cfg.clients; j++)
+        {
+            list->Add(Vector(ap.x + cfg.distance, ap.y, 0.0));
+        }
+    }
+    return list;
+}
+
+/**
+ * Serialize the result of a replication to be shipped to the parent process.
+ *
+ * \param result the result of the run
+ * \param series the time series streamed by the sampler during the run
+ * \return the serialized result
+ */
+static std::string
+SerializePointResult(const PointResult& result, const std::string& series)
+{
+    std::ostringstream oss;
+    oss.precision(17);
+    oss << result.stopTime << " " << result.throughput << " " << result.events << " "
+        << result.wallSeconds << " " << result.rssKbPerSta << " " << result.peakRssKb << " "
+        << result.tputPerClient.size();
+    for (auto tput : result.tputPerClient)
+    {
+        oss << " " << tput;
+    }
+    oss << " " << result.memKbPerSta.size();
+    for (const auto& [component, kb] : result.memKbPerSta)
+    {
+        oss << " " << component << " " << kb;
+    }
+    oss << " " << result.schedCounters.size();
+    for (const auto& [name, value] : result.schedCounters)
+    {
+        oss << " " << name << " " << value;
+    }
+    oss << " " << result.latencyPerClient.size();
+    for (const auto& latency : result.latencyPerClient)
+    {
+        for (auto value : latency)
+        {
+            oss << " " << value;
+        }
+    }
+    oss << " " << result.airtimePerClient.size();
+    for (const auto& airtime : result.airtimePerClient)
+    {
+        for (auto value : airtime)
+        {
+            oss << " " << value;
+        }
+    }
+    oss << " " << result.schedTrace.size() << " " << result.eventProfile.size() << "\n"
+        << result.schedTrace << result.eventProfile << series;
+    return oss.str();
+}
+
+/**
+ * Deserialize the result of a replication.
+ *
+ * \param data the serialized result
+ * \param series filled with the time series streamed during the run
+ * \return the result of the run
+ */
+static PointResult
+DeserializePointResult(const std::string& data, std::string& series)
+{
+    PointResult result;
+    auto eol = data.find('\n');
+    NS_ABORT_MSG_IF(eol == std::string::npos, "Truncated replication result");
+    std::istringstream iss(data.substr(0, eol));
+    std::size_t n = 0;
+    iss >> result.stopTime >> result.throughput >> result.events >> result.wallSeconds >>
+        result.rssKbPerSta >> result.peakRssKb >> n;
+    result.tputPerClient.resize(n);
+    for (auto& tput : result.tputPerClient)
+    {
+        iss >> tput;
+    }
+    iss >> n;
+    result.memKbPerSta.resize(n);
+    for (auto& [component, kb] : result.memKbPerSta)
+    {
+        iss >> component >> kb;
+    }
+    iss >> n;
+    result.schedCounters.resize(n);
+    for (auto& [name, value] : result.schedCounters)
+    {
+        iss >> name >> value;
+    }
+    iss >> n;
+    result.latencyPerClient.resize(n);
+    for (auto& latency : result.latencyPerClient)
+    {
+        for (auto& value : latency)
+        {
+            iss >> value;
+        }
+    }
+    iss >> n;
+    result.airtimePerClient.resize(n);
+    for (auto& airtime : result.airtimePerClient)
+    {
+        for (auto& value : airtime)
+        {
+            iss >> value;
+        }
+    }
+    std::size_t m = 0;
+    iss >> n >> m;
+    result.schedTrace = data.substr(eol + 1, n);
+    result.eventProfile = data.substr(eol + 1 + n, m);
+    series = data.substr(eol + 1 + n + m);
+    return result;
+}
+
+/**
+ * Hash the traffic specification along with the contents of the trace files it names,
+ * so that editing or replacing a trace invalidates the cached runs replaying it.
+ *
+ * \param cfg the experiment knobs
+ * \return the hash of the traffic specification and of its trace files
+ */
+static uint64_t
+HashTraffic(const SawConfig& cfg)
+{
+    auto hash = ResultCache::Hash(cfg.traffic);
+    if (cfg.traffic.empty())
+    {
+        return hash;
+    }
+    std::set<std::string> traceFiles;
+    for (const auto& model : ParseTrafficSpec(cfg.traffic, cfg.clients * cfg.nAps))
+    {
+        if (model.name == "trace")
+        {
+            traceFiles.insert(model.Get("FileName", ""));
+        }
+    }
+    for (const auto& fileName : traceFiles)
+    {
+        std::ifstream file(fileName, std::ios::binary);
+        std::ostringstream contents;
+        contents << file.rdbuf();
+        hash = ResultCache::Hash(fileName + "\n" + contents.str(), hash);
+    }
+    return hash;
+}
+
+/**
+ * Describe a run for the result cache. Every knob the results depend on must be listed
+ * here (the output-only ones, e.g., enablePcap, must not).
+ *
+ * \param cfg the experiment knobs
+ * \param mcs the MCS
+ * \param channelWidth the channel width in MHz
+ * \param gi the guard interval in nanoseconds
+ * \param run the RNG run number
+ * \return the description of the run, as space separated key=value tokens
+ */
+static std::string
+DescribeRun(const SawConfig& cfg, int mcs, int channelWidth, int gi, uint32_t run)
+{
+    std::ostringstream oss;
+    oss.precision(17);
+    oss << "mcs=" << mcs << " channelWidth=" << channelWidth << " gi=" << gi
+        << " muUsers=" << cfg.muUsers << " run=" << run << " clients=" << cfg.clients
+        << " nAps=" << cfg.nAps << " layout=" << cfg.layout << " distance=" << cfg.distance
+        << " apSpacing=" << cfg.apSpacing << " frequency=" << cfg.frequency
+        << " simulationTime=" << cfg.simulationTime << " udp=" << cfg.udp
+        << " downlink=" << cfg.downlink << " useRts=" << cfg.useRts
+        << " useExtendedBlockAck=" << cfg.useExtendedBlockAck << " dlAckType=" << cfg.dlAckSeqType
+        << " enableUlOfdma=" << cfg.enableUlOfdma << " enableBsrp=" << cfg.enableBsrp
+        << " useCentral26TonesRus=" << cfg.useCentral26TonesRus
+        << " muSchedAccessReqInterval=" << cfg.accessReqInterval.GetTimeStep()
+        << " payloadSize=" << cfg.payloadSize << " phyModel=" << cfg.phyModel
+        << " sampleInterval=" << cfg.sampleInterval.GetTimeStep() << " warmup=" << cfg.warmup
+        << " ciTarget=" << cfg.ciTarget << " ciBatchWindows=" << cfg.ciBatchWindows
+        << " ciMinBatches=" << cfg.ciMinBatches << " convergenceWindows=" << cfg.convergenceWindows
+        << " convergenceThreshold=" << cfg.convergenceThreshold
+        << " convergencePerClient=" << cfg.convergencePerClient << " memProfile=" << cfg.memProfile
+        << " basePort=" << cfg.basePort << " clientStart=" << cfg.clientStart
+        << " schedTrace=" << cfg.schedTrace << " latency=" << cfg.latency
+        << " attackers=" << cfg.attackers << " attackPeriod=" << cfg.attackPeriod.GetTimeStep()
+        << " profile=" << cfg.profile << " maxLossDb=" << cfg.maxLossDb
+        << " isolateClients=" << cfg.isolateClients;
+    //* Free-form values are hashed to keep the description a list of tokens
+    oss << std::hex << " traffic=" << HashTraffic(cfg)
+        << " attack=" << ResultCache::Hash(cfg.attack)
+        << " latencyTargets=" << ResultCache::Hash(cfg.latencyTargets);
+    std::string scheduler;
+    for (const auto& [name, value] : cfg.schedulerAttributes)
+    {
+        scheduler += name + "=" + value + "\n";
+    }
+    oss << " scheduler=" << ResultCache::Hash(scheduler)
+        << " attributes=" << ResultCache::Hash(cfg.attributeArgs);
+    return oss.str();
+}
+
+/**
+ * Simulate a single sweep point.
+ *
+ * \param cfg the experiment knobs
+ * \param mcs the MCS
+ * \param channelWidth the channel width in MHz
+ * \param gi the guard interval in nanoseconds
+ * \param run the RNG run number
+ * \param seriesOut the stream the sampler writes the time series to
+ * \return the results of the run
+ */
+static PointResult
+RunSweepPoint(const SawConfig& cfg,
+              int mcs,
+              int channelWidth,
+              int gi,
+              uint32_t run,
+              std::ostream& seriesOut)
+{
+    //* Replications only differ in the RNG run number, which must be set before any
+    //* random variable is created
+    RngSeedManager::SetSeed(1);
+    RngSeedManager::SetRun(run);
+
+    //* The profiler must replace the simulator before its first event is scheduled, i.e.,
+    //* before the nodes are created
+    Ptr<ProfilingSimulatorImpl> profiler;
+    if (cfg.profile)
+    {
+        GlobalValue::Bind("SimulatorImplementationType",
+                          StringValue("ns3::ProfilingSimulatorImpl"));
+        profiler = DynamicCast<ProfilingSimulatorImpl>(Simulator::GetImplementation());
+        NS_ABORT_MSG_IF(!profiler, "The simulator was created before the event profiler");
+    }
+
+    PointResult result;
+    double rssKbBefore = ReadProcStatusKb("VmRSS");
+
+    if (!cfg.udp)
+    {
+        Config::SetDefault("ns3::TcpSocket::SegmentSize", UintegerValue(cfg.payloadSize));
+    }
+
+    //* The stations of BSS k are the ones with index in [k * clients, (k + 1) * clients)
+    std::size_t nClients = cfg.clients * cfg.nAps;
+
+    //* In memory profiling mode, the RSS growth is charged to the component set up last
+    double rssKbMark = rssKbBefore;
+    auto chargeMemory = [&cfg, &result, &rssKbMark, nClients](const std::string& component) {
+        if (cfg.memProfile)
+        {
+            double rssKb = ReadProcStatusKb("VmRSS");
+            result.memKbPerSta.emplace_back(component, (rssKb - rssKbMark) / nClients);
+            rssKbMark = rssKb;
+        }
+    };
+
+    NodeContainer wifiStaNodes;
+    wifiStaNodes.Create(nClients);
+    NodeContainer wifiApNodes;
+    wifiApNodes.Create(cfg.nAps);
+    chargeMemory("nodes");
+
+    WifiMacHelper mac;
+    WifiHelper wifi;
+    std::string channelStr("{0, " + std::to_string(channelWidth) + ", ");
+    StringValue ctrlRate;
+    auto nonHtRefRateMbps = HePhy::GetNonHtReferenceRate(mcs) / 1e6;
+
+    std::ostringstream ossDataMode;
+    ossDataMode << "HeMcs" << mcs;
+
+    if (cfg.frequency == 6)
+    {
+        ctrlRate = StringValue(ossDataMode.str());
+        channelStr += "BAND_6GHZ, 0}";
+        Config::SetDefault("ns3::LogDistancePropagationLossModel::ReferenceLoss",
+                           DoubleValue(48));
+    }
+    else if (cfg.frequency == 5)
+    {
+        std::ostringstream ossControlMode;
+        ossControlMode << "OfdmRate" << nonHtRefRateMbps << "Mbps";
+        ctrlRate = StringValue(ossControlMode.str());
+        channelStr += "BAND_5GHZ, 0}";
+    }
+    else if (cfg.frequency == 2.4)
+    {
+        std::ostringstream ossControlMode;
+        ossControlMode << "ErpOfdmRate" << nonHtRefRateMbps << "Mbps";
+        ctrlRate = StringValue(ossControlMode.str());
+        channelStr += "BAND_2_4GHZ, 0}";
+        Config::SetDefault("ns3::LogDistancePropagationLossModel::ReferenceLoss",
+                           DoubleValue(40));
+    }
+    else
+    {
+        NS_ABORT_MSG("Wrong frequency value!");
+    }
+
+    wifi.SetStandard(WIFI_STANDARD_80211ax);
+    auto getSsid = [&cfg](uint32_t k) {
+        return Ssid(cfg.nAps == 1 ? "ns3-80211ax" : "ns3-80211ax-" + std::to_string(k));
+    };
+    auto getBssStaNodes = [&cfg, &wifiStaNodes](uint32_t k) {
+        NodeContainer nodes;
+        for (std::size_t j = 0; j < cfg.clients; j++)
+        {
+            nodes.Add(wifiStaNodes.Get(k * cfg.clients + j));
+        }
+        return nodes;
+    };
+
+    wifi.SetRemoteStationManager("ns3::ConstantRateWifiManager",
+                                 "DataMode",
+                                 StringValue(ossDataMode.str()),
+                                 "ControlMode",
+                                 ctrlRate);
+    // Set guard interval and MPDU buffer size
+    wifi.ConfigHeOptions("GuardInterval",
+                         TimeValue(NanoSeconds(gi)),
+                         "MpduBufferSize",
+                         UintegerValue(cfg.useExtendedBlockAck ? 256 : 64));
+
+    //* The nodes do not move, hence the loss of each link can be computed once instead
+    //* of at every transmission
+    Ptr<PropagationLossModel> lossModel = CreateObject<LogDistancePropagationLossModel>();
+    bool abstractPhy = (cfg.phyModel == "Abstract");
+    if (abstractPhy)
+    {
+        //* With isolated clients, only the links involving an AP are simulated
+        auto apCentric = CreateObject<ApCentricPropagationLossModel>();
+        apCentric->SetModel(lossModel);
+        if (cfg.isolateClients)
+        {
+            apCentric->SetAttribute("IsolationLoss", DoubleValue(1000));
+        }
+        for (uint32_t k = 0; k < cfg.nAps; k++)
+        {
+            apCentric->AddAp(wifiApNodes.Get(k)->GetId());
+        }
+        lossModel = apCentric;
+    }
+    Ptr<CachedPropagationLossModel> linkBudgetCache;
+    if (cfg.linkBudgetCache)
+    {
+        linkBudgetCache = CreateObject<CachedPropagationLossModel>();
+        linkBudgetCache->SetModel(lossModel);
+        lossModel = linkBudgetCache;
+    }
+
+    NetDeviceContainer apDevices;
+    NetDeviceContainer staDevices;
+    std::vector<NetDeviceContainer> bssStaDevices(cfg.nAps);
+    if (cfg.phyModel == "Spectrum" || abstractPhy)
+    {
+        //* All the BSSs share the same channel, hence they interfere with each other
+        Ptr<MultiModelSpectrumChannel> spectrumChannel =
+            CreateObject<MultiModelSpectrumChannel>();
+        spectrumChannel->AddPropagationLossModel(lossModel);
+        //* Reduced fidelity: the signals of the distant BSSs are neither received nor
+        //* counted as interference
+        if (cfg.maxLossDb > 0)
+        {
+            spectrumChannel->SetAttribute("MaxLossDb", DoubleValue(cfg.maxLossDb));
+        }
+        //* The links between isolated stations (1000 dB) are not delivered at all
+        if (abstractPhy && cfg.isolateClients && (cfg.maxLossDb == 0 || cfg.maxLossDb > 500))
+        {
+            spectrumChannel->SetAttribute("MaxLossDb", DoubleValue(500));
+        }
+
+        SpectrumWifiPhyHelper phy;
+        phy.SetPcapDataLinkType(WifiPhyHelper::DLT_IEEE802_11_RADIO);
+        phy.SetChannel(spectrumChannel);
+        if (abstractPhy)
+        {
+            phy.SetErrorRateModel("ns3::ThresholdErrorRateModel");
+        }
+
+        phy.Set("ChannelSettings", StringValue(channelStr));
+
+        if (cfg.dlAckSeqType != "NO-OFDMA")
+        {
+            //* Configure the WiFi 6 scheduler.
+            mac.SetMultiUserScheduler("ns3::RrMultiUserScheduler",
+                                      "EnableUlOfdma",
+                                      BooleanValue(cfg.enableUlOfdma),
+                                      "EnableBsrp",
+                                      BooleanValue(cfg.enableBsrp),
+                                      "AccessReqInterval",
+                                      TimeValue(cfg.accessReqInterval),
+                                      "UseCentral26TonesRus",
+                                      BooleanValue(cfg.useCentral26TonesRus)
+                                      ,"NStations",
+                                      UintegerValue(cfg.muUsers)
+                                      );
+        }
+        for (uint32_t k = 0; k < cfg.nAps; k++)
+        {
+            mac.SetType("ns3::StaWifiMac", "Ssid", SsidValue(getSsid(k)),
+                "ActiveProbing", BooleanValue(false)
+                // "PsMode", StringValue("SLEEP")
+                // "QosSupported", BooleanValue(true),
+            );
+            bssStaDevices[k] = wifi.Install(phy, mac, getBssStaNodes(k));
+            staDevices.Add(bssStaDevices[k]);
+
+            mac.SetType("ns3::ApWifiMac",
+                        "EnableBeaconJitter",
+                        BooleanValue(false),
+                        "Ssid",
+                        SsidValue(getSsid(k)));
+            apDevices.Add(wifi.Install(phy, mac, wifiApNodes.Get(k)));
+        }
+
+        // phy.EnablePcap("attacker", staDevices.Get(0), true);
+        if (cfg.enablePcap)
+        {
+            phy.EnablePcap("ap.pcap", apDevices.Get(0), true, true);
+        }
+        // phy.EnablePcapAll("all", true);
+        // AsciiTraceHelper ascii;
+        // phy.EnableAsciiAll(ascii.CreateFileStream("wifi-trace.tr"));
+        // LogComponentEnable("WifiMac", LOG_LEVEL_ALL);
+        // LogComponentEnable("OnOffApplication", LOG_LEVEL_ALL);
+
+        //! Doesn't work w/o adjusting associated link IDs 
+        // //* Change  MAC addresses for clients
+        // for (uint32_t i = 0; i < cfg.clients; ++i) {
+        //     std::string macAddress = "00:00:00:00:00:C" + std::to_string(i+1);
+        //     // wifiStaNodes.Get(i)->GetDevice(0)->GetObject<WifiNetDevice>()->SetAddress(Mac48Address(macAddress.c_str()));
+        //     Ptr<NetDevice> dev = staDevices.Get(i);
+        //     Ptr<WifiNetDevice> wifiDev = dev->GetObject<WifiNetDevice>();
+        //     wifiDev->SetAddress(Mac48Address(macAddress.c_str()));
+        // }
+        // //* Change MAC address for the AP
+        // wifiApNode.Get(0)->GetObject<Node>()->GetDevice(0)
+        //     ->GetObject<WifiNetDevice>()->SetAddress(Mac48Address("00:00:00:00:00:AA"));
+        // Ptr<NetDevice> dev = apDevice.Get(0);
+        // Ptr<WifiNetDevice> wifiDev = dev->GetObject<WifiNetDevice>();
+        // wifiDev->SetAddress(Mac48Address("00:00:00:00:00:0A"));
+    }
+    else
+    {
+        // //* Disable frame aggregation.
+        // Config::SetDefault("ns3::WifiMac::BE_MaxAmpduSize", UintegerValue(0));
+        //* Same models as YansWifiChannelHelper::Default()
+        Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel>();
+        channel->SetPropagationLossModel(lossModel);
+        channel->SetPropagationDelayModel(CreateObject<ConstantSpeedPropagationDelayModel>());
+        YansWifiPhyHelper phy;
+        phy.SetPcapDataLinkType(WifiPhyHelper::DLT_IEEE802_11_RADIO);
+        phy.SetChannel(channel);
+
+
+        phy.Set("ChannelSettings", StringValue(channelStr));
+        for (uint32_t k = 0; k < cfg.nAps; k++)
+        {
+            mac.SetType("ns3::StaWifiMac", "Ssid", SsidValue(getSsid(k))
+                // "ActiveProbing", BooleanValue(false),
+                // "QosSupported", BooleanValue(true),
+            );
+            bssStaDevices[k] = wifi.Install(phy, mac, getBssStaNodes(k));
+            staDevices.Add(bssStaDevices[k]);
+
+            mac.SetType("ns3::ApWifiMac",
+                        "EnableBeaconJitter",
+                        BooleanValue(false),
+                        "Ssid",
+                        SsidValue(getSsid(k)));
+            apDevices.Add(wifi.Install(phy, mac, wifiApNodes.Get(k)));
+        }
+        
+        // phy.EnablePcap("ap.pcap", staDevices.Get(0), true, true);
+        if (cfg.enablePcap)
+        {
+            phy.EnablePcap("ap.pcap", apDevices.Get(0), true, true);
+        }
+        // phy.EnablePcapAll("all", true);
+        // AsciiTraceHelper ascii;
+        // phy.EnableAsciiAll(ascii.CreateFileStream("wifi-trace.tr"));
+        // LogComponentEnable("WifiMac", LOG_LEVEL_ALL);
+        // LogComponentEnable("OnOffApplication", LOG_LEVEL_ALL);
+    }
+
+    if (cfg.nAps > 1)
+    {
+        //* Distinct BSS colors let the stations tell the OBSS frames apart
+        for (uint32_t k = 0; k < cfg.nAps; k++)
+        {
+            DynamicCast<WifiNetDevice>(apDevices.Get(k))
+                ->GetHeConfiguration()
+                ->SetAttribute("BssColor", UintegerValue(k % 63 + 1));
+        }
+    }
+
+    //* Scheduler attributes of the scenario, validated beforehand
+    for (uint32_t k = 0; k < cfg.nAps && !cfg.schedulerAttributes.empty(); k++)
+    {
+        auto apMac = DynamicCast<WifiNetDevice>(apDevices.Get(k))->GetMac();
+        auto muScheduler = apMac->GetObject<MultiUserScheduler>();
+        NS_ABORT_MSG_IF(!muScheduler, "Scheduler attributes require an MU scheduler");
+        for (const auto& [name, value] : cfg.schedulerAttributes)
+        {
+            muScheduler->SetAttribute(name, StringValue(value));
+        }
+    }
+
+    //* Per-client latency targets, set on the scheduler of the AP of each client
+    auto latencyTargets = ParseLatencyTargetSpec(cfg.latencyTargets, nClients);
+    for (std::size_t i = 0; i < nClients; i++)
+    {
+        if (latencyTargets[i].IsStrictlyPositive())
+        {
+            auto apMac = DynamicCast<WifiNetDevice>(apDevices.Get(i / cfg.clients))->GetMac();
+            auto muScheduler = DynamicCast<RrMultiUserScheduler>(
+                apMac->GetObject<MultiUserScheduler>());
+            NS_ABORT_MSG_IF(!muScheduler, "Latency targets require the RR MU scheduler");
+            muScheduler->SetLatencyTarget(
+                DynamicCast<WifiNetDevice>(staDevices.Get(i))->GetMac()->GetAddress(),
+                latencyTargets[i]);
+        }
+    }
+
+    //* Schedule-efficiency counters (reset at the end of the warm-up), trace of the
+    //* UL MU station selections and per-client airtime ledger
+    std::ostringstream schedTrace;
+    std::map<Mac48Address, std::size_t> clientByMac;
+    for (std::size_t i = 0; i < nClients && cfg.dlAckSeqType != "NO-OFDMA"; i++)
+    {
+        clientByMac[DynamicCast<WifiNetDevice>(staDevices.Get(i))->GetMac()->GetAddress()] = i;
+        result.airtimePerClient.emplace_back();
+    }
+    for (uint32_t k = 0; k < cfg.nAps && cfg.dlAckSeqType != "NO-OFDMA"; k++)
+    {
+        auto apMac = DynamicCast<WifiNetDevice>(apDevices.Get(k))->GetMac();
+        auto muScheduler = apMac->GetObject<MultiUserScheduler>();
+        muScheduler->SetAttribute("CountersStartTime", TimeValue(Seconds(cfg.warmup)));
+        muScheduler->TraceConnectWithoutContext(
+            "AirtimeCharged",
+            Callback<void, Mac48Address, uint8_t, Time>(
+                [&result, &clientByMac, warmup = Seconds(cfg.warmup)](Mac48Address address,
+                                                                      uint8_t kind,
+                                                                      Time airtime) {
+                    auto it = clientByMac.find(address);
+                    if (Simulator::Now() >= warmup && it != clientByMac.end())
+                    {
+                        result.airtimePerClient[it->second].at(kind) +=
+                            airtime.ToDouble(Time::US);
+                    }
+                }));
+        if (cfg.schedTrace)
+        {
+            std::string prefix = std::to_string(mcs) + "," + std::to_string(channelWidth) + "," +
+                                 std::to_string(gi) + "," + std::to_string(k) + ",";
+            muScheduler->TraceConnectWithoutContext(
+                "ScheduleStats",
+                Callback<void, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t>(
+                    [&schedTrace, prefix, run](uint32_t total,
+                                               uint32_t unsolicited,
+                                               uint32_t nRus,
+                                               uint32_t candidates,
+                                               uint32_t scheduled) {
+                        schedTrace << prefix << Simulator::Now().GetMicroSeconds() << ","
+                                   << total << "," << unsolicited << "," << nRus << ","
+                                   << candidates << "," << scheduled << "," << run << "\n";
+                    }));
+        }
+    }
+
+    int64_t streamNumber = 42;
+    streamNumber += wifi.AssignStreams(apDevices, streamNumber);
+    streamNumber += wifi.AssignStreams(staDevices, streamNumber);
+    chargeMemory("wifi_devices");
+
+    //* Misbehaving clients, emulated until the end of the run
+    MisbehaviorEmulator misbehaviors(cfg.attackPeriod);
+    auto clientMisbehaviors = ParseMisbehaviorSpec(cfg.attack, cfg.attackers, nClients);
+    for (std::size_t i = 0; i < nClients; i++)
+    {
+        if (clientMisbehaviors[i] != Misbehavior::NONE)
+        {
+            misbehaviors.Install(clientMisbehaviors[i],
+                                 DynamicCast<WifiNetDevice>(staDevices.Get(i)),
+                                 DynamicCast<WifiNetDevice>(apDevices.Get(i / cfg.clients)));
+            std::cout << "Client[" << i << "] misbehavior: "
+                      << GetMisbehaviorName(clientMisbehaviors[i]) << std::endl;
+        }
+    }
+
+    // Mobility:
+    //* Set the position of the APs at (k * apSpacing, 0, 0)
+    MobilityHelper mobilityAp;
+    Ptr<ListPositionAllocator> positionAllocAp = CreateObject<ListPositionAllocator>();
+    for (uint32_t k = 0; k < cfg.nAps; k++)
+    {
+        positionAllocAp->Add(Vector(k * cfg.apSpacing, 0.0, 0.0)); // Position of the AP
+    }
+    mobilityAp.SetPositionAllocator(positionAllocAp);
+    mobilityAp.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    mobilityAp.Install(wifiApNodes);
+
+    //* Place the stations of each BSS around their AP according to the layout
+    for (uint32_t k = 0; k < cfg.nAps; k++)
+    {
+        MobilityHelper mobilitySta;
+        mobilitySta.SetPositionAllocator(
+            CreateStaPositionAllocator(cfg, Vector(k * cfg.apSpacing, 0.0, 0.0), streamNumber));
+        streamNumber += 2;
+        mobilitySta.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+        mobilitySta.Install(getBssStaNodes(k));
+    }
+    chargeMemory("mobility");
+
+    /* Internet stack*/
+    InternetStackHelper stack;
+    stack.Install(wifiApNodes);
+    stack.Install(wifiStaNodes);
+
+    //* BSS k uses 10.k.0.0/16 (10.0.0.0/24 in the single-BSS case, as long as it fits)
+    bool smallSubnet = (cfg.nAps == 1 && cfg.clients < 254);
+    Ipv4InterfaceContainer staNodeInterfaces;
+    Ipv4InterfaceContainer apNodeInterfaces;
+    for (uint32_t k = 0; k < cfg.nAps; k++)
+    {
+        std::string prefix = "10." + std::to_string(k) + ".";
+        Ipv4Mask mask(smallSubnet ? "255.255.255.0" : "255.255.0.0");
+        Ipv4AddressHelper address;
+        address.SetBase((prefix + "0.0").c_str(), mask);
+        // * The 1st client is 10.k.0.1
+        staNodeInterfaces.Add(address.Assign(bssStaDevices[k]));
+        Ipv4InterfaceContainer apNodeInterface = address.Assign(apDevices.Get(k));
+
+        //* Manually set the AP node's IP address to 10.k.0.254 (10.k.255.254 with a /16)
+        Ipv4Address apAddress((prefix + (smallSubnet ? "0.254" : "255.254")).c_str());
+        Ptr<Ipv4> ipv4 = wifiApNodes.Get(k)->GetObject<Ipv4>();
+        int32_t interfaceIndex = ipv4->GetInterfaceForDevice(apDevices.Get(k));
+        ipv4->RemoveAddress(interfaceIndex, 0);  // Remove the assigned IP
+        ipv4->AddAddress(interfaceIndex, Ipv4InterfaceAddress(apAddress, mask));
+        ipv4->SetMetric(interfaceIndex, 1);  // Optional: set the metric if needed
+        ipv4->SetUp(interfaceIndex);
+        apNodeInterfaces.Add(apNodeInterface);
+    }
+    chargeMemory("internet_stack");
+
+    /* Setting applications */
+    // ApplicationContainer serverApp;
+    //* Every client talks to a server in its own BSS
+    Ipv4InterfaceContainer serverInterfaces;
+    NodeContainer serverNodes;
+    NodeContainer clientNodes;
+    for (std::size_t i = 0; i < nClients; i++)
+    {
+        auto k = i / cfg.clients;
+        if (cfg.downlink) {
+            serverInterfaces.Add(staNodeInterfaces.Get(i));
+            serverNodes.Add(wifiStaNodes.Get(i));
+            clientNodes.Add(wifiApNodes.Get(k));
+        } else {
+            // Directly use the manually assigned AP address
+            serverInterfaces.Add(apNodeInterfaces.Get(k));
+            serverNodes.Add(wifiApNodes.Get(k));
+            clientNodes.Add(wifiStaNodes.Get(i));
+        }
+    }
+    // std::cout << "Total clients: " << clientNodes.GetN() << std::endl;
+    // std::cout << "Total servers: " << serverNodes.() << std::endl;
+
+    std::vector<ApplicationContainer> serverApps(nClients); // Store each server app for each client
+    std::cout << "MCS value"
+        << "\t"
+        << "Channel width"
+        << "\t"
+        << "GI" // Guard interval.
+        << "\t\t"
+        << "Throughput" 
+        << "\t\n";
+
+    //* Per-client traffic models; the default is the original setup, i.e., a 10 us
+    //* UDP client per station or, with TCP, an always-on client and on/off clients.
+    //* 20MHz channel with 1-8 STAs (3.2us GI, MCS 2)
+    //*  26-tone: 2.3Mbps; 52-tone: 4.5Mbps, 106-tone: 9.6Mbps, 242-tone: 21.9Mbps
+    std::string trafficSpec = cfg.traffic;
+    if (trafficSpec.empty())
+    {
+        trafficSpec = (cfg.udp ? "*:flood" : "0:cbr;*:onoff");
+    }
+    auto trafficModels = ParseTrafficSpec(trafficSpec, nClients);
+    std::string socketFactory = (cfg.udp ? "ns3::UdpSocketFactory" : "ns3::TcpSocketFactory");
+    std::vector<Ptr<Application>> sourceApps(nClients);
+
+    for (std::size_t i = 0; i < nClients; i++)
+    {
+        //* Assign a unique port to each client on its server
+        uint16_t port = cfg.basePort + i;
+        Address localAddress(InetSocketAddress(Ipv4Address::GetAny(), port));
+        PacketSinkHelper packetSinkHelper(socketFactory, localAddress);
+        //* Install a PacketSink on the server for each unique port
+        serverApps[i] = packetSinkHelper.Install(serverNodes.Get(i));
+        serverApps[i].Start(Seconds(0.0));
+        serverApps[i].Stop(Seconds(cfg.simulationTime + 1));
+
+        //* Client setup
+        std::cout << "Setting up Client[" << i << "]: " << staNodeInterfaces.GetAddress(i) << " ("
+                  << trafficModels[i].name << ")" << std::endl;
+        auto k = i / cfg.clients;
+        Ptr<NetDevice> txDevice = (cfg.downlink ? apDevices.Get(k) : staDevices.Get(i));
+        Ptr<NetDevice> rxDevice = (cfg.downlink ? staDevices.Get(i) : apDevices.Get(k));
+        ApplicationContainer clientApp =
+            InstallTrafficSource(trafficModels[i],
+                                 cfg.udp,
+                                 cfg.payloadSize,
+                                 clientNodes.Get(i),
+                                 txDevice,
+                                 InetSocketAddress(serverInterfaces.GetAddress(i), port),
+                                 Mac48Address::ConvertFrom(rxDevice->GetAddress()));
+        sourceApps[i] = clientApp.Get(0);
+        if (auto video = DynamicCast<VideoTrafficApp>(clientApp.Get(0)))
+        {
+            streamNumber += video->AssignStreams(streamNumber);
+        }
+        //* Unless configured, UDP clients start later, as they always did
+        clientApp.Start(Seconds(cfg.clientStart >= 0 ? cfg.clientStart : (cfg.udp ? 1.0 : 0.5)));
+        clientApp.Stop(Seconds(cfg.simulationTime + 1));
+    }
+
+    chargeMemory("applications");
+
+    //* Per-client MAC delays (from the transmitter's queue to the acknowledgment) and
+    //* application delays (from the source to the sink)
+    std::unique_ptr<LatencyRecorder> latency;
+    if (cfg.latency)
+    {
+        latency = std::make_unique<LatencyRecorder>(nClients, Seconds(cfg.warmup));
+        std::map<Mac48Address, int> clientByAddress;
+        for (std::size_t i = 0; i < nClients; i++)
+        {
+            latency->AttachSink(i, serverApps[i].Get(0));
+            latency->AttachSource(sourceApps[i]);
+            auto staMac = DynamicCast<WifiNetDevice>(staDevices.Get(i))->GetMac();
+            clientByAddress[staMac->GetAddress()] = i;
+            if (!cfg.downlink)
+            {
+                latency->AttachMac(staMac, [i](Mac48Address) { return static_cast<int>(i); });
+            }
+        }
+        for (uint32_t k = 0; k < cfg.nAps && cfg.downlink; k++)
+        {
+            latency->AttachMac(DynamicCast<WifiNetDevice>(apDevices.Get(k))->GetMac(),
+                               [clientByAddress](Mac48Address receiver) {
+                                   auto it = clientByAddress.find(receiver);
+                                   return (it != clientByAddress.end() ? it->second : -1);
+                               });
+        }
+    }
+
+    //* Periodic sampler of per-client throughput and goodput
+    std::unique_ptr<ThroughputSampler> sampler;
+    std::unique_ptr<ConvergenceController> convergence;
+    if (cfg.sampleInterval.IsStrictlyPositive())
+    {
+        sampler = std::make_unique<ThroughputSampler>(cfg.sampleInterval,
+                                                      Seconds(cfg.warmup),
+                                                      cfg.ciBatchWindows);
+        for (std::size_t i = 0; i < nClients; i++)
+        {
+            Ptr<PacketSink> sink = DynamicCast<PacketSink>(serverApps[i].Get(0));
+            auto index = sampler->AddClient(GetClientLabel(cfg, i),
+                                            [sink]() { return sink->GetTotalRx(); });
+            sampler->AddSource(index,
+                               sink->GetNode(),
+                               clientNodes.Get(i)->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal());
+        }
+        sampler->SetCiTarget(cfg.ciTarget, cfg.ciMinBatches);
+        if (cfg.convergenceWindows > 0)
+        {
+            convergence = std::make_unique<ConvergenceController>(cfg.convergenceWindows,
+                                                                  cfg.convergenceThreshold,
+                                                                  Seconds(cfg.warmup),
+                                                                  cfg.convergencePerClient);
+            convergence->Attach(*sampler);
+        }
+        sampler->Start(seriesOut,
+                       std::to_string(mcs) + "," + std::to_string(channelWidth) + "," +
+                           std::to_string(gi) + ",",
+                       "," + std::to_string(nClients) + "," + std::to_string(run));
+    }
+
+    chargeMemory("sampler");
+
+    Simulator::Schedule(Seconds(0), &Ipv4GlobalRoutingHelper::PopulateRoutingTables);
+    Simulator::Stop(Seconds(cfg.simulationTime + 1));
+    //* The console lines of the run are written out when the simulator is destroyed
+    Simulator::ScheduleDestroy(&FlushAsyncLog, &std::cout);
+    uint64_t eventsBefore = Simulator::GetEventCount();
+    auto wallStart = std::chrono::steady_clock::now();
+    Simulator::Run();
+    result.wallSeconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    result.events = Simulator::GetEventCount() - eventsBefore;
+    //* Either the configured end of the simulation or an early stop
+    result.stopTime = Simulator::Now().GetSeconds();
+    //* Measured before tearing down the scenario, hence including everything it allocated
+    result.rssKbPerSta = (ReadProcStatusKb("VmRSS") - rssKbBefore) / nClients;
+    result.peakRssKb = ReadProcStatusKb("VmHWM");
+    std::cout << result.events << " events in " << result.wallSeconds << " s of wall-clock time ("
+              << result.events / std::max(result.wallSeconds, 1e-9) << " events/s), "
+              << result.rssKbPerSta << " KiB of memory per station, " << result.peakRssKb
+              << " KiB of peak memory" << std::endl;
+    if (linkBudgetCache)
+    {
+        UintegerValue hits;
+        UintegerValue misses;
+        linkBudgetCache->GetAttribute("Hits", hits);
+        linkBudgetCache->GetAttribute("Misses", misses);
+        std::cout << "Link budget cache: " << hits.Get() << " hits, " << misses.Get()
+                  << " misses" << std::endl;
+    }
+    if (profiler)
+    {
+        //* One folded stack per handler, rooted at the sweep point
+        std::string root = "mcs" + std::to_string(mcs) + "_" + std::to_string(channelWidth) +
+                           "MHz_" + std::to_string(gi) + "ns_run" + std::to_string(run);
+        std::map<std::string, std::pair<uint64_t, uint64_t>> subsystems; // events, wall ns
+        uint64_t totalNs = 0;
+        std::ostringstream folded;
+        for (const auto& frame : profiler->GetProfile())
+        {
+            folded << root << ";" << frame.subsystem << ";" << frame.module << ";"
+                   << frame.handler << " " << frame.wallNs << " " << frame.events << "\n";
+            subsystems[frame.subsystem].first += frame.events;
+            subsystems[frame.subsystem].second += frame.wallNs;
+            totalNs += frame.wallNs;
+        }
+        result.eventProfile = folded.str();
+        std::cout << "Event profile:";
+        for (const auto& [subsystem, stats] : subsystems)
+        {
+            std::cout << " " << subsystem << "="
+                      << 100.0 * stats.second / std::max<uint64_t>(totalNs, 1) << "% ("
+                      << stats.first << " events)";
+        }
+        std::cout << std::endl;
+    }
+    if (cfg.memProfile)
+    {
+        //* Associations, queued packets, routing tables, etc.
+        chargeMemory("run");
+        //* Exact size of the per-station state of the MU scheduler (of the first AP)
+        auto apMac = DynamicCast<WifiNetDevice>(apDevices.Get(0))->GetMac();
+        if (auto muScheduler = apMac->GetObject<MultiUserScheduler>())
+        {
+            UintegerValue bytes;
+            if (muScheduler->GetAttributeFailSafe("StaStateBytes", bytes))
+            {
+                result.memKbPerSta.emplace_back("mu_scheduler", bytes.Get() / 1024.0);
+            }
+        }
+        //* Fixed-size delay histograms, independent of the number of packets
+        if (latency)
+        {
+            result.memKbPerSta.emplace_back("latency_histograms",
+                                            latency->GetMemoryBytes() / 1024.0 / nClients);
+        }
+        for (const auto& [component, kb] : result.memKbPerSta)
+        {
+            std::cout << "  " << component << ": " << kb << " KiB per station" << std::endl;
+        }
+    }
+
+    if (cfg.dlAckSeqType != "NO-OFDMA")
+    {
+        //* Counts and airtimes are summed over the APs, the RU utilization is weighted by
+        //* the number of MU PPDUs of each AP
+        std::vector<std::string> counts{"MuDecisions",
+                                        "TrimmedCandidates",
+                                        "UnsolicitedSkips",
+                                        "NoTxTxopTooShort",
+                                        "NoTxUlTooShort",
+                                        "NoTxNoDlFrames",
+                                        "LoadAwareChanges",
+                                        "DlMuPpdus",
+                                        "AggregatedMpdus",
+                                        "BsrAnomalies",
+                                        "SizedTriggerFrames",
+                                        "TxDurationHits",
+                                        "TxDurationMisses",
+                                        "SecondaryPsdus",
+                                        "SecondaryMpdus"};
+        std::vector<double> sums(counts.size(), 0);
+        double ruUtilization = 0;
+        double bsrpAirtimeUs = 0;
+        double dataAirtimeUs = 0;
+        double loadAwareSavedUs = 0;
+        double aggregationUs = 0;
+        double tfSizingUs = 0;
+        double paddingSum = 0; // padding fractions weighted by the DL MU PPDUs of each AP
+        for (uint32_t k = 0; k < cfg.nAps; k++)
+        {
+            auto apMac = DynamicCast<WifiNetDevice>(apDevices.Get(k))->GetMac();
+            auto muScheduler = apMac->GetObject<MultiUserScheduler>();
+            UintegerValue count;
+            for (std::size_t c = 0; c < counts.size(); c++)
+            {
+                muScheduler->GetAttribute(counts[c], count);
+                sums[c] += count.Get();
+            }
+            muScheduler->GetAttribute("MuDecisions", count);
+            DoubleValue utilization;
+            muScheduler->GetAttribute("RuUtilization", utilization);
+            ruUtilization += utilization.Get() * count.Get();
+            TimeValue airtime;
+            muScheduler->GetAttribute("BsrpAirtime", airtime);
+            bsrpAirtimeUs += airtime.Get().ToDouble(Time::US);
+            muScheduler->GetAttribute("DataAirtime", airtime);
+            dataAirtimeUs += airtime.Get().ToDouble(Time::US);
+            muScheduler->GetAttribute("LoadAwareAirtimeSaved", airtime);
+            loadAwareSavedUs += airtime.Get().ToDouble(Time::US);
+            muScheduler->GetAttribute("AggregationTime", airtime);
+            aggregationUs += airtime.Get().ToDouble(Time::US);
+            muScheduler->GetAttribute("TfSizingTime", airtime);
+            tfSizingUs += airtime.Get().ToDouble(Time::US);
+            muScheduler->GetAttribute("PaddingFraction", utilization);
+            UintegerValue dlMuPpdus;
+            muScheduler->GetAttribute("DlMuPpdus", dlMuPpdus);
+            paddingSum += utilization.Get() * dlMuPpdus.Get();
+        }
+        for (std::size_t c = 0; c < counts.size(); c++)
+        {
+            result.schedCounters.emplace_back(counts[c], sums[c]);
+        }
+        result.schedCounters.emplace_back("RuUtilization",
+                                          sums[0] > 0 ? ruUtilization / sums[0] : 0);
+        result.schedCounters.emplace_back("BsrpAirtimeUs", bsrpAirtimeUs);
+        result.schedCounters.emplace_back("DataAirtimeUs", dataAirtimeUs);
+        result.schedCounters.emplace_back("BsrpToDataRatio",
+                                          dataAirtimeUs > 0 ? bsrpAirtimeUs / dataAirtimeUs : 0);
+        result.schedCounters.emplace_back("LoadAwareSavedUs", loadAwareSavedUs);
+        //* Wall-clock cost of building the A-MPDUs of a DL MU PPDU
+        auto dlMuPpdus = sums[std::find(counts.begin(), counts.end(), "DlMuPpdus") - counts.begin()];
+        result.schedCounters.emplace_back("AggregationUsPerPpdu",
+                                          dlMuPpdus > 0 ? aggregationUs / dlMuPpdus : 0);
+        result.schedCounters.emplace_back("PaddingFraction",
+                                          dlMuPpdus > 0 ? paddingSum / dlMuPpdus : 0);
+        //* Wall-clock cost of computing the UL length of a Trigger Frame
+        auto sizedTfs =
+            sums[std::find(counts.begin(), counts.end(), "SizedTriggerFrames") - counts.begin()];
+        result.schedCounters.emplace_back("TfSizingUsPerTf",
+                                          sizedTfs > 0 ? tfSizingUs / sizedTfs : 0);
+        //* A-MPDU length of the PSDUs shorter than the longest one of their DL MU PPDU
+        auto secondaryPsdus =
+            sums[std::find(counts.begin(), counts.end(), "SecondaryPsdus") - counts.begin()];
+        auto secondaryMpdus =
+            sums[std::find(counts.begin(), counts.end(), "SecondaryMpdus") - counts.begin()];
+        result.schedCounters.emplace_back("SecondaryMpdusPerPsdu",
+                                          secondaryPsdus > 0 ? secondaryMpdus / secondaryPsdus
+                                                             : 0);
+        std::cout << "Scheduler after " << cfg.warmup << " s of warm-up:";
+        for (const auto& [name, value] : result.schedCounters)
+        {
+            std::cout << " " << name << "=" << value;
+        }
+        std::cout << std::endl;
+    }
+    result.schedTrace = schedTrace.str();
+
+    //* Throughput is averaged over the post-warm-up windows if the sampler ran
+    if (sampler && sampler->GetMeasuredTime().IsStrictlyPositive())
+    {
+        double measuredTime = sampler->GetMeasuredTime().GetSeconds();
+        auto total = sampler->GetTotalSummary();
+        std::cout << "Sampled " << measuredTime << " s after " << cfg.warmup << " s of warm-up: "
+                  << total.goodputMbps << " +/- " << total.ciHalfWidthMbps
+                  << " Mbit/s goodput, " << total.tputMbps << " Mbit/s throughput ("
+                  << total.nBatches << " batches)" << std::endl;
+        if (sampler->GetEarlyStopTime().IsStrictlyPositive())
+        {
+            std::cout << "Stopped early at " << sampler->GetEarlyStopTime().As(Time::S)
+                      << " (CI target " << cfg.ciTarget << ")" << std::endl;
+        }
+        if (convergence && convergence->GetStopTime().IsStrictlyPositive())
+        {
+            std::cout << "Stopped early at " << convergence->GetStopTime().As(Time::S)
+                      << " (converged within " << cfg.convergenceThreshold << " over "
+                      << cfg.convergenceWindows << " windows)" << std::endl;
+        }
+    }
+
+    //* Calculate individual throughput for each client
+    std::vector<uint64_t> rxBytesPerClient(nClients, 0); // Track received bytes for each client
+    result.tputPerClient.resize(nClients, 0);
+    for (std::size_t i = 0; i < nClients; i++) {
+        Ptr<PacketSink> sink = DynamicCast<PacketSink>(serverApps[i].Get(0));
+        rxBytesPerClient[i] = sink->GetTotalRx();
+        result.tputPerClient[i] = (rxBytesPerClient[i] * 8) / (cfg.simulationTime * 1000000.0); // Mbit/s
+        if (sampler && sampler->GetMeasuredTime().IsStrictlyPositive())
+        {
+            //* Exclude the warm-up from both the bytes and the divisor
+            result.tputPerClient[i] = sampler->GetClientSummary(i).goodputMbps;
+        }
+        std::cout << mcs << "\t\t" << channelWidth << " MHz\t\t" << gi << " ns\t\t"
+                  << result.tputPerClient[i] << " Mbit/s\t" << "(Client[" << i << "])" << std::endl;
+    }
+    uint64_t totalRxBytes =
+        std::accumulate(rxBytesPerClient.begin(), rxBytesPerClient.end(), uint64_t{0});
+    result.throughput = (totalRxBytes * 8) / (cfg.simulationTime * 1000000.0); // Mbit/s
+    if (sampler && sampler->GetMeasuredTime().IsStrictlyPositive())
+    {
+        result.throughput = sampler->GetTotalSummary().goodputMbps;
+    }
+
+    for (std::size_t i = 0; latency && i < nClients; i++)
+    {
+        auto mac = latency->GetMacDelay(i);
+        auto app = latency->GetAppDelay(i);
+        result.latencyPerClient.push_back({mac.p50, mac.p99, mac.p999, app.p50, app.p99, app.p999});
+        std::cout << "Client[" << i << "] delay (ms): MAC p50=" << mac.p50 << " p99=" << mac.p99
+                  << " p99.9=" << mac.p999 << ", application p50=" << app.p50
+                  << " p99=" << app.p99 << " p99.9=" << app.p999 << std::endl;
+    }
+
+    for (std::size_t i = 0; i < result.airtimePerClient.size(); i++)
+    {
+        const auto& airtime = result.airtimePerClient[i];
+        std::cout << "Client[" << i << "] airtime (us): DL MU=" << airtime[0]
+                  << " UL TB=" << airtime[1] << " BSRP=" << airtime[2] << " SU=" << airtime[3]
+                  << std::endl;
+    }
+
+    Simulator::Destroy();
+
+    std::cout << mcs << "\t\t" << channelWidth << " MHz\t\t" << gi << " ns\t\t"
+              << result.throughput << " Mbit/s\t" << "(Total)\n" << std::endl;
+    //* Printed after the flush scheduled at the destruction of the simulator
+    FlushAsyncLog(&std::cout);
+    return result;
+}
+
+/**
+ * Add the command line options (which are also the keys of the scenario files).
+ *
+ * \param cmd the command line
+ * \param cfg the experiment knobs the options are bound to
+ */
+static void
+AddOptions(CommandLine& cmd, SawConfig& cfg)
+{
     cmd.AddValue("clients",
-                 "Number of non-AP devices",
-                 clients);
+                 "Number of non-AP devices (per AP)",
+                 cfg.clients);
     cmd.AddValue("frequency",
                  "Whether working in the 2.4, 5 or 6 GHz band (other values gets rejected)",
-                 frequency);
+                 cfg.frequency);
     cmd.AddValue("distance",
                  "Distance in meters between the station and the access point",
-                 distance);
-    cmd.AddValue("simulationTime", "Simulation time in seconds", simulationTime);
-    cmd.AddValue("udp", "UDP if set to 1, TCP otherwise", udp);
+                 cfg.distance);
+    cmd.AddValue("simulationTime", "Simulation time in seconds", cfg.simulationTime);
+    cmd.AddValue("udp", "UDP if set to 1, TCP otherwise", cfg.udp);
     cmd.AddValue("downlink",
                  "Generate downlink flows if set to 1, uplink flows otherwise",
-                 downlink);
-    cmd.AddValue("useRts", "Enable/disable RTS/CTS", useRts);
-    cmd.AddValue("useExtendedBlockAck", "Enable/disable use of extended BACK", useExtendedBlockAck);
-    cmd.AddValue("nStations", "Number of non-AP HE stations", clients);
+                 cfg.downlink);
+    cmd.AddValue("useRts", "Enable/disable RTS/CTS", cfg.useRts);
+    cmd.AddValue("useExtendedBlockAck", "Enable/disable use of extended BACK", cfg.useExtendedBlockAck);
+    cmd.AddValue("nStations", "Number of non-AP HE stations", cfg.clients);
     //* ACK sequnce shouldn't matter for the attack.
     cmd.AddValue("dlAckType",
                  "Ack sequence type for DL OFDMA (NO-OFDMA, ACK-SU-FORMAT, MU-BAR, AGGR-MU-BAR)",
-                 dlAckSeqType);
+                 cfg.dlAckSeqType);
     cmd.AddValue("enableUlOfdma",
                  "Enable UL OFDMA (useful if DL OFDMA is enabled and TCP is used)",
-                 enableUlOfdma);
+                 cfg.enableUlOfdma);
+    cmd.AddValue("useCentral26TonesRus",
+                 "Also allocate the central 26-tone RUs left idle by equal-sized RUs of 52 tones "
+                 "or more",
+                 cfg.useCentral26TonesRus);
+    cmd.AddValue("muUsers",
+                 "Maximum number of stations served by a MU PPDU; 0 derives it from the width "
+                 "allowed at each scheduling decision (all the 26-tone RUs)",
+                 cfg.muUsers);
     cmd.AddValue("enableBsrp",
                  "Enable BSRP (useful if DL and UL OFDMA are enabled and TCP is used)",
-                 enableBsrp);
+                 cfg.enableBsrp);
     cmd.AddValue(
         "muSchedAccessReqInterval",
         "Duration of the interval between two requests for channel access made by the MU scheduler",
-        accessReqInterval);
-    cmd.AddValue("mcs", "if set, limit testing to a specific MCS (0-11)", mcs);
-    cmd.AddValue("payloadSize", "The application payload size in bytes", payloadSize);
+        cfg.accessReqInterval);
+    cmd.AddValue("mcs", "if set, limit testing to a specific MCS (0-11)", cfg.mcs);
+    cmd.AddValue("payloadSize", "The application payload size in bytes", cfg.payloadSize);
     cmd.AddValue("phyModel",
-                 "PHY model to use when OFDMA is disabled (Yans or Spectrum). If OFDMA is enabled "
-                 "then Spectrum is automatically selected",
-                 phyModel);
+                 "PHY model (Yans, Spectrum or Abstract). If OFDMA is enabled then Yans is "
+                 "replaced by Spectrum. Abstract is a Spectrum PHY for scheduler studies with a "
+                 "table-driven error model (see also isolateClients)",
+                 cfg.phyModel);
     cmd.AddValue("minExpectedThroughput",
                  "if set, simulation fails if the lowest throughput is below this value",
-                 minExpectedThroughput);
+                 cfg.minExpectedThroughput);
     cmd.AddValue("maxExpectedThroughput",
                  "if set, simulation fails if the highest throughput is above this value",
-                 maxExpectedThroughput);
-    cmd.Parse(argc, argv);
+                 cfg.maxExpectedThroughput);
+    cmd.AddValue("sampleInterval",
+                 "Window of the periodic throughput/goodput sampler (0 disables the sampler)",
+                 cfg.sampleInterval);
+    cmd.AddValue("warmup",
+                 "Warm-up time in seconds excluded from the sampler statistics",
+                 cfg.warmup);
+    cmd.AddValue("ciTarget",
+                 "If set, stop as soon as the relative half-width of the 95% batch-means "
+                 "confidence interval on the aggregate goodput is below this value",
+                 cfg.ciTarget);
+    cmd.AddValue("ciBatchWindows", "Number of sampler windows per batch", cfg.ciBatchWindows);
+    cmd.AddValue("ciMinBatches", "Minimum number of batches before stopping early", cfg.ciMinBatches);
+    cmd.AddValue("convergenceWindows",
+                 "If set, stop as soon as the mean goodput of the last this many sampler "
+                 "windows differs by less than convergenceThreshold from the mean of the "
+                 "windows before them",
+                 cfg.convergenceWindows);
+    cmd.AddValue("convergenceThreshold",
+                 "Relative change below which the goodput is considered converged",
+                 cfg.convergenceThreshold);
+    cmd.AddValue("convergencePerClient",
+                 "Require every client (and not only the aggregate) to converge",
+                 cfg.convergencePerClient);
+    cmd.AddValue("runNumber", "RNG run number of the (first) replication", cfg.runNumber);
+    cmd.AddValue("replications",
+                 "Number of independent RNG runs of each sweep point (run in parallel)",
+                 cfg.replications);
+    cmd.AddValue("jobs",
+                 "Maximum number of concurrent replication workers (0 means one per core)",
+                 cfg.jobs);
+    cmd.AddValue("nAps", "Number of BSSs, each with `clients` stations, on a shared channel", cfg.nAps);
+    cmd.AddValue("layout",
+                 "Placement of the stations around their AP: line (all at `distance`), disc "
+                 "(uniform within `distance`), ring (evenly spaced at `distance`) or grid",
+                 cfg.layout);
+    cmd.AddValue("apSpacing", "Distance in meters between neighboring APs", cfg.apSpacing);
+    cmd.AddValue("enablePcap", "Capture the traffic of the (first) AP in ap.pcap", cfg.enablePcap);
+    cmd.AddValue("traffic",
+                 "Per-client traffic models, e.g., \"0:saturated;1-3:video[Rate=8Mb/s];*:onoff\". "
+                 "Models: onoff, cbr, flood (UDP only), bursty, video, trace[FileName=...] and "
+                 "saturated. If empty, \"*:flood\" with UDP and \"0:cbr;*:onoff\" with TCP",
+                 cfg.traffic);
+    cmd.AddValue("memProfile",
+                 "Break the memory per station down by component (nodes, devices, stack, "
+                 "applications, scheduler, ...)",
+                 cfg.memProfile);
+    cmd.AddValue("channelWidth",
+                 "Channel width in MHz (20, 40, 80 or 160); 0 sweeps all the widths of the band",
+                 cfg.totalChannelWidth);
+    cmd.AddValue("gi", "Guard interval in nanoseconds (800, 1600 or 3200)", cfg.gi_nanosec);
+    cmd.AddValue("basePort", "Port of the sink of the first client (one port per client)", cfg.basePort);
+    cmd.AddValue("clientStart",
+                 "Start time of the clients in seconds (-1: 1 s with UDP, 0.5 s with TCP)",
+                 cfg.clientStart);
+    cmd.AddValue("scenario",
+                 "Scenario file (topology, traffic, simulation, scheduler and sweep sections); "
+                 "the command line options override the ones of the scenario",
+                 cfg.scenario);
+    cmd.AddValue("job", "Job of the scenario to run (-1 runs all of them in sequence)", cfg.job);
+    cmd.AddValue("listJobs", "List the jobs of the scenario and exit", cfg.listJobs);
+    cmd.AddValue("cache",
+                 "Reuse the results of the runs simulated before with the same configuration "
+                 "and the same build of the simulator, and store the new ones",
+                 cfg.cache);
+    cmd.AddValue("cacheDir", "Directory of the result cache", cfg.cacheDir);
+    cmd.AddValue("latency",
+                 "Record the per-client MAC and application delays in fixed-memory histograms "
+                 "(p50, p99 and p99.9 in rr_latency, application delays also in rr_tputs)",
+                 cfg.latency);
+    cmd.AddValue("attack",
+                 "Per-client misbehaviors, e.g., \"0-1:bsr;2:trigger\", or a single one for the "
+                 "first `attackers` clients. Misbehaviors: bsr (inflated buffer status reports), "
+                 "skip (alternately empty and inflated reports), trigger (ignored Trigger Frames) "
+                 "and ba (withheld Block Ack agreements)",
+                 cfg.attack);
+    cmd.AddValue("attackers", "Number of clients with a single `attack` misbehavior", cfg.attackers);
+    cmd.AddValue("attackPeriod",
+                 "Period of the skip misbehavior (empty reports during the first half)",
+                 cfg.attackPeriod);
+    cmd.AddValue("latencyTargets",
+                 "Per-client latency targets of the MU scheduler, e.g., \"0-1:5ms;4:20ms\", "
+                 "overriding its LatencyTarget attribute for these clients",
+                 cfg.latencyTargets);
+    cmd.AddValue("linkBudgetCache",
+                 "Compute the propagation loss of each link once rather than at every "
+                 "transmission (the results are the same)",
+                 cfg.linkBudgetCache);
+    cmd.AddValue("maxLossDb",
+                 "Reduced fidelity with the Spectrum PHY: the links with a larger loss in dB are "
+                 "neither received nor counted as interference (0 simulates all of them)",
+                 cfg.maxLossDb);
+    cmd.AddValue("isolateClients",
+                 "With the Abstract PHY, remove the links between the stations: a TB PPDU is "
+                 "then only received by the APs, which is faster, but the stations no longer "
+                 "sense each other (no EDCA deferral nor hidden-node collisions between them)",
+                 cfg.isolateClients);
+    cmd.AddValue("profile",
+                 "Attribute the wall-clock time and the number of the events to their handlers, "
+                 "grouped by subsystem, and write them as folded stacks for flame graphs "
+                 "(rr_profile and rr_profile_events)",
+                 cfg.profile);
+    cmd.AddValue("schedTrace",
+                 "Write the outcome of every UL MU station selection to rr_sched",
+                 cfg.schedTrace);
+    cmd.AddValue("cacheInspect", "List the entries of the result cache and exit", cfg.cacheInspect);
+    cmd.AddValue("cacheEvict",
+                 "Remove the entries of the result cache matching the filter and exit: \"*\" "
+                 "(all), \"stale\" (other builds) or key=value tokens, e.g., \"clients=8 mcs=2\"",
+                 cfg.cacheEvict);
+    cmd.AddValue("asyncLog",
+                 "Write the console output and the data files from a background thread, so that "
+                 "the simulation does not block on the terminal, pipe or disk. The lines not "
+                 "written yet are lost if the program aborts",
+                 cfg.asyncLog);
+    cmd.AddValue("asyncLogBuffer",
+                 "Size in KiB of the ring buffer of every output of asyncLog",
+                 cfg.asyncLogBuffer);
+    cmd.AddValue("asyncLogPolicy",
+                 "What to do with the console lines when the ring buffer of asyncLog is full: "
+                 "Block (wait for the writer) or Drop (discard them); the data files always "
+                 "block. Both are reported on stderr",
+                 cfg.asyncLogPolicy);
+}
+
+/**
+ * \param args the command line arguments
+ * \return the attribute defaults (--ns3::...) set on the command line
+ */
+static std::string
+GetAttributeArgs(const std::vector<std::string>& args)
+{
+    std::string attributeArgs;
+    for (const auto& arg : args)
+    {
+        if (arg.rfind("--ns3::", 0) == 0)
+        {
+            attributeArgs += arg + " ";
+        }
+    }
+    return attributeArgs;
+}
+
+/**
+ * Abort if the experiment knobs are invalid.
+ *
+ * \param cfg the experiment knobs
+ * \return false if the frequency is invalid (which is not an error, for backward compatibility)
+ */
+static bool
+ValidateConfig(const SawConfig& cfg)
+{
+    NS_ABORT_MSG_IF(cfg.convergenceWindows > 0 && !cfg.sampleInterval.IsStrictlyPositive(),
+                    "The convergence controller requires the periodic sampler (sampleInterval > 0)");
+    NS_ABORT_MSG_IF(cfg.replications == 0, "At least one replication is needed");
+    NS_ABORT_MSG_IF(cfg.nAps == 0 || cfg.nAps > 255, "The number of APs must be in [1, 255]");
+    NS_ABORT_MSG_IF(cfg.clients == 0 || cfg.clients > 65533,
+                    "The number of clients per AP must be in [1, 65533]");
+    NS_ABORT_MSG_IF(cfg.basePort + cfg.clients * cfg.nAps - 1 > 65535,
+                    "At most " << 65536 - cfg.basePort
+                               << " clients are supported (one sink port per client)");
+    NS_ABORT_MSG_IF(cfg.layout != "line" && cfg.layout != "disc" && cfg.layout != "ring" &&
+                        cfg.layout != "grid",
+                    "Invalid layout (must be line, disc, ring or grid)");
+    NS_ABORT_MSG_IF(cfg.totalChannelWidth != 0 && cfg.totalChannelWidth != 20 &&
+                        cfg.totalChannelWidth != 40 && cfg.totalChannelWidth != 80 &&
+                        cfg.totalChannelWidth != 160,
+                    "Invalid channel width (must be 0, 20, 40, 80 or 160)");
+    NS_ABORT_MSG_IF(cfg.gi_nanosec != 800 && cfg.gi_nanosec != 1600 && cfg.gi_nanosec != 3200,
+                    "Invalid guard interval (must be 800, 1600 or 3200)");
+    NS_ABORT_MSG_IF(cfg.muUsers > 74, "At most 74 stations can be served by a MU PPDU");
+    NS_ABORT_MSG_IF(cfg.dlAckSeqType != "NO-OFDMA" && cfg.dlAckSeqType != "ACK-SU-FORMAT" &&
+                        cfg.dlAckSeqType != "MU-BAR" && cfg.dlAckSeqType != "AGGR-MU-BAR",
+                    "Invalid DL ack sequence type (must be NO-OFDMA, ACK-SU-FORMAT, MU-BAR or "
+                    "AGGR-MU-BAR)");
+    NS_ABORT_MSG_IF(cfg.phyModel != "Yans" && cfg.phyModel != "Spectrum" &&
+                        cfg.phyModel != "Abstract",
+                    "Invalid PHY model (must be Yans, Spectrum or Abstract)");
+    ParseMisbehaviorSpec(cfg.attack, cfg.attackers, cfg.clients * cfg.nAps);
+    NS_ABORT_MSG_IF(!cfg.attackPeriod.IsStrictlyPositive(), "The attack period must be positive");
+    ParseLatencyTargetSpec(cfg.latencyTargets, cfg.clients * cfg.nAps);
+    if (!cfg.traffic.empty())
+    {
+        for (const auto& model : ParseTrafficSpec(cfg.traffic, cfg.clients * cfg.nAps))
+        {
+            NS_ABORT_MSG_IF(model.name == "flood" && !cfg.udp,
+                            "The flood model requires UDP (use saturated with TCP)");
+            NS_ABORT_MSG_IF(model.name == "saturated" && !cfg.udp && !model.params.empty(),
+                            "The saturated model has no parameters with TCP");
+        }
+    }
+    NS_ABORT_MSG_IF(!cfg.latencyTargets.empty() && cfg.dlAckSeqType == "NO-OFDMA",
+                    "Latency targets require an MU scheduler (dlAckType != NO-OFDMA)");
+    NS_ABORT_MSG_IF(cfg.maxLossDb < 0, "The maximum loss must be positive (or 0 to disable it)");
+    NS_ABORT_MSG_IF(cfg.isolateClients && cfg.phyModel != "Abstract",
+                    "isolateClients requires the Abstract PHY model");
+    AsyncLogWriter::ParsePolicy(cfg.asyncLogPolicy);
+    NS_ABORT_MSG_IF(cfg.asyncLogBuffer == 0, "The buffer of asyncLog must not be empty");
+
+    NS_ABORT_MSG_IF(!cfg.schedulerAttributes.empty() && cfg.dlAckSeqType == "NO-OFDMA",
+                    "Scheduler attributes require an MU scheduler (dlAckType != NO-OFDMA)");
+    auto tid = TypeId::LookupByName("ns3::RrMultiUserScheduler");
+    for (const auto& [name, value] : cfg.schedulerAttributes)
+    {
+        TypeId::AttributeInformation info;
+        NS_ABORT_MSG_IF(!tid.LookupAttributeByName(name, &info),
+                        "Unknown scheduler attribute: " << name);
+        NS_ABORT_MSG_IF(!(info.flags & TypeId::ATTR_SET),
+                        "Read-only scheduler attribute: " << name);
+        NS_ABORT_MSG_IF(!info.checker->CreateValidValue(StringValue(value)),
+                        "Invalid value for the scheduler attribute " << name << ": " << value);
+    }
+
+    if (cfg.frequency != 6 && cfg.frequency != 5 && cfg.frequency != 2.4)
+    {
+        std::cout << "Wrong frequency value!" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Run the sweep described by the experiment knobs and write the results.
+ *
+ * \param cfg the experiment knobs
+ * \param fileTag suffix of the output files (e.g., the job of a scenario)
+ * \param asyncLog the writer of the output files, nullptr to write them synchronously
+ * \return the exit code
+ */
+static int
+RunExperiment(SawConfig cfg, const std::string& fileTag, AsyncLogWriter* asyncLog)
+{
+
+    std::size_t nClients = cfg.clients * cfg.nAps;
+    std::string fileSuffix = std::to_string(nClients) + "ue";
+    if (cfg.nAps > 1)
+    {
+        fileSuffix += "_" + std::to_string(cfg.nAps) + "ap";
+    }
+    fileSuffix += fileTag;
 
-    std::string tputFilePath = "scratch/attacks/data/rr_tputs_" + std::to_string(clients) + "ue.csv";
-    std::ofstream tputFile(tputFilePath);
+    std::string tputFilePath = "scratch/attacks/data/rr_tputs_" + fileSuffix + ".csv";
+    AsyncLogStream tputFile(asyncLog, tputFilePath);
     if (!tputFile.is_open()) {
         std::cerr << "Failed to open the file: " << tputFilePath << std::endl;
         return 1;
     }
     // Write the header
-    tputFile << "mcs,channel_mhz,gi_ns,tput_mbps,origin,n_clients" << std::endl;
+    tputFile << "mcs,channel_mhz,gi_ns,tput_mbps,origin,n_clients,stop_s,"
+             << (cfg.latency ? "app_p50_ms,app_p99_ms,app_p999_ms," : "") << "replication"
+             << std::endl;
 
-    std::string schedFilePath = "scratch/attacks/data/rr_sched_" + std::to_string(clients) + "ue.csv";
-    std::ofstream schedFile(schedFilePath);
+    std::string schedFilePath = "scratch/attacks/data/rr_sched_" + fileSuffix + ".csv";
+    AsyncLogStream schedFile(asyncLog, schedFilePath);
     if (!schedFile.is_open()) {
         std::cerr << "Failed to open the file: " << schedFilePath << std::endl;
         return 1;
     }
     // Write the header
-    schedFile << "time_milli,total,unsolicited,schedule1,candidates,schedule2" << std::endl;
-    schedFile.close();
+    schedFile << "mcs,channel_mhz,gi_ns,ap,time_milli,total,unsolicited,schedule1,candidates,"
+                 "schedule2,replication" << std::endl;
+
+    //* Schedule-efficiency counters of every run
+    std::string schedStatsFilePath = "scratch/attacks/data/rr_sched_stats_" + fileSuffix + ".csv";
+    AsyncLogStream schedStatsFile(asyncLog, schedStatsFilePath);
+    if (!schedStatsFile.is_open()) {
+        std::cerr << "Failed to open the file: " << schedStatsFilePath << std::endl;
+        return 1;
+    }
+    schedStatsFile << "mcs,channel_mhz,gi_ns,n_aps,n_clients,decisions,trimmed_candidates,"
+                      "unsolicited_skips,no_tx_txop_too_short,no_tx_ul_too_short,"
+                      "no_tx_no_dl_frames,load_aware_changes,dl_mu_ppdus,aggregated_mpdus,"
+                      "bsr_anomalies,sized_tfs,tx_duration_hits,tx_duration_misses,secondary_psdus,"
+                      "secondary_mpdus,ru_utilization,bsrp_airtime_us,data_airtime_us,"
+                      "bsrp_data_ratio,load_aware_saved_us,aggregation_us_per_ppdu,"
+                      "padding_fraction,tf_sizing_us_per_tf,secondary_mpdus_per_psdu,replication"
+                   << std::endl;
+
+    //* Per-client delay percentiles of every run
+    std::string latencyFilePath = "scratch/attacks/data/rr_latency_" + fileSuffix + ".csv";
+    AsyncLogStream latencyFile(asyncLog);
+    if (cfg.latency) {
+        latencyFile.open(latencyFilePath);
+        if (!latencyFile.is_open()) {
+            std::cerr << "Failed to open the file: " << latencyFilePath << std::endl;
+            return 1;
+        }
+        latencyFile << "mcs,channel_mhz,gi_ns,origin,n_clients,mac_p50_ms,mac_p99_ms,"
+                       "mac_p999_ms,app_p50_ms,app_p99_ms,app_p999_ms,replication" << std::endl;
+    }
+
+    //* Per-client airtime ledger of every run, to be reconciled with the throughput
+    std::string airtimeFilePath = "scratch/attacks/data/rr_airtime_" + fileSuffix + ".csv";
+    AsyncLogStream airtimeFile(asyncLog);
+    if (cfg.dlAckSeqType != "NO-OFDMA") {
+        airtimeFile.open(airtimeFilePath);
+        if (!airtimeFile.is_open()) {
+            std::cerr << "Failed to open the file: " << airtimeFilePath << std::endl;
+            return 1;
+        }
+        airtimeFile << "mcs,channel_mhz,gi_ns,origin,n_clients,dl_mu_us,ul_tb_us,bsrp_us,su_us,"
+                       "airtime_share,tput_mbps,replication" << std::endl;
+    }
+
+    //* Per-window throughput/goodput time series streamed by the sampler
+    std::string seriesFilePath = "scratch/attacks/data/rr_series_" + fileSuffix + ".csv";
+    AsyncLogStream seriesFile(asyncLog);
+    if (cfg.sampleInterval.IsStrictlyPositive()) {
+        seriesFile.open(seriesFilePath);
+        if (!seriesFile.is_open()) {
+            std::cerr << "Failed to open the file: " << seriesFilePath << std::endl;
+            return 1;
+        }
+        seriesFile << "mcs,channel_mhz,gi_ns,time_milli,origin,tput_mbps,goodput_mbps,n_clients,replication" << std::endl;
+    }
+
+    //* Statistics across replications
+    std::string statsFilePath = "scratch/attacks/data/rr_tputs_stats_" + fileSuffix + ".csv";
+    AsyncLogStream statsFile(asyncLog);
+    if (cfg.replications > 1) {
+        statsFile.open(statsFilePath);
+        if (!statsFile.is_open()) {
+            std::cerr << "Failed to open the file: " << statsFilePath << std::endl;
+            return 1;
+        }
+        statsFile << "mcs,channel_mhz,gi_ns,origin,n_clients,replications,mean_mbps,stddev_mbps,"
+                     "min_mbps,p5_mbps,p50_mbps,p95_mbps,max_mbps" << std::endl;
+    }
+
+    //* Simulation speed and memory footprint of every run
+    std::string perfFilePath = "scratch/attacks/data/rr_perf_" + fileSuffix + ".csv";
+    AsyncLogStream perfFile(asyncLog, perfFilePath);
+    if (!perfFile.is_open()) {
+        std::cerr << "Failed to open the file: " << perfFilePath << std::endl;
+        return 1;
+    }
+    perfFile << "mcs,channel_mhz,gi_ns,n_aps,n_clients,layout,events,wall_s,events_per_s,"
+                "rss_kb_per_sta,peak_rss_kb,replication" << std::endl;
+
+    //* Memory per station of each component (memory profiling mode only)
+    std::string memFilePath = "scratch/attacks/data/rr_mem_" + fileSuffix + ".csv";
+    AsyncLogStream memFile(asyncLog);
+    if (cfg.memProfile) {
+        memFile.open(memFilePath);
+        if (!memFile.is_open()) {
+            std::cerr << "Failed to open the file: " << memFilePath << std::endl;
+            return 1;
+        }
+        memFile << "mcs,channel_mhz,gi_ns,n_aps,n_clients,component,kb_per_sta,replication" << std::endl;
+    }
+
+    //* Folded stacks of the event handlers for flame graphs, weighted by wall-clock time
+    //* (in ns) and by number of events (event profiling mode only)
+    std::string profileFilePath = "scratch/attacks/data/rr_profile_" + fileSuffix + ".folded";
+    std::string profileEventsFilePath =
+        "scratch/attacks/data/rr_profile_events_" + fileSuffix + ".folded";
+    AsyncLogStream profileFile(asyncLog);
+    AsyncLogStream profileEventsFile(asyncLog);
+    if (cfg.profile) {
+        profileFile.open(profileFilePath);
+        profileEventsFile.open(profileEventsFilePath);
+        if (!profileFile.is_open() || !profileEventsFile.is_open()) {
+            std::cerr << "Failed to open the file: " << profileFilePath << std::endl;
+            return 1;
+        }
+    }
     
-    std::cout << "\nOFDMA flag: " << enableUlOfdma << std::endl;
+    std::cout << "\nOFDMA flag: " << cfg.enableUlOfdma << std::endl;
 
-    if (enableUlOfdma) {
-        useRts = true;
+    if (cfg.enableUlOfdma) {
+        cfg.useRts = true;
     }
 
-    if (useRts)
+    if (cfg.useRts)
     {
         Config::SetDefault("ns3::WifiRemoteStationManager::RtsCtsThreshold", StringValue("0"));
         Config::SetDefault("ns3::WifiDefaultProtectionManager::EnableMuRts", BooleanValue(true));
     }
 
-    if (dlAckSeqType == "ACK-SU-FORMAT")
+    if (cfg.dlAckSeqType == "ACK-SU-FORMAT")
     {
         Config::SetDefault("ns3::WifiDefaultAckManager::DlMuAckSequenceType",
                            EnumValue(WifiAcknowledgment::DL_MU_BAR_BA_SEQUENCE));
     }
-    else if (dlAckSeqType == "MU-BAR")
+    else if (cfg.dlAckSeqType == "MU-BAR")
     {
         Config::SetDefault("ns3::WifiDefaultAckManager::DlMuAckSequenceType",
                            EnumValue(WifiAcknowledgment::DL_MU_TF_MU_BAR));
     }
-    else if (dlAckSeqType == "AGGR-MU-BAR")
+    else if (cfg.dlAckSeqType == "AGGR-MU-BAR")
     {
         Config::SetDefault("ns3::WifiDefaultAckManager::DlMuAckSequenceType",
                            EnumValue(WifiAcknowledgment::DL_MU_AGGREGATE_TF));
     }
-    else if (dlAckSeqType != "NO-OFDMA")
-    {
-        NS_ABORT_MSG("Invalid DL ack sequence type (must be NO-OFDMA, ACK-SU-FORMAT, MU-BAR or "
-                     "AGGR-MU-BAR)");
-    }
 
-    if (phyModel != "Yans" && phyModel != "Spectrum")
-    {
-        NS_ABORT_MSG("Invalid PHY model (must be Yans or Spectrum)");
-    }
-    if (dlAckSeqType != "NO-OFDMA")
+    if (cfg.dlAckSeqType != "NO-OFDMA" && cfg.phyModel != "Abstract")
     {
         // SpectrumWifiPhy is required for OFDMA
-        phyModel = "Spectrum";
+        cfg.phyModel = "Spectrum";
     }
 
+    std::vector<uint32_t> runs(cfg.replications);
+    std::iota(runs.begin(), runs.end(), cfg.runNumber);
+    std::size_t maxWorkers = (cfg.jobs > 0 ? cfg.jobs : std::max(1U, std::thread::hardware_concurrency()));
+    std::unique_ptr<ResultCache> cache;
+    if (cfg.cache)
+    {
+        cache = std::make_unique<ResultCache>(cfg.cacheDir);
+    }
 
     double prevThroughput[12] = {0};
 
@@ -180,449 +1761,209 @@ main(int argc, char* argv[])
     //           << "Throughput" << '\n';
     int minMcs = 0;
     int maxMcs = 11;
-    if (mcs >= 0 && mcs <= 11)
+    if (cfg.mcs >= 0 && cfg.mcs <= 11)
     {
-        minMcs = mcs;
-        maxMcs = mcs;
+        minMcs = cfg.mcs;
+        maxMcs = cfg.mcs;
     }
     for (int mcs = minMcs; mcs <= maxMcs; mcs++)
     {
         uint8_t index = 0;
         double previous = 0;
-        uint8_t maxChannelWidth = frequency == 2.4 ? 40 : 160;
+        uint8_t maxChannelWidth = cfg.frequency == 2.4 ? 40 : 160;
         int channelWidth = 20;
-        uint8_t nStations = 4;
-        if (totalChannelWidth > 0) {
-            maxChannelWidth = totalChannelWidth;
-            channelWidth = totalChannelWidth;
-            if (totalChannelWidth == 20) {
-                nStations = 8+1;
-                //! We have to take into account the central 26-tone RUs, even if they are not used.
-                //! Otherwise, min(nStations, STAs) will be always less than the # of first-level RUs (26-tones),
-                //! which will never be used in this case.
-                // if (useCentral26TonesRus)
-                //     nStations++;
-
-            } else if (totalChannelWidth == 40) {
-                nStations = 16+2;
-                // if (useCentral26TonesRus)
-                //     nStations += 2;
-            } else if (totalChannelWidth >= 80) {
-                nStations = 32+5;
-                // if (useCentral26TonesRus)
-                //     nStations += 5;
-            }
+        if (cfg.totalChannelWidth > 0) {
+            maxChannelWidth = cfg.totalChannelWidth;
+            channelWidth = cfg.totalChannelWidth;
         }
 
         while (channelWidth <= maxChannelWidth) // MHz
         {
             // for (int gi = 3200; gi >= 800;) // Nanoseconds
-            for (int gi = gi_nanosec; gi >= gi_nanosec;) // Nanoseconds
+            for (int gi = cfg.gi_nanosec; gi >= cfg.gi_nanosec;) // Nanoseconds
             {
-                if (!udp)
-                {
-                    Config::SetDefault("ns3::TcpSocket::SegmentSize", UintegerValue(payloadSize));
-                }
-
-                NodeContainer wifiStaNodes;
-                wifiStaNodes.Create(clients);
-                NodeContainer wifiApNode;
-                wifiApNode.Create(1);
-
-                WifiMacHelper mac;
-                WifiHelper wifi;
-                std::string channelStr("{0, " + std::to_string(channelWidth) + ", ");
-                StringValue ctrlRate;
-                auto nonHtRefRateMbps = HePhy::GetNonHtReferenceRate(mcs) / 1e6;
-
-                std::ostringstream ossDataMode;
-                ossDataMode << "HeMcs" << mcs;
-
-                if (frequency == 6)
-                {
-                    ctrlRate = StringValue(ossDataMode.str());
-                    channelStr += "BAND_6GHZ, 0}";
-                    Config::SetDefault("ns3::LogDistancePropagationLossModel::ReferenceLoss",
-                                       DoubleValue(48));
-                }
-                else if (frequency == 5)
-                {
-                    std::ostringstream ossControlMode;
-                    ossControlMode << "OfdmRate" << nonHtRefRateMbps << "Mbps";
-                    ctrlRate = StringValue(ossControlMode.str());
-                    channelStr += "BAND_5GHZ, 0}";
-                }
-                else if (frequency == 2.4)
+                //* Only the runs missing from the cache are simulated
+                std::vector<std::string> outputs(runs.size());
+                std::vector<std::string> keys(runs.size());
+                std::vector<uint32_t> missingRuns;
+                std::vector<std::size_t> missing;
+                for (std::size_t r = 0; r < runs.size(); r++)
                 {
-                    std::ostringstream ossControlMode;
-                    ossControlMode << "ErpOfdmRate" << nonHtRefRateMbps << "Mbps";
-                    ctrlRate = StringValue(ossControlMode.str());
-                    channelStr += "BAND_2_4GHZ, 0}";
-                    Config::SetDefault("ns3::LogDistancePropagationLossModel::ReferenceLoss",
-                                       DoubleValue(40));
-                }
-                else
-                {
-                    std::cout << "Wrong frequency value!" << std::endl;
-                    return 0;
-                }
-
-                wifi.SetStandard(WIFI_STANDARD_80211ax);
-                Ssid ssid = Ssid("ns3-80211ax");
-
-                wifi.SetRemoteStationManager("ns3::ConstantRateWifiManager",
-                                             "DataMode",
-                                             StringValue(ossDataMode.str()),
-                                             "ControlMode",
-                                             ctrlRate);
-                // Set guard interval and MPDU buffer size
-                wifi.ConfigHeOptions("GuardInterval",
-                                     TimeValue(NanoSeconds(gi)),
-                                     "MpduBufferSize",
-                                     UintegerValue(useExtendedBlockAck ? 256 : 64));
-
-                NetDeviceContainer apDevice;
-                NetDeviceContainer staDevices;
-                if (phyModel == "Spectrum")
-                {
-                    Ptr<MultiModelSpectrumChannel> spectrumChannel =
-                        CreateObject<MultiModelSpectrumChannel>();
-                    Ptr<LogDistancePropagationLossModel> lossModel =
-                        CreateObject<LogDistancePropagationLossModel>();
-
-                    spectrumChannel->AddPropagationLossModel(lossModel);
-                    
-                    SpectrumWifiPhyHelper phy;
-                    phy.SetPcapDataLinkType(WifiPhyHelper::DLT_IEEE802_11_RADIO);
-                    phy.SetChannel(spectrumChannel);
-
-                    mac.SetType("ns3::StaWifiMac", "Ssid", SsidValue(ssid),
-                        "ActiveProbing", BooleanValue(false)
-                        // "PsMode", StringValue("SLEEP")
-                        // "QosSupported", BooleanValue(true),
-                    );
-                    phy.Set("ChannelSettings", StringValue(channelStr));
-                    staDevices = wifi.Install(phy, mac, wifiStaNodes);
-
-                    if (dlAckSeqType != "NO-OFDMA")
+                    if (cache)
                     {
-                        //* Configure the WiFi 6 scheduler.
-                        mac.SetMultiUserScheduler("ns3::RrMultiUserScheduler",
-                                                  "EnableUlOfdma",
-                                                  BooleanValue(enableUlOfdma),
-                                                  "EnableBsrp",
-                                                  BooleanValue(enableBsrp),
-                                                  "AccessReqInterval",
-                                                  TimeValue(accessReqInterval),
-                                                  "UseCentral26TonesRus",
-                                                  BooleanValue(useCentral26TonesRus)
-                                                  ,"NStations",
-                                                  UintegerValue(nStations)
-                                                  );
+                        auto description = DescribeRun(cfg, mcs, channelWidth, gi, runs[r]);
+                        keys[r] = cache->GetKey(description);
+                        if (cache->Lookup(keys[r], description, outputs[r]))
+                        {
+                            continue;
+                        }
                     }
-                    mac.SetType("ns3::ApWifiMac",
-                                "EnableBeaconJitter",
-                                BooleanValue(false),
-                                "Ssid",
-                                SsidValue(ssid));
-                    apDevice = wifi.Install(phy, mac, wifiApNode);
-
-                    // phy.EnablePcap("attacker", staDevices.Get(0), true);
-                    phy.EnablePcap("ap.pcap", apDevice.Get(0), true, true);
-                    // phy.EnablePcapAll("all", true);
-                    // AsciiTraceHelper ascii;
-                    // phy.EnableAsciiAll(ascii.CreateFileStream("wifi-trace.tr"));
-                    // LogComponentEnable("WifiMac", LOG_LEVEL_ALL);
-                    // LogComponentEnable("OnOffApplication", LOG_LEVEL_ALL);
-
-                    //! Doesn't work w/o adjusting associated link IDs 
-                    // //* Change  MAC addresses for clients
-                    // for (uint32_t i = 0; i < clients; ++i) {
-                    //     std::string macAddress = "00:00:00:00:00:C" + std::to_string(i+1);
-                    //     // wifiStaNodes.Get(i)->GetDevice(0)->GetObject<WifiNetDevice>()->SetAddress(Mac48Address(macAddress.c_str()));
-                    //     Ptr<NetDevice> dev = staDevices.Get(i);
-                    //     Ptr<WifiNetDevice> wifiDev = dev->GetObject<WifiNetDevice>();
-                    //     wifiDev->SetAddress(Mac48Address(macAddress.c_str()));
-                    // }
-                    // //* Change MAC address for the AP
-                    // wifiApNode.Get(0)->GetObject<Node>()->GetDevice(0)
-                    //     ->GetObject<WifiNetDevice>()->SetAddress(Mac48Address("00:00:00:00:00:AA"));
-                    // Ptr<NetDevice> dev = apDevice.Get(0);
-                    // Ptr<WifiNetDevice> wifiDev = dev->GetObject<WifiNetDevice>();
-                    // wifiDev->SetAddress(Mac48Address("00:00:00:00:00:0A"));
+                    missingRuns.push_back(runs[r]);
+                    missing.push_back(r);
                 }
-                else
+                if (cache)
                 {
-                    // //* Disable frame aggregation.
-                    // Config::SetDefault("ns3::WifiMac::BE_MaxAmpduSize", UintegerValue(0));
-                    YansWifiChannelHelper channel = YansWifiChannelHelper::Default();
-                    YansWifiPhyHelper phy;
-                    phy.SetPcapDataLinkType(WifiPhyHelper::DLT_IEEE802_11_RADIO);
-                    phy.SetChannel(channel.Create());
-
-
-                    mac.SetType("ns3::StaWifiMac", "Ssid", SsidValue(ssid)
-                        // "ActiveProbing", BooleanValue(false),
-                        // "QosSupported", BooleanValue(true),
-                    );
-                    phy.Set("ChannelSettings", StringValue(channelStr));
-                    staDevices = wifi.Install(phy, mac, wifiStaNodes);
-
-                    mac.SetType("ns3::ApWifiMac",
-                                "EnableBeaconJitter",
-                                BooleanValue(false),
-                                "Ssid",
-                                SsidValue(ssid));
-                    apDevice = wifi.Install(phy, mac, wifiApNode);
-                    
-                    // phy.EnablePcap("ap.pcap", staDevices.Get(0), true, true);
-                    phy.EnablePcap("ap.pcap", apDevice.Get(0), true, true);
-                    // phy.EnablePcapAll("all", true);
-                    // AsciiTraceHelper ascii;
-                    // phy.EnableAsciiAll(ascii.CreateFileStream("wifi-trace.tr"));
-                    // LogComponentEnable("WifiMac", LOG_LEVEL_ALL);
-                    // LogComponentEnable("OnOffApplication", LOG_LEVEL_ALL);
+                    std::cout << mcs << "\t\t" << channelWidth << " MHz\t\t" << gi << " ns\t\t"
+                              << runs.size() - missing.size() << " of " << runs.size()
+                              << " runs from the cache" << std::endl;
                 }
 
-                RngSeedManager::SetSeed(1);
-                RngSeedManager::SetRun(1);
-                int64_t streamNumber = 42;
-                streamNumber += wifi.AssignStreams(apDevice, streamNumber);
-                streamNumber += wifi.AssignStreams(staDevices, streamNumber);
-
-                // Mobility:
-                //* Set the position of the AP at (0,0,0)
-                MobilityHelper mobilityAp;
-                Ptr<ListPositionAllocator> positionAllocAp = CreateObject<ListPositionAllocator>();
-                positionAllocAp->Add(Vector(0.0, 0.0, 0.0)); // Position of the AP
-                mobilityAp.SetPositionAllocator(positionAllocAp);
-                mobilityAp.SetMobilityModel("ns3::ConstantPositionMobilityModel");
-                mobilityAp.Install(wifiApNode);
-
-                //* Set the position of each client device at (distance, 0, 0)
-                MobilityHelper mobilitySta;
-                Ptr<ListPositionAllocator> positionAllocSta = CreateObject<ListPositionAllocator>();
-                for (uint32_t i = 0; i < clients; ++i)
+                if (cfg.replications == 1 && missing.size() == 1)
                 {
-                    positionAllocSta->Add(Vector(distance, 0.0, 0.0)); // Position each client at (distance, 0, 0)
+                    std::ostringstream series;
+                    auto result = RunSweepPoint(cfg, mcs, channelWidth, gi, runs[0], series);
+                    outputs[0] = SerializePointResult(result, series.str());
                 }
-                mobilitySta.SetPositionAllocator(positionAllocSta);
-                mobilitySta.SetMobilityModel("ns3::ConstantPositionMobilityModel");
-                mobilitySta.Install(wifiStaNodes);
-
-                /* Internet stack*/
-                InternetStackHelper stack;
-                stack.Install(wifiApNode);
-                stack.Install(wifiStaNodes);
-
-                Ipv4AddressHelper address;
-                address.SetBase("10.0.0.0", "255.255.255.0");
-                // * The 1st client is 10.0.0.1
-                Ipv4InterfaceContainer staNodeInterfaces = address.Assign(staDevices);
-                Ipv4InterfaceContainer apNodeInterface = address.Assign(apDevice);
-
-                //* Manually set the AP node's IP address to 10.0.0.254
-                Ptr<Ipv4> ipv4 = wifiApNode.Get(0)->GetObject<Ipv4>();
-                int32_t interfaceIndex = ipv4->GetInterfaceForDevice(apDevice.Get(0));
-                ipv4->RemoveAddress(interfaceIndex, 0);  // Remove the assigned IP
-                ipv4->AddAddress(interfaceIndex, Ipv4InterfaceAddress("10.0.0.254", "255.255.255.0"));
-                ipv4->SetMetric(interfaceIndex, 1);  // Optional: set the metric if needed
-                ipv4->SetUp(interfaceIndex);
-
-                /* Setting applications */
-                // ApplicationContainer serverApp;
-                auto serverNodes = downlink ? std::ref(wifiStaNodes) : std::ref(wifiApNode);
-                
-                Ipv4InterfaceContainer serverInterfaces;
-                NodeContainer clientNodes;
-                for (std::size_t i = 0; i < clients; i++)
+                else if (!missing.empty())
                 {
-                    if (downlink) {
-                        serverInterfaces.Add(staNodeInterfaces.Get(i));
-                        clientNodes.Add(wifiApNode.Get(0));
-                    } else {
-                        // Directly use the manually assigned AP address
-                        serverInterfaces.Add(apNodeInterface.Get(0));
-                        clientNodes.Add(wifiStaNodes.Get(i));
+                    //* Each replication runs in its own worker process
+                    auto simulated = RunReplications(missingRuns, maxWorkers, [&](uint32_t run) {
+                        std::cout.setstate(std::ios::failbit); // keep the console readable
+                        std::ostringstream series;
+                        auto result = RunSweepPoint(cfg, mcs, channelWidth, gi, run, series);
+                        return SerializePointResult(result, series.str());
+                    });
+                    for (std::size_t m = 0; m < missing.size(); m++)
+                    {
+                        outputs[missing[m]] = simulated[m];
                     }
                 }
-                // std::cout << "Total clients: " << clientNodes.GetN() << std::endl;
-                // std::cout << "Total servers: " << serverNodes.() << std::endl;
-
-                std::vector<ApplicationContainer> serverApps(clients); // Store each server app for each client
-                ApplicationContainer serverApp;
-                std::cout << "MCS value"
-                    << "\t"
-                    << "Channel width"
-                    << "\t"
-                    << "GI" // Guard interval.
-                    << "\t\t"
-                    << "Throughput" 
-                    << "\t\n";
-
-                if (udp)
+                for (auto r : missing)
                 {
-                    // UDP flow
-                    uint16_t port = 9;
-                    UdpServerHelper server(port);
-                    // * Install one sink for all clients in case of UDP for now.
-                    serverApps[0] = server.Install(serverNodes.get());
-                    serverApps[0].Start(Seconds(0.0));
-                    serverApps[0].Stop(Seconds(simulationTime + 1));
-
-                    for (std::size_t i = 0; i < clients; i++)
+                    if (cache)
                     {
-                        UdpClientHelper client(serverInterfaces.GetAddress(i), port);
-                        client.SetAttribute("MaxPackets", UintegerValue(4294967295U));
-                        client.SetAttribute("Interval", TimeValue(Time("0.00001"))); // packets/s
-                        client.SetAttribute("PacketSize", UintegerValue(payloadSize));
-                        ApplicationContainer clientApp = client.Install(clientNodes.Get(i));
-                        clientApp.Start(Seconds(1.0));
-                        clientApp.Stop(Seconds(simulationTime + 1));
+                        cache->Store(keys[r],
+                                     DescribeRun(cfg, mcs, channelWidth, gi, runs[r]),
+                                     outputs[r]);
                     }
                 }
-                else
-                {   
-                    // std::cout << "Setting up AP: " << apNodeInterface.GetAddress(0) << std::endl;
-                    // uint16_t port = 50000;
-                    // Address localAddress(InetSocketAddress(Ipv4Address::GetAny(), port));
-                    // PacketSinkHelper packetSinkHelper("ns3::TcpSocketFactory", localAddress);
-                    // serverApp = packetSinkHelper.Install(serverNodes.get());
-                    // serverApp.Start(Seconds(0.0));
-                    // serverApp.Stop(Seconds(simulationTime + 1));
-
-                    //* TCP flows
-                    std::vector<uint16_t> ports(clients);
-                    for (std::size_t i = 0; i < clients; i++) {
-                        //* Assign a unique port to each client on the AP
-                        ports[i] = 50000 + i;
-                        Address localAddress(InetSocketAddress(Ipv4Address::GetAny(), ports[i]));
-                        PacketSinkHelper packetSinkHelper("ns3::TcpSocketFactory", localAddress);
-                        //* Install a PacketSink on the server for each unique port
-                        serverApps[i] = packetSinkHelper.Install(serverNodes.get());
-                        serverApps[i].Start(Seconds(0.0));
-                        serverApps[i].Stop(Seconds(simulationTime + 1));
-
-                        //* Client setup
-                        std::cout << "Setting up Client[" << i << "]: " << staNodeInterfaces.GetAddress(i) << std::endl;
-                        OnOffHelper onoff("ns3::TcpSocketFactory", Ipv4Address::GetAny());
-                        std::string onTimeType = "ns3::ExponentialRandomVariable[Mean=0.5]";
-                        std::string offTimeType = "ns3::ExponentialRandomVariable[Mean=0.5]";
-                        if (i == 0) {
-                            onTimeType = "ns3::ConstantRandomVariable[Constant=1]";
-                            offTimeType = "ns3::ConstantRandomVariable[Constant=0]";
-                        } 
-                        // //* Each STA can have different OnTime/OffTime patterns
-                        // if (i == 0) {
-                        //     onTimeType = "ns3::ConstantRandomVariable[Constant=0.5]";
-                        //     offTimeType = "ns3::ConstantRandomVariable[Constant=0.5]";
-                        // } else if (i == 1) {
-                        //     onTimeType = "ns3::UniformRandomVariable[Min=0.1|Max=1.0]";
-                        //     offTimeType = "ns3::UniformRandomVariable[Min=0.5|Max=2.0]";
-                        // } else if (i == 2) {
-                        //     onTimeType = "ns3::ExponentialRandomVariable[Mean=2]";
-                        //     offTimeType = "ns3::ExponentialRandomVariable[Mean=0.5]";
-                        // } else {
-                        //     //* Always on.
-                        //     onTimeType = "ns3::ConstantRandomVariable[Constant=1]";
-                        //     offTimeType = "ns3::ConstantRandomVariable[Constant=0]";
-                            
-                        // }
-                        onoff.SetAttribute("OnTime", StringValue(onTimeType));
-                        onoff.SetAttribute("OffTime", StringValue(offTimeType));
-                        onoff.SetAttribute("PacketSize", UintegerValue(payloadSize));
-                        //* 20MHz channel with 1-8 STAs (3.2us GI, MCS 2)
-                        //*  26-tone: 2.3Mbps; 52-tone: 4.5Mbps, 106-tone: 9.6Mbps, 242-tone: 21.9Mbps
-                        std::string dataRate = "2Mb/s";
-                        // if (i == 0) {
-                        //     dataRate = "6Mb/s";
-                        // }
-                        onoff.SetAttribute("DataRate", DataRateValue(dataRate));
-                        //* Maching the ports assigned on the server slide
-                        // AddressValue remoteAddress(InetSocketAddress(serverInterfaces.GetAddress(0), port));
-                        AddressValue remoteAddress(InetSocketAddress(serverInterfaces.GetAddress(0), ports[i]));
-                        onoff.SetAttribute("Remote", remoteAddress);
-                        
-                        ApplicationContainer clientApp = onoff.Install(clientNodes.Get(i));
-                        clientApp.Start(Seconds(0.5));
-                        clientApp.Stop(Seconds(simulationTime + 1));
-                    }
 
-                    // // TCP flow
-                    // uint16_t port = 50000;
-                    // Address localAddress(InetSocketAddress(Ipv4Address::GetAny(), port));
-                    // PacketSinkHelper packetSinkHelper("ns3::TcpSocketFactory", localAddress);
-                    // serverApp = packetSinkHelper.Install(serverNodes.get());
-                    // serverApp.Start(Seconds(0.0));
-                    // serverApp.Stop(Seconds(simulationTime + 1));
-
-                    // for (std::size_t i = 0; i < nStations; i++)
-                    // {
-                    //     OnOffHelper onoff("ns3::TcpSocketFactory", Ipv4Address::GetAny());
-                    //     onoff.SetAttribute("OnTime",
-                    //                        StringValue("ns3::ConstantRandomVariable[Constant=1]"));
-                    //     onoff.SetAttribute("OffTime",
-                    //                        StringValue("ns3::ConstantRandomVariable[Constant=0]"));
-                    //     onoff.SetAttribute("PacketSize", UintegerValue(payloadSize));
-                    //     std::string dataRate = "1GB/s";
-                    //     onoff.SetAttribute("DataRate", DataRateValue(dataRate));// DataRateValue(1000000000)); // bit/s (125MB/s)
-                    //     // onoff.SetAttribute("DataRate", DataRateValue(1000000000)); // bit/s (125MB/s)
-                    //     AddressValue remoteAddress(
-                    //         InetSocketAddress(serverInterfaces.GetAddress(i), port));
-                    //     onoff.SetAttribute("Remote", remoteAddress);
-                    //     ApplicationContainer clientApp = onoff.Install(clientNodes.Get(i));
-                    //     clientApp.Start(Seconds(1.0));
-                    //     clientApp.Stop(Seconds(simulationTime + 1));
-                    // }
+                std::vector<PointResult> results;
+                for (const auto& output : outputs)
+                {
+                    std::string series;
+                    results.push_back(DeserializePointResult(output, series));
+                    seriesFile << series;
                 }
 
-                Simulator::Schedule(Seconds(0), &Ipv4GlobalRoutingHelper::PopulateRoutingTables);
-                Simulator::Stop(Seconds(simulationTime + 1));
-                Simulator::Run();
-
-                uint64_t totalRxBytes = 0;
-                if (udp)
+                for (std::size_t r = 0; r < results.size(); r++)
                 {
-                    for (uint32_t i = 0; i < serverApps[0].GetN(); i++)
+                    for (std::size_t i = 0; i < results[r].tputPerClient.size(); i++)
                     {
-                        totalRxBytes +=
-                            payloadSize * DynamicCast<UdpServer>(serverApps[0].Get(i))->GetReceived();
+                        tputFile << mcs << "," 
+                            << channelWidth << "," 
+                            << gi << "," 
+                            << results[r].tputPerClient[i] << "," 
+                            << GetClientLabel(cfg, i) << "," 
+                            << nClients << ","
+                            << results[r].stopTime << ",";
+                        //* End-to-end delay percentiles beside the throughput
+                        if (cfg.latency)
+                        {
+                            const auto& delays = results[r].latencyPerClient.at(i);
+                            tputFile << delays[3] << "," << delays[4] << "," << delays[5] << ",";
+                        }
+                        tputFile << runs[r] << std::endl;
                     }
-                }
-                else
-                {
-                    //* Calculate individual uplink throughput for each client
-                    std::vector<uint64_t> rxBytesPerClient(clients, 0); // Track received bytes for each client
-                    std::vector<double> tputPerClient(clients, 0); // Track received bytes for each client
-                    for (std::size_t i = 0; i < clients; i++) {
-                        // //! UL: Assuming a single AP connected to multiple UEs.
-                        Ptr<PacketSink> sink = DynamicCast<PacketSink>(serverApps[i].Get(0));
-                        if (sink) {
-                            rxBytesPerClient[i] = sink->GetTotalRx();
-                            tputPerClient[i] = (rxBytesPerClient[i] * 8) / (simulationTime * 1000000.0); // Mbit/s
-                            std::cout << mcs << "\t\t" << channelWidth << " MHz\t\t" << gi << " ns\t\t"
-                                      << tputPerClient[i] << " Mbit/s\t" << "(Client[" << i << "])" << std::endl;
-                            
-                            tputFile << mcs << "," 
-                                << channelWidth << "," 
-                                << gi << "," 
-                                << tputPerClient[i] << "," 
-                                << "client" << i + 1 << "," 
-                                << clients << std::endl;
+                    perfFile << mcs << "," << channelWidth << "," << gi << "," << cfg.nAps << ","
+                             << nClients << "," << cfg.layout << "," << results[r].events << ","
+                             << results[r].wallSeconds << ","
+                             << results[r].events / std::max(results[r].wallSeconds, 1e-9) << ","
+                             << results[r].rssKbPerSta << "," << results[r].peakRssKb << ","
+                             << runs[r] << std::endl;
+                    schedFile << results[r].schedTrace;
+                    std::istringstream profile(results[r].eventProfile);
+                    std::string row;
+                    while (std::getline(profile, row))
+                    {
+                        auto events = row.rfind(' ');
+                        auto wallNs = row.rfind(' ', events - 1);
+                        profileFile << row.substr(0, events) << "\n";
+                        profileEventsFile << row.substr(0, wallNs) << row.substr(events) << "\n";
+                    }
+                    for (std::size_t i = 0; i < results[r].latencyPerClient.size(); i++)
+                    {
+                        latencyFile << mcs << "," << channelWidth << "," << gi << ","
+                                    << GetClientLabel(cfg, i) << "," << nClients;
+                        for (auto value : results[r].latencyPerClient[i])
+                        {
+                            latencyFile << "," << value;
                         }
-                        for (uint32_t i = 0; i < serverApp.GetN(); i++)
+                        latencyFile << "," << runs[r] << std::endl;
+                    }
+                    double totalAirtime = 0;
+                    for (const auto& airtime : results[r].airtimePerClient)
+                    {
+                        totalAirtime += std::accumulate(airtime.begin(), airtime.end(), 0.0);
+                    }
+                    for (std::size_t i = 0; i < results[r].airtimePerClient.size(); i++)
+                    {
+                        const auto& airtime = results[r].airtimePerClient[i];
+                        airtimeFile << mcs << "," << channelWidth << "," << gi << ","
+                                    << GetClientLabel(cfg, i) << "," << nClients;
+                        for (auto value : airtime)
                         {
-                            rxBytesPerClient[i] += DynamicCast<PacketSink>(serverApp.Get(i))->GetTotalRx();
+                            airtimeFile << "," << value;
                         }
+                        airtimeFile << ","
+                                    << (totalAirtime > 0 ? std::accumulate(airtime.begin(),
+                                                                           airtime.end(),
+                                                                           0.0) /
+                                                               totalAirtime
+                                                         : 0)
+                                    << "," << results[r].tputPerClient[i] << "," << runs[r]
+                                    << std::endl;
+                    }
+                    if (!results[r].schedCounters.empty())
+                    {
+                        schedStatsFile << mcs << "," << channelWidth << "," << gi << ","
+                                       << cfg.nAps << "," << nClients;
+                        for (const auto& counter : results[r].schedCounters)
+                        {
+                            schedStatsFile << "," << counter.second;
+                        }
+                        schedStatsFile << "," << runs[r] << std::endl;
+                    }
+                    for (const auto& [component, kb] : results[r].memKbPerSta)
+                    {
+                        memFile << mcs << "," << channelWidth << "," << gi << "," << cfg.nAps << ","
+                                << nClients << "," << component << "," << kb << "," << runs[r]
+                                << std::endl;
                     }
-                    totalRxBytes = std::accumulate(rxBytesPerClient.begin(), rxBytesPerClient.end(), 0);
                 }
-                double throughput = (totalRxBytes * 8) / (simulationTime * 1000000.0); // Mbit/s
-
-                Simulator::Destroy();
 
-                std::cout << mcs << "\t\t" << channelWidth << " MHz\t\t" << gi << " ns\t\t"
-                          << throughput << " Mbit/s\t" << "(Total)\n" << std::endl;
+                double throughput = results[0].throughput;
+                if (cfg.replications > 1)
+                {
+                    //* Per-client and total statistics across replications
+                    auto writeStats = [&](const std::string& origin, std::vector<double> samples) {
+                        auto stats = ComputeSampleStats(std::move(samples));
+                        std::cout << mcs << "\t\t" << channelWidth << " MHz\t\t" << gi << " ns\t\t"
+                                  << stats.mean << " +/- " << stats.stddev << " Mbit/s\t(" << origin
+                                  << ", p5=" << stats.p5 << ", p50=" << stats.p50 << ", p95=" << stats.p95
+                                  << ", " << stats.n << " runs)" << std::endl;
+                        statsFile << mcs << "," << channelWidth << "," << gi << "," << origin << ","
+                                  << nClients << "," << stats.n << "," << stats.mean << ","
+                                  << stats.stddev << "," << stats.min << "," << stats.p5 << ","
+                                  << stats.p50 << "," << stats.p95 << "," << stats.max << std::endl;
+                        return stats;
+                    };
+                    for (std::size_t i = 0; i < results[0].tputPerClient.size(); i++)
+                    {
+                        std::vector<double> samples;
+                        for (const auto& result : results)
+                        {
+                            samples.push_back(result.tputPerClient[i]);
+                        }
+                        writeStats(GetClientLabel(cfg, i), std::move(samples));
+                    }
+                    std::vector<double> samples;
+                    for (const auto& result : results)
+                    {
+                        samples.push_back(result.throughput);
+                    }
+                    throughput = writeStats("total", std::move(samples)).mean;
+                }
 
                 // When multiple stations are used, there are chances that association requests
                 // collide and hence the throughput may be lower than expected. Therefore, we relax
@@ -632,7 +1973,7 @@ main(int argc, char* argv[])
                 // test first element
                 if (mcs == 0 && channelWidth == 20 && gi == 3200)
                 {
-                    if (throughput * (1 + tolerance) < minExpectedThroughput)
+                    if (throughput * (1 + tolerance) < cfg.minExpectedThroughput)
                     {
                         NS_LOG_ERROR("Obtained throughput " << throughput << " is not expected!");
                         exit(1);
@@ -641,8 +1982,8 @@ main(int argc, char* argv[])
                 // test last element
                 if (mcs == 11 && channelWidth == 160 && gi == 800)
                 {
-                    if (maxExpectedThroughput > 0 &&
-                        throughput > maxExpectedThroughput * (1 + tolerance))
+                    if (cfg.maxExpectedThroughput > 0 &&
+                        throughput > cfg.maxExpectedThroughput * (1 + tolerance))
                     {
                         NS_LOG_ERROR("Obtained throughput " << throughput << " is not expected!");
                         exit(1);
@@ -651,7 +1992,7 @@ main(int argc, char* argv[])
                 // Skip comparisons with previous cases if more than one stations are present
                 // because, e.g., random collisions in the establishment of Block Ack agreements
                 // have an impact on throughput
-                if (clients == 1)
+                if (nClients == 1)
                 {
                     // test previous throughput is smaller (for the same mcs)
                     if (throughput * (1 + tolerance) > previous)
@@ -682,6 +2023,142 @@ main(int argc, char* argv[])
     }
     // Close the file
     tputFile.close();
+    if (seriesFile.is_open())
+    {
+        seriesFile.close();
+        std::cout << "Time series has been written to " << seriesFilePath << "." << std::endl;
+    }
+    if (statsFile.is_open())
+    {
+        statsFile.close();
+        std::cout << "Replication statistics have been written to " << statsFilePath << "." << std::endl;
+    }
     std::cout << "Data has been written to " << tputFilePath << "." << std::endl;
     return 0;
 }
+
+int
+main(int argc, char* argv[])
+{
+    SawConfig cfg;
+
+    CommandLine cmd(__FILE__);
+    AddOptions(cmd, cfg);
+    cmd.Parse(argc, argv);
+
+    //* The console is written by a background thread, and flushed when the simulator is
+    //* destroyed, when the program exits and before the stream is restored
+    std::unique_ptr<AsyncLogWriter> asyncLog;
+    std::unique_ptr<AsyncLogRedirect> console;
+    if (cfg.asyncLog)
+    {
+        auto policy = AsyncLogWriter::ParsePolicy(cfg.asyncLogPolicy);
+        asyncLog = std::make_unique<AsyncLogWriter>(cfg.asyncLogBuffer * 1024);
+        console = std::make_unique<AsyncLogRedirect>(*asyncLog,
+                                                     std::cout,
+                                                     STDOUT_FILENO,
+                                                     "stdout",
+                                                     policy);
+        std::atexit([] { FlushAsyncLog(&std::cout); });
+    }
+
+    if (cfg.cacheInspect || !cfg.cacheEvict.empty())
+    {
+        ResultCache cache(cfg.cacheDir);
+        if (!cfg.cacheEvict.empty())
+        {
+            std::cout << "Evicted " << cache.Evict(cfg.cacheEvict) << " entries from "
+                      << cfg.cacheDir << std::endl;
+        }
+        if (cfg.cacheInspect)
+        {
+            uint64_t bytes = 0;
+            auto revision = ResultCache::GetRevision();
+            auto entries = cache.List();
+            for (const auto& entry : entries)
+            {
+                std::cout << entry.key << (entry.revision == revision ? "" : " (stale)") << ": "
+                          << entry.description << std::endl;
+                bytes += entry.bytes;
+            }
+            std::cout << entries.size() << " entries, " << bytes << " bytes in " << cfg.cacheDir
+                      << " (current revision " << revision << ")" << std::endl;
+        }
+        return 0;
+    }
+
+    if (cfg.scenario.empty())
+    {
+        cfg.attributeArgs = GetAttributeArgs(std::vector<std::string>(argv, argv + argc));
+        if (!ValidateConfig(cfg))
+        {
+            return 0;
+        }
+        return RunExperiment(cfg, "", asyncLog.get());
+    }
+
+    //* The settings of a job are passed through the command line parser, hence every
+    //* option is a valid key. The actual command line overrides the scenario.
+    auto scenario = LoadScenario(cfg.scenario);
+    auto jobs = ExpandScenario(scenario);
+    std::vector<std::vector<std::string>> jobArgs;
+    for (const auto& job : jobs)
+    {
+        std::vector<std::string> args{argv[0]};
+        for (const auto& [key, value] : job.settings)
+        {
+            NS_ABORT_MSG_IF(key == "scenario" || key == "job" || key == "listJobs",
+                            cfg.scenario << ": " << key << " cannot be set by a scenario");
+            args.push_back("--" + key + "=" + value);
+        }
+        args.insert(args.end(), argv + 1, argv + argc);
+        jobArgs.push_back(args);
+    }
+
+    auto parseJob = [&](std::size_t j) {
+        SawConfig jobCfg;
+        CommandLine jobCmd(__FILE__);
+        AddOptions(jobCmd, jobCfg);
+        jobCmd.Parse(jobArgs[j]);
+        jobCfg.schedulerAttributes = scenario.scheduler;
+        jobCfg.attributeArgs = GetAttributeArgs(jobArgs[j]);
+        return jobCfg;
+    };
+
+    //* Validate all the jobs before running any of them
+    for (std::size_t j = 0; j < jobs.size(); j++)
+    {
+        NS_ABORT_MSG_IF(!ValidateConfig(parseJob(j)),
+                        cfg.scenario << ": invalid frequency in job " << j << " ("
+                                     << jobs[j].label << ")");
+    }
+    if (cfg.listJobs)
+    {
+        for (std::size_t j = 0; j < jobs.size(); j++)
+        {
+            std::cout << "job " << j << ": " << jobs[j].label << std::endl;
+        }
+        return 0;
+    }
+    NS_ABORT_MSG_IF(cfg.job >= static_cast<int>(jobs.size()),
+                    cfg.scenario << " has only " << jobs.size() << " jobs");
+
+    for (std::size_t j = 0; j < jobs.size(); j++)
+    {
+        if (cfg.job >= 0 && static_cast<int>(j) != cfg.job)
+        {
+            continue;
+        }
+        //* Jobs running in the same process must not inherit the defaults set by the
+        //* previous ones, hence the options are parsed again after resetting them
+        Config::Reset();
+        auto jobCfg = parseJob(j);
+        std::cout << "Job " << j << " of " << jobs.size() << ": " << jobs[j].label << std::endl;
+        int ret = RunExperiment(jobCfg, "_job" + std::to_string(j), asyncLog.get());
+        if (ret != 0)
+        {
+            return ret;
+        }
+    }
+    return 0;
+}
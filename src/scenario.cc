@@ -0,0 +1,227 @@
+#include "scenario.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("Scenario");
+
+namespace
+{
+
+/**
+ * \param str a string
+ * \return the string without leading and trailing whitespaces
+ */
+std::string
+Trim(const std::string& str)
+{
+    auto first = str.find_first_not_of(" \t\r");
+    if (first == std::string::npos)
+    {
+        return "";
+    }
+    return str.substr(first, str.find_last_not_of(" \t\r") - first + 1);
+}
+
+/**
+ * \param line a line of the scenario file
+ * \return the line without the comment, if any (a '#' within quotes is not a comment)
+ */
+std::string
+StripComment(const std::string& line)
+{
+    bool quoted = false;
+    for (std::size_t i = 0; i < line.size(); i++)
+    {
+        if (line[i] == '"')
+        {
+            quoted = !quoted;
+        }
+        else if (line[i] == '#' && !quoted)
+        {
+            return line.substr(0, i);
+        }
+    }
+    return line;
+}
+
+/**
+ * \param str a scalar value, possibly quoted
+ * \param where the position of the value in the file, for error messages
+ * \return the value without quotes
+ */
+std::string
+ParseScalar(const std::string& str, const std::string& where)
+{
+    auto value = Trim(str);
+    if (!value.empty() && value.front() == '"')
+    {
+        NS_ABORT_MSG_IF(value.size() < 2 || value.back() != '"', where << ": unterminated string");
+        return value.substr(1, value.size() - 2);
+    }
+    NS_ABORT_MSG_IF(value.empty(), where << ": missing value");
+    return value;
+}
+
+/**
+ * \param str a single-line array, e.g., [1, 2, "a,b"]
+ * \param where the position of the array in the file, for error messages
+ * \return the elements of the array
+ */
+std::vector<std::string>
+ParseArray(const std::string& str, const std::string& where)
+{
+    NS_ABORT_MSG_IF(str.back() != ']', where << ": arrays must be on a single line");
+    std::vector<std::string> values;
+    std::string element;
+    bool quoted = false;
+    for (std::size_t i = 1; i + 1 < str.size(); i++)
+    {
+        if (str[i] == '"')
+        {
+            quoted = !quoted;
+        }
+        if (str[i] == ',' && !quoted)
+        {
+            values.push_back(ParseScalar(element, where));
+            element.clear();
+            continue;
+        }
+        element += str[i];
+    }
+    if (!Trim(element).empty())
+    {
+        values.push_back(ParseScalar(element, where));
+    }
+    NS_ABORT_MSG_IF(values.empty(), where << ": empty array");
+    return values;
+}
+
+} // namespace
+
+Scenario
+LoadScenario(const std::string& path)
+{
+    NS_LOG_FUNCTION(path);
+
+    std::ifstream file(path);
+    NS_ABORT_MSG_IF(!file.is_open(), "Failed to open the scenario file: " << path);
+
+    static const std::vector<std::string> sections{"topology",
+                                                   "traffic",
+                                                   "simulation",
+                                                   "scheduler",
+                                                   "sweep"};
+    Scenario scenario;
+    std::vector<std::string> keys; // all the keys, to detect duplicates
+    std::string section;
+    std::string line;
+    for (std::size_t lineNo = 1; std::getline(file, line); lineNo++)
+    {
+        std::string where = path + ":" + std::to_string(lineNo);
+        line = Trim(StripComment(line));
+        if (line.empty())
+        {
+            continue;
+        }
+
+        if (line.front() == '[')
+        {
+            NS_ABORT_MSG_IF(line.back() != ']', where << ": invalid section header");
+            section = Trim(line.substr(1, line.size() - 2));
+            NS_ABORT_MSG_IF(std::find(sections.cbegin(), sections.cend(), section) ==
+                                sections.cend(),
+                            where << ": unknown section [" << section << "]");
+            continue;
+        }
+
+        auto eq = line.find('=');
+        NS_ABORT_MSG_IF(eq == std::string::npos, where << ": expected key = value");
+        NS_ABORT_MSG_IF(section.empty(), where << ": setting outside of a section");
+        auto key = Trim(line.substr(0, eq));
+        auto value = Trim(line.substr(eq + 1));
+        NS_ABORT_MSG_IF(key.empty(), where << ": missing key");
+
+        // a key may appear in the scheduler section and as an option
+        auto fullKey = (section == "scheduler" ? "scheduler." : "") + key;
+        NS_ABORT_MSG_IF(std::find(keys.cbegin(), keys.cend(), fullKey) != keys.cend(),
+                        where << ": duplicated key " << key);
+        keys.push_back(fullKey);
+
+        bool isArray = (!value.empty() && value.front() == '[');
+        if (section == "sweep")
+        {
+            scenario.sweep.emplace_back(key, std::vector<std::string>{});
+            if (isArray)
+            {
+                scenario.sweep.back().second = ParseArray(value, where);
+            }
+            else
+            {
+                scenario.sweep.back().second.push_back(ParseScalar(value, where));
+            }
+            continue;
+        }
+        NS_ABORT_MSG_IF(isArray, where << ": arrays are only allowed in the sweep section");
+        if (section == "scheduler")
+        {
+            scenario.scheduler.emplace_back(key, ParseScalar(value, where));
+        }
+        else
+        {
+            scenario.options.emplace_back(key, ParseScalar(value, where));
+        }
+    }
+
+    for (const auto& sweep : scenario.sweep)
+    {
+        const auto& key = sweep.first;
+        auto it = std::find_if(scenario.options.cbegin(),
+                               scenario.options.cend(),
+                               [&key](const ScenarioSetting& s) { return s.first == key; });
+        NS_ABORT_MSG_IF(it != scenario.options.cend(),
+                        path << ": " << key << " is both set and swept");
+    }
+    return scenario;
+}
+
+std::vector<ScenarioJob>
+ExpandScenario(const Scenario& scenario)
+{
+    NS_LOG_FUNCTION_NOARGS();
+
+    std::size_t nJobs = 1;
+    for (const auto& sweep : scenario.sweep)
+    {
+        nJobs *= sweep.second.size();
+    }
+
+    std::vector<ScenarioJob> jobs(nJobs);
+    for (std::size_t j = 0; j < nJobs; j++)
+    {
+        jobs[j].settings = scenario.options;
+        // mixed-radix decomposition of the job index, the last option varying fastest
+        std::size_t rest = j;
+        std::vector<ScenarioSetting> swept(scenario.sweep.size());
+        for (std::size_t s = scenario.sweep.size(); s-- > 0;)
+        {
+            const auto& [key, values] = scenario.sweep[s];
+            swept[s] = {key, values[rest % values.size()]};
+            rest /= values.size();
+        }
+        for (const auto& [key, value] : swept)
+        {
+            jobs[j].settings.emplace_back(key, value);
+            jobs[j].label += (jobs[j].label.empty() ? "" : " ") + key + "=" + value;
+        }
+    }
+    return jobs;
+}
+
+} // namespace ns3
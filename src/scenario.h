@@ -0,0 +1,75 @@
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * A "key = value" setting. Values are kept as strings and converted by the consumer
+ * (e.g., the command line parser of saw.cc).
+ */
+typedef std::pair<std::string, std::string> ScenarioSetting;
+
+/**
+ * A scenario description, written in a subset of TOML:
+ *
+ * \code
+ *   # comment
+ *   [topology]
+ *   nAps = 2
+ *   layout = "disc"
+ *   [traffic]
+ *   traffic = "0:saturated;*:onoff"
+ *   [scheduler]
+ *   EnableBsrp = false
+ *   [sweep]
+ *   mcs = [0, 5, 11]
+ *   channelWidth = [20, 40]
+ * \endcode
+ *
+ * The keys of the topology, traffic and simulation sections are the command line
+ * options of saw.cc, the keys of the scheduler section are attributes of the MU
+ * scheduler and the sweep section lists, for some options, the values to sweep over
+ * (single-line arrays). Strings may be quoted; other values are taken verbatim.
+ */
+struct Scenario
+{
+    std::vector<ScenarioSetting> options;   //!< options common to all the jobs
+    std::vector<ScenarioSetting> scheduler; //!< attributes of the MU scheduler
+    std::vector<std::pair<std::string, std::vector<std::string>>> sweep; //!< swept options
+};
+
+/**
+ * A job of a scenario, i.e., a point of the sweep grid
+ */
+struct ScenarioJob
+{
+    std::vector<ScenarioSetting> settings; //!< the common options followed by the swept ones
+    std::string label;                     //!< the values of the swept options
+};
+
+/**
+ * Load a scenario file. Aborts with the offending line on syntax errors, unknown
+ * sections, duplicated keys and arrays outside the sweep section.
+ *
+ * \param path the path of the scenario file
+ * \return the scenario
+ */
+Scenario LoadScenario(const std::string& path);
+
+/**
+ * Expand a scenario into the cartesian product of its sweep section (the last swept
+ * option varies fastest). A scenario without sweep section is a single job.
+ *
+ * \param scenario the scenario
+ * \return the jobs of the scenario
+ */
+std::vector<ScenarioJob> ExpandScenario(const Scenario& scenario);
+
+} // namespace ns3
+
+#endif /* SCENARIO_H */
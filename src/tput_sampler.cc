@@ -0,0 +1,259 @@
+#include "tput_sampler.h"
+
+#include "ns3/abort.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("ThroughputSampler");
+
+ThroughputSampler::ThroughputSampler(Time window, Time warmup, std::size_t batchWindows)
+    : m_window(window),
+      m_warmup(warmup),
+      m_batchWindows(std::max<std::size_t>(batchWindows, 1))
+{
+    NS_LOG_FUNCTION(this << window << warmup << batchWindows);
+    NS_ABORT_MSG_IF(!window.IsStrictlyPositive(), "The sampling window must be positive");
+}
+
+std::size_t
+ThroughputSampler::AddClient(const std::string& label, RxBytesGetter goodput)
+{
+    NS_LOG_FUNCTION(this << label);
+    m_clients.push_back(Client{label, std::move(goodput)});
+    return m_clients.size() - 1;
+}
+
+void
+ThroughputSampler::AddSource(std::size_t index, Ptr<Node> serverNode, Ipv4Address source)
+{
+    NS_LOG_FUNCTION(this << index << serverNode->GetId() << source);
+    NS_ASSERT(index < m_clients.size());
+
+    uint64_t key = (static_cast<uint64_t>(serverNode->GetId()) << 32) | source.Get();
+    m_clientBySource[key] = index;
+
+    //* Connect the IP Rx trace of each server node only once and demux by source
+    if (std::find(m_tracedNodes.cbegin(), m_tracedNodes.cend(), serverNode) ==
+        m_tracedNodes.cend())
+    {
+        Ptr<Ipv4> ipv4 = serverNode->GetObject<Ipv4>();
+        NS_ASSERT_MSG(ipv4, "The server node must have an Internet stack installed");
+        ipv4->TraceConnectWithoutContext("Rx", MakeCallback(&ThroughputSampler::IpRx, this));
+        m_tracedNodes.push_back(serverNode);
+    }
+}
+
+void
+ThroughputSampler::SetCiTarget(double relHalfWidth, std::size_t minBatches)
+{
+    m_ciTarget = relHalfWidth;
+    m_minBatches = std::max<std::size_t>(minBatches, 2);
+}
+
+void
+ThroughputSampler::AddWindowCallback(WindowCallback cb)
+{
+    m_windowCallbacks.push_back(std::move(cb));
+}
+
+void
+ThroughputSampler::Start(std::ostream& os,
+                         const std::string& rowPrefix,
+                         const std::string& rowSuffix)
+{
+    NS_LOG_FUNCTION(this);
+    m_os = &os;
+    m_rowPrefix = rowPrefix;
+    m_rowSuffix = rowSuffix;
+    m_sampleEvent = Simulator::Schedule(m_window, &ThroughputSampler::Sample, this);
+}
+
+void
+ThroughputSampler::IpRx(Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+    Ipv4Header ipHeader;
+    packet->PeekHeader(ipHeader);
+    uint64_t key = (static_cast<uint64_t>(ipv4->GetObject<Node>()->GetId()) << 32) |
+                   ipHeader.GetSource().Get();
+    auto it = m_clientBySource.find(key);
+    if (it != m_clientBySource.end())
+    {
+        m_clients[it->second].ipBytes += packet->GetSize();
+    }
+}
+
+void
+ThroughputSampler::Sample()
+{
+    Time now = Simulator::Now();
+    bool warm = (now - m_window >= m_warmup);
+    double toMbps = 8 / (m_window.GetSeconds() * 1e6);
+
+    std::vector<double> goodputMbps(m_clients.size());
+    std::vector<double> tputMbps(m_clients.size());
+    double totalGoodput = 0;
+
+    for (std::size_t i = 0; i < m_clients.size(); i++)
+    {
+        auto& client = m_clients[i];
+        uint64_t rx = client.goodput();
+        uint64_t goodputBytes = rx - client.lastGoodput;
+        uint64_t ipBytes = client.ipBytes - client.lastIpBytes;
+        client.lastGoodput = rx;
+        client.lastIpBytes = client.ipBytes;
+
+        goodputMbps[i] = goodputBytes * toMbps;
+        tputMbps[i] = ipBytes * toMbps;
+        totalGoodput += goodputMbps[i];
+
+        *m_os << m_rowPrefix << now.GetMilliSeconds() << "," << client.label << ","
+              << tputMbps[i] << "," << goodputMbps[i] << m_rowSuffix << "\n";
+
+        if (warm)
+        {
+            client.warmGoodput += goodputBytes;
+            client.warmIpBytes += ipBytes;
+            client.batchSum += goodputMbps[i];
+        }
+    }
+
+    if (warm)
+    {
+        m_warmWindows++;
+        m_totalBatchSum += totalGoodput;
+
+        if (m_warmWindows % m_batchWindows == 0)
+        {
+            for (auto& client : m_clients)
+            {
+                client.batchMeans.push_back(client.batchSum / m_batchWindows);
+                client.batchSum = 0;
+            }
+            m_totalBatchMeans.push_back(m_totalBatchSum / m_batchWindows);
+            m_totalBatchSum = 0;
+
+            if (m_ciTarget > 0 && m_totalBatchMeans.size() >= m_minBatches)
+            {
+                double mean = std::accumulate(m_totalBatchMeans.cbegin(),
+                                              m_totalBatchMeans.cend(),
+                                              0.0) /
+                              m_totalBatchMeans.size();
+                double halfWidth = CiHalfWidth(m_totalBatchMeans);
+                NS_LOG_DEBUG("Aggregate goodput " << mean << " +/- " << halfWidth << " Mbit/s");
+
+                if (mean > 0 && halfWidth / mean <= m_ciTarget)
+                {
+                    NS_LOG_INFO("CI is tight enough, stopping the simulation at " << now.As(Time::S));
+                    m_earlyStop = now;
+                    Simulator::Stop();
+                }
+            }
+        }
+    }
+
+    for (const auto& cb : m_windowCallbacks)
+    {
+        cb(now, goodputMbps, tputMbps);
+    }
+
+    if (m_earlyStop.IsZero())
+    {
+        m_sampleEvent = Simulator::Schedule(m_window, &ThroughputSampler::Sample, this);
+    }
+}
+
+double
+ThroughputSampler::CiHalfWidth(const std::vector<double>& batchMeans)
+{
+    // two-sided 95% quantiles of the Student's t distribution (df = 1..30)
+    static const double tQuantiles[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306,
+                                        2.262,  2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120,
+                                        2.110,  2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064,
+                                        2.060,  2.056, 2.052, 2.048, 2.045, 2.042};
+
+    std::size_t n = batchMeans.size();
+    if (n < 2)
+    {
+        return 0;
+    }
+    double mean = std::accumulate(batchMeans.cbegin(), batchMeans.cend(), 0.0) / n;
+    double var = 0;
+    for (auto x : batchMeans)
+    {
+        var += (x - mean) * (x - mean);
+    }
+    var /= (n - 1);
+    double t = (n - 1 <= 30 ? tQuantiles[n - 2] : 1.96);
+    return t * std::sqrt(var / n);
+}
+
+ThroughputSampler::Summary
+ThroughputSampler::GetClientSummary(std::size_t index) const
+{
+    NS_ASSERT(index < m_clients.size());
+    const auto& client = m_clients[index];
+    double seconds = GetMeasuredTime().GetSeconds();
+    if (seconds <= 0)
+    {
+        return Summary{0, 0, 0, 0};
+    }
+    return Summary{client.warmIpBytes * 8 / (seconds * 1e6),
+                   client.warmGoodput * 8 / (seconds * 1e6),
+                   CiHalfWidth(client.batchMeans),
+                   client.batchMeans.size()};
+}
+
+ThroughputSampler::Summary
+ThroughputSampler::GetTotalSummary() const
+{
+    double seconds = GetMeasuredTime().GetSeconds();
+    if (seconds <= 0)
+    {
+        return Summary{0, 0, 0, 0};
+    }
+    uint64_t ipBytes = 0;
+    uint64_t goodput = 0;
+    for (const auto& client : m_clients)
+    {
+        ipBytes += client.warmIpBytes;
+        goodput += client.warmGoodput;
+    }
+    return Summary{ipBytes * 8 / (seconds * 1e6),
+                   goodput * 8 / (seconds * 1e6),
+                   CiHalfWidth(m_totalBatchMeans),
+                   m_totalBatchMeans.size()};
+}
+
+Time
+ThroughputSampler::GetMeasuredTime() const
+{
+    return m_window * static_cast<int64_t>(m_warmWindows);
+}
+
+Time
+ThroughputSampler::GetEarlyStopTime() const
+{
+    return m_earlyStop;
+}
+
+std::size_t
+ThroughputSampler::GetNClients() const
+{
+    return m_clients.size();
+}
+
+Time
+ThroughputSampler::GetWindow() const
+{
+    return m_window;
+}
+
+} // namespace ns3
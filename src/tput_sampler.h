@@ -0,0 +1,191 @@
+#ifndef TPUT_SAMPLER_H
+#define TPUT_SAMPLER_H
+
+#include "ns3/event-id.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv4.h"
+#include "ns3/node.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Periodic sampler of per-client throughput and goodput.
+ *
+ * Every window, the sampler streams one row per client to the given output stream.
+ * Goodput is the amount of application bytes delivered to the client's sink, while
+ * throughput is the amount of IP bytes received from the client by the server node
+ * (i.e., including transport headers and retransmissions). Windows starting before the
+ * warm-up time are streamed but excluded from the statistics.
+ *
+ * Post-warm-up windows are grouped into batches of a fixed number of windows. The
+ * batch means of the aggregate goodput give a confidence interval on the steady-state
+ * goodput; if a target relative half-width is set, the simulation is stopped as soon
+ * as the confidence interval is that tight.
+ */
+class ThroughputSampler
+{
+  public:
+    /**
+     * Callback returning the number of application bytes received so far
+     */
+    typedef std::function<uint64_t()> RxBytesGetter;
+
+    /**
+     * Summary statistics of a client (or of the aggregate) over the post-warm-up windows
+     */
+    struct Summary
+    {
+        double tputMbps;        //!< mean throughput (Mbit/s)
+        double goodputMbps;     //!< mean goodput (Mbit/s)
+        double ciHalfWidthMbps; //!< 95% batch-means CI half-width on goodput (0 if unknown)
+        std::size_t nBatches;   //!< number of complete batches
+    };
+
+    /**
+     * \param window the sampling window
+     * \param warmup windows starting before this time are not included in the statistics
+     * \param batchWindows the number of windows per batch
+     */
+    ThroughputSampler(Time window, Time warmup, std::size_t batchWindows);
+
+    /**
+     * Add a client to sample.
+     *
+     * \param label the label of the client in the streamed rows
+     * \param goodput callback returning the bytes received so far by the client's sink
+     * \return the index of the client
+     */
+    std::size_t AddClient(const std::string& label, RxBytesGetter goodput);
+    /**
+     * Attribute the IP packets received by the given server node from the given source
+     * to the given client. A client may have multiple sources (e.g., an aggregate).
+     *
+     * \param index the index of the client
+     * \param serverNode the node hosting the sink of the client
+     * \param source the IP address the client sends from
+     */
+    void AddSource(std::size_t index, Ptr<Node> serverNode, Ipv4Address source);
+
+    /**
+     * Stop the simulation once the relative half-width of the 95% confidence interval
+     * on the aggregate goodput is below the given value.
+     *
+     * \param relHalfWidth the target relative half-width (0 disables early termination)
+     * \param minBatches the minimum number of batches before stopping
+     */
+    void SetCiTarget(double relHalfWidth, std::size_t minBatches);
+
+    /**
+     * Start sampling and stream rows prefixed by the given string to the given stream.
+     *
+     * \param os the output stream (must outlive the simulation)
+     * \param rowPrefix the string prepended to every row (e.g., the sweep point)
+     * \param rowSuffix the string appended to every row
+     */
+    void Start(std::ostream& os, const std::string& rowPrefix, const std::string& rowSuffix);
+
+    /**
+     * \param index the index of the client (in order of addition)
+     * \return the summary of the client
+     */
+    Summary GetClientSummary(std::size_t index) const;
+    /**
+     * \return the summary of the aggregate of all the clients
+     */
+    Summary GetTotalSummary() const;
+    /**
+     * \return the duration covered by the post-warm-up windows
+     */
+    Time GetMeasuredTime() const;
+    /**
+     * \return the time the simulation was stopped by the sampler, or zero
+     */
+    Time GetEarlyStopTime() const;
+    /**
+     * \return the number of clients
+     */
+    std::size_t GetNClients() const;
+    /**
+     * \return the sampling window
+     */
+    Time GetWindow() const;
+
+    /**
+     * Callback invoked at the end of every window with the per-client goodput and
+     * throughput (Mbit/s) measured over that window.
+     */
+    typedef std::function<void(Time now,
+                               const std::vector<double>& goodputMbps,
+                               const std::vector<double>& tputMbps)>
+        WindowCallback;
+    /**
+     * \param cb the callback to invoke at the end of every window
+     */
+    void AddWindowCallback(WindowCallback cb);
+
+  private:
+    /**
+     * Account the bytes of an IP packet received by a server node.
+     *
+     * \param packet the packet, including the IP header
+     * \param ipv4 the IPv4 stack of the server node
+     * \param interface the interface the packet was received on
+     */
+    void IpRx(Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface);
+    /// Close the current window and schedule the next one
+    void Sample();
+    /**
+     * Compute the batch-means CI half-width of the given batch means.
+     *
+     * \param batchMeans the batch means
+     * \return the 95% CI half-width
+     */
+    static double CiHalfWidth(const std::vector<double>& batchMeans);
+
+    /**
+     * Per-client state
+     */
+    struct Client
+    {
+        std::string label;         //!< label in the streamed rows
+        RxBytesGetter goodput;     //!< bytes received by the client's sink
+        uint64_t lastGoodput{0};   //!< goodput bytes at the start of the window
+        uint64_t ipBytes{0};       //!< IP bytes received so far
+        uint64_t lastIpBytes{0};   //!< IP bytes at the start of the window
+        uint64_t warmGoodput{0};   //!< goodput bytes in post-warm-up windows
+        uint64_t warmIpBytes{0};   //!< IP bytes in post-warm-up windows
+        double batchSum{0};        //!< goodput (Mbit/s) summed over the current batch
+        std::vector<double> batchMeans; //!< goodput (Mbit/s) batch means
+    };
+
+    Time m_window;                   //!< sampling window
+    Time m_warmup;                   //!< warm-up time
+    std::size_t m_batchWindows;      //!< windows per batch
+    double m_ciTarget{0};            //!< target relative CI half-width
+    std::size_t m_minBatches{5};     //!< minimum number of batches before stopping
+    std::vector<Client> m_clients;   //!< sampled clients
+    std::unordered_map<uint64_t, std::size_t> m_clientBySource; //!< (node ID, source) -> client
+    std::vector<Ptr<Node>> m_tracedNodes; //!< server nodes whose IP Rx trace is connected
+    std::ostream* m_os{nullptr};     //!< output stream
+    std::string m_rowPrefix;         //!< prefix of streamed rows
+    std::string m_rowSuffix;         //!< suffix of streamed rows
+    std::size_t m_warmWindows{0};    //!< number of post-warm-up windows
+    double m_totalBatchSum{0};       //!< aggregate goodput summed over the current batch
+    std::vector<double> m_totalBatchMeans; //!< aggregate goodput batch means
+    Time m_earlyStop;                //!< time the simulation was stopped early
+    std::vector<WindowCallback> m_windowCallbacks; //!< per-window callbacks
+    EventId m_sampleEvent;           //!< next sampling event
+};
+
+} // namespace ns3
+
+#endif /* TPUT_SAMPLER_H */
@@ -0,0 +1,704 @@
+#include "traffic_models.h"
+
+#include "ns3/abort.h"
+#include "ns3/boolean.h"
+#include "ns3/bulk-send-helper.h"
+#include "ns3/double.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/log.h"
+#include "ns3/on-off-helper.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/udp-client-server-helper.h"
+#include "ns3/uinteger.h"
+#include "ns3/wifi-mac.h"
+#include "ns3/wifi-mpdu.h"
+#include "ns3/wifi-net-device.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("TrafficModels");
+
+NS_OBJECT_ENSURE_REGISTERED(TrafficSourceApp);
+NS_OBJECT_ENSURE_REGISTERED(VideoTrafficApp);
+NS_OBJECT_ENSURE_REGISTERED(TraceTrafficApp);
+NS_OBJECT_ENSURE_REGISTERED(SaturatingUdpApp);
+
+TypeId
+TrafficSourceApp::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::TrafficSourceApp")
+            .SetParent<Application>()
+            .SetGroupName("Applications")
+            .AddAttribute("Remote",
+                          "The address of the destination",
+                          AddressValue(),
+                          MakeAddressAccessor(&TrafficSourceApp::m_peer),
+                          MakeAddressChecker())
+            .AddAttribute("Protocol",
+                          "The type of protocol to use (a socket factory)",
+                          TypeIdValue(TypeId::LookupByName("ns3::UdpSocketFactory")),
+                          MakeTypeIdAccessor(&TrafficSourceApp::m_protocol),
+                          MakeTypeIdChecker())
+            .AddAttribute("PacketSize",
+                          "The maximum size in bytes of the packets data units are split into",
+                          UintegerValue(700),
+                          MakeUintegerAccessor(&TrafficSourceApp::m_packetSize),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddTraceSource("Tx",
+                            "A new packet is handed to the socket",
+                            MakeTraceSourceAccessor(&TrafficSourceApp::m_txTrace),
+                            "ns3::Packet::TracedCallback");
+    return tid;
+}
+
+TrafficSourceApp::TrafficSourceApp()
+    : m_droppedBytes(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+TrafficSourceApp::~TrafficSourceApp()
+{
+    NS_LOG_FUNCTION_NOARGS();
+}
+
+uint64_t
+TrafficSourceApp::GetDroppedBytes() const
+{
+    return m_droppedBytes;
+}
+
+void
+TrafficSourceApp::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_socket = nullptr;
+    Application::DoDispose();
+}
+
+void
+TrafficSourceApp::StartApplication()
+{
+    NS_LOG_FUNCTION(this);
+
+    if (!m_socket)
+    {
+        m_socket = Socket::CreateSocket(GetNode(), m_protocol);
+        int ret = (Inet6SocketAddress::IsMatchingType(m_peer) ? m_socket->Bind6()
+                                                               : m_socket->Bind());
+        NS_ABORT_MSG_IF(ret == -1, "Failed to bind the socket");
+        m_socket->Connect(m_peer);
+        m_socket->ShutdownRecv();
+    }
+    StartTraffic();
+}
+
+void
+TrafficSourceApp::StopApplication()
+{
+    NS_LOG_FUNCTION(this);
+
+    StopTraffic();
+    if (m_socket)
+    {
+        m_socket->Close();
+    }
+}
+
+void
+TrafficSourceApp::SendBytes(uint32_t bytes)
+{
+    NS_LOG_FUNCTION(this << bytes);
+
+    while (bytes > 0)
+    {
+        uint32_t size = std::min(bytes, m_packetSize);
+        auto packet = Create<Packet>(size);
+        m_txTrace(packet);
+        if (m_socket->Send(packet) < 0)
+        {
+            // e.g., the TCP send buffer is full
+            NS_LOG_DEBUG("The socket refused " << bytes << " bytes");
+            m_droppedBytes += bytes;
+            return;
+        }
+        bytes -= size;
+    }
+}
+
+TypeId
+VideoTrafficApp::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::VideoTrafficApp")
+            .SetParent<TrafficSourceApp>()
+            .SetGroupName("Applications")
+            .AddConstructor<VideoTrafficApp>()
+            .AddAttribute("Rate",
+                          "The mean rate of the video stream",
+                          DataRateValue(DataRate("4Mb/s")),
+                          MakeDataRateAccessor(&VideoTrafficApp::m_rate),
+                          MakeDataRateChecker())
+            .AddAttribute("FrameRate",
+                          "The number of frames per second",
+                          DoubleValue(30),
+                          MakeDoubleAccessor(&VideoTrafficApp::m_frameRate),
+                          MakeDoubleChecker<double>(0.1))
+            .AddAttribute("GopSize",
+                          "The number of frames in a group of pictures (starting with an I-frame)",
+                          UintegerValue(12),
+                          MakeUintegerAccessor(&VideoTrafficApp::m_gopSize),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("IFrameRatio",
+                          "The mean size of I-frames relative to the mean size of other frames",
+                          DoubleValue(4),
+                          MakeDoubleAccessor(&VideoTrafficApp::m_iFrameRatio),
+                          MakeDoubleChecker<double>(1))
+            .AddAttribute("Sigma",
+                          "The standard deviation of the logarithm of the frame sizes",
+                          DoubleValue(0.2),
+                          MakeDoubleAccessor(&VideoTrafficApp::m_sigma),
+                          MakeDoubleChecker<double>(0));
+    return tid;
+}
+
+VideoTrafficApp::VideoTrafficApp()
+    : m_frameCount(0)
+{
+    NS_LOG_FUNCTION(this);
+    m_frameSizeVar = CreateObject<NormalRandomVariable>();
+    m_frameSizeVar->SetAttribute("Mean", DoubleValue(0));
+    m_frameSizeVar->SetAttribute("Variance", DoubleValue(1));
+}
+
+int64_t
+VideoTrafficApp::AssignStreams(int64_t stream)
+{
+    NS_LOG_FUNCTION(this << stream);
+    m_frameSizeVar->SetStream(stream);
+    return 1;
+}
+
+void
+VideoTrafficApp::StartTraffic()
+{
+    NS_LOG_FUNCTION(this);
+    m_frameCount = 0;
+    SendFrame();
+}
+
+void
+VideoTrafficApp::StopTraffic()
+{
+    NS_LOG_FUNCTION(this);
+    m_sendEvent.Cancel();
+}
+
+void
+VideoTrafficApp::SendFrame()
+{
+    NS_LOG_FUNCTION(this);
+
+    // the mean size of the other frames is such that the mean size over a group of
+    // pictures matches the configured rate
+    double meanFrameBytes = m_rate.GetBitRate() / 8.0 / m_frameRate;
+    double pFrameBytes = meanFrameBytes * m_gopSize / (m_iFrameRatio + m_gopSize - 1);
+    double frameBytes = (m_frameCount % m_gopSize == 0 ? m_iFrameRatio : 1) * pFrameBytes;
+    // mean-preserving log-normal variation
+    frameBytes *= std::exp(m_sigma * m_frameSizeVar->GetValue() - m_sigma * m_sigma / 2);
+
+    SendBytes(std::max<uint32_t>(1, static_cast<uint32_t>(frameBytes)));
+    m_frameCount++;
+    m_sendEvent = Simulator::Schedule(Seconds(1 / m_frameRate), &VideoTrafficApp::SendFrame, this);
+}
+
+TypeId
+TraceTrafficApp::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::TraceTrafficApp")
+                            .SetParent<TrafficSourceApp>()
+                            .SetGroupName("Applications")
+                            .AddConstructor<TraceTrafficApp>()
+                            .AddAttribute("FileName",
+                                          "The trace file (one \"<seconds> <bytes>\" line per "
+                                          "data unit)",
+                                          StringValue(""),
+                                          MakeStringAccessor(&TraceTrafficApp::m_fileName),
+                                          MakeStringChecker())
+                            .AddAttribute("Loop",
+                                          "Replay the trace in a loop",
+                                          BooleanValue(false),
+                                          MakeBooleanAccessor(&TraceTrafficApp::m_loop),
+                                          MakeBooleanChecker());
+    return tid;
+}
+
+TraceTrafficApp::TraceTrafficApp()
+    : m_loop(false),
+      m_next(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+TraceTrafficApp::StartTraffic()
+{
+    NS_LOG_FUNCTION(this);
+
+    if (m_trace.empty())
+    {
+        std::ifstream file(m_fileName);
+        NS_ABORT_MSG_IF(!file.is_open(), "Failed to open the trace file: " << m_fileName);
+        std::string line;
+        while (std::getline(file, line))
+        {
+            if (line.empty() || line[0] == '#')
+            {
+                continue;
+            }
+            std::istringstream iss(line);
+            double seconds;
+            uint32_t bytes;
+            NS_ABORT_MSG_IF(!(iss >> seconds >> bytes),
+                            "Invalid line in " << m_fileName << ": " << line);
+            NS_ABORT_MSG_IF(!m_trace.empty() && Seconds(seconds) < m_trace.back().first,
+                            "Times must not decrease in " << m_fileName);
+            m_trace.emplace_back(Seconds(seconds), bytes);
+        }
+        NS_ABORT_MSG_IF(m_trace.empty(), "Empty trace file: " << m_fileName);
+        NS_ABORT_MSG_IF(m_loop && m_trace.back().first.IsZero(),
+                        "A trace replayed in a loop must last more than zero seconds");
+    }
+
+    m_next = 0;
+    m_offset = Simulator::Now();
+    m_sendEvent = Simulator::Schedule(m_trace[0].first, &TraceTrafficApp::SendNext, this);
+}
+
+void
+TraceTrafficApp::StopTraffic()
+{
+    NS_LOG_FUNCTION(this);
+    m_sendEvent.Cancel();
+}
+
+void
+TraceTrafficApp::SendNext()
+{
+    NS_LOG_FUNCTION(this);
+
+    SendBytes(m_trace[m_next].second);
+    if (++m_next == m_trace.size())
+    {
+        if (!m_loop)
+        {
+            return;
+        }
+        m_offset += m_trace.back().first;
+        m_next = 0;
+    }
+    m_sendEvent = Simulator::Schedule(m_offset + m_trace[m_next].first - Simulator::Now(),
+                                      &TraceTrafficApp::SendNext,
+                                      this);
+}
+
+TypeId
+SaturatingUdpApp::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::SaturatingUdpApp")
+            .SetParent<TrafficSourceApp>()
+            .SetGroupName("Applications")
+            .AddConstructor<SaturatingUdpApp>()
+            .AddAttribute("LowWatermark",
+                          "The queue is refilled when less than this number of frames of "
+                          "the flow are queued",
+                          UintegerValue(32),
+                          MakeUintegerAccessor(&SaturatingUdpApp::m_lowWatermark),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("HighWatermark",
+                          "The number of frames of the flow the queue is refilled up to",
+                          UintegerValue(64),
+                          MakeUintegerAccessor(&SaturatingUdpApp::m_highWatermark),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("RefillInterval",
+                          "The period of the timer refilling the queue when no frame of the "
+                          "flow leaves it",
+                          TimeValue(MilliSeconds(10)),
+                          MakeTimeAccessor(&SaturatingUdpApp::m_refillInterval),
+                          MakeTimeChecker());
+    return tid;
+}
+
+SaturatingUdpApp::SaturatingUdpApp()
+    : m_queued(0),
+      m_running(false)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+SaturatingUdpApp::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    if (m_queue)
+    {
+        m_queue->TraceDisconnectWithoutContext(
+            "Dequeue",
+            MakeCallback(&SaturatingUdpApp::NotifyDequeue, this));
+        m_queue = nullptr;
+    }
+    TrafficSourceApp::DoDispose();
+}
+
+void
+SaturatingUdpApp::SetMacQueue(Ptr<WifiMacQueue> queue, Mac48Address receiver)
+{
+    NS_LOG_FUNCTION(this << queue << receiver);
+    NS_ASSERT(!m_queue);
+    m_queue = queue;
+    m_receiver = receiver;
+    m_queue->TraceConnectWithoutContext("Dequeue",
+                                        MakeCallback(&SaturatingUdpApp::NotifyDequeue, this));
+}
+
+void
+SaturatingUdpApp::StartTraffic()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ABORT_MSG_IF(!m_queue, "The MAC queue of the saturated flow has not been set");
+    NS_ABORT_MSG_IF(m_lowWatermark >= m_highWatermark,
+                    "LowWatermark must be lower than HighWatermark");
+    m_running = true;
+    RefillTimeout();
+}
+
+void
+SaturatingUdpApp::StopTraffic()
+{
+    NS_LOG_FUNCTION(this);
+    m_running = false;
+    m_refillEvent.Cancel();
+    m_refillNowEvent.Cancel();
+}
+
+void
+SaturatingUdpApp::NotifyDequeue(Ptr<const WifiMpdu> mpdu)
+{
+    if (!mpdu->GetHeader().IsQosData() || mpdu->GetHeader().GetAddr1() != m_receiver)
+    {
+        return;
+    }
+    if (m_queued > 0)
+    {
+        m_queued--;
+    }
+    if (m_running && m_queued < m_lowWatermark && !m_refillNowEvent.IsRunning())
+    {
+        // do not enqueue frames while the queue is removing one
+        m_refillNowEvent = Simulator::ScheduleNow(&SaturatingUdpApp::Refill, this);
+        // refills are needed less often than the timer, which is just a fallback
+        m_refillEvent.Cancel();
+        m_refillEvent =
+            Simulator::Schedule(m_refillInterval, &SaturatingUdpApp::RefillTimeout, this);
+    }
+}
+
+uint32_t
+SaturatingUdpApp::CountQueued() const
+{
+    uint32_t count = 0;
+    for (auto mpdu = m_queue->PeekByTidAndAddress(0, m_receiver); mpdu;
+         mpdu = m_queue->PeekByTidAndAddress(0, m_receiver, mpdu))
+    {
+        count++;
+    }
+    return count;
+}
+
+void
+SaturatingUdpApp::Refill()
+{
+    NS_LOG_FUNCTION(this << m_queued);
+
+    // the frames that expired or were dropped are not always dequeued, and the packets
+    // that never reached the MAC queue (e.g., dropped while resolving the address of
+    // the receiver) never are: resynchronize with the queue itself
+    m_queued = CountQueued();
+    while (m_running && m_queued < m_highWatermark)
+    {
+        auto packet = Create<Packet>(m_packetSize);
+        m_txTrace(packet);
+        if (m_socket->Send(packet) < 0)
+        {
+            break;
+        }
+        m_queued++;
+    }
+}
+
+void
+SaturatingUdpApp::RefillTimeout()
+{
+    NS_LOG_FUNCTION(this);
+    Refill();
+    m_refillEvent = Simulator::Schedule(m_refillInterval, &SaturatingUdpApp::RefillTimeout, this);
+}
+
+std::string
+TrafficModel::Get(const std::string& key, const std::string& def) const
+{
+    auto it = params.find(key);
+    return (it != params.end() ? it->second : def);
+}
+
+namespace
+{
+
+/**
+ * \param str a string
+ * \return the string without leading and trailing whitespaces
+ */
+std::string
+Trim(const std::string& str)
+{
+    auto first = str.find_first_not_of(" \t");
+    if (first == std::string::npos)
+    {
+        return "";
+    }
+    return str.substr(first, str.find_last_not_of(" \t") - first + 1);
+}
+
+/**
+ * \param str the model, e.g., "video[Rate=8Mb/s|FrameRate=30]"
+ * \return the parsed model
+ */
+TrafficModel
+ParseTrafficModel(const std::string& str)
+{
+    static const std::vector<std::string> models{"onoff",
+                                                 "cbr",
+                                                 "flood",
+                                                 "bursty",
+                                                 "video",
+                                                 "trace",
+                                                 "saturated"};
+    TrafficModel model;
+    auto bracket = str.find('[');
+    model.name = Trim(str.substr(0, bracket));
+    NS_ABORT_MSG_IF(std::find(models.cbegin(), models.cend(), model.name) == models.cend(),
+                    "Unknown traffic model: " << model.name);
+    if (bracket == std::string::npos)
+    {
+        return model;
+    }
+
+    NS_ABORT_MSG_IF(str.back() != ']', "Missing ']' in traffic model: " << str);
+    std::istringstream iss(str.substr(bracket + 1, str.size() - bracket - 2));
+    std::string param;
+    while (std::getline(iss, param, '|'))
+    {
+        auto eq = param.find('=');
+        NS_ABORT_MSG_IF(eq == std::string::npos, "Invalid parameter in traffic model: " << param);
+        model.params[Trim(param.substr(0, eq))] = Trim(param.substr(eq + 1));
+    }
+
+    //* The models installed with an ns-3 helper only read some parameters, the
+    //* parameters of the custom models are attributes of their application
+    static const std::map<std::string, std::vector<std::string>> helperParams{
+        {"onoff", {"Rate", "OnMean", "OffMean"}},
+        {"cbr", {"Rate"}},
+        {"bursty", {"Rate", "OnMean", "OffMean", "Shape"}},
+        {"flood", {"Interval"}}};
+    static const std::map<std::string, std::string> appTypes{
+        {"video", "ns3::VideoTrafficApp"},
+        {"trace", "ns3::TraceTrafficApp"},
+        {"saturated", "ns3::SaturatingUdpApp"}};
+    for (const auto& [key, value] : model.params)
+    {
+        if (auto it = helperParams.find(model.name); it != helperParams.cend())
+        {
+            NS_ABORT_MSG_IF(std::find(it->second.cbegin(), it->second.cend(), key) ==
+                                it->second.cend(),
+                            "Unknown parameter " << key << " of the traffic model " << model.name);
+            continue;
+        }
+        TypeId::AttributeInformation info;
+        NS_ABORT_MSG_IF(!TypeId::LookupByName(appTypes.at(model.name))
+                             .LookupAttributeByName(key, &info),
+                        "Unknown parameter " << key << " of the traffic model " << model.name);
+        NS_ABORT_MSG_IF(!info.checker->CreateValidValue(StringValue(value)),
+                        "Invalid value of the parameter " << key << " of the traffic model "
+                                                          << model.name << ": " << value);
+    }
+    return model;
+}
+
+} // namespace
+
+std::vector<TrafficModel>
+ParseTrafficSpec(const std::string& spec, std::size_t nClients)
+{
+    NS_LOG_FUNCTION(spec << nClients);
+
+    std::vector<TrafficModel> models(nClients);
+    std::vector<bool> assigned(nClients, false);
+    std::istringstream iss(spec);
+    std::string entry;
+    while (std::getline(iss, entry, ';'))
+    {
+        entry = Trim(entry);
+        if (entry.empty())
+        {
+            continue;
+        }
+        auto colon = entry.find(':');
+        NS_ABORT_MSG_IF(colon == std::string::npos, "Missing ':' in traffic entry: " << entry);
+        std::string clients = Trim(entry.substr(0, colon));
+        auto model = ParseTrafficModel(Trim(entry.substr(colon + 1)));
+
+        std::size_t first = 0;
+        std::size_t last = nClients - 1;
+        if (clients != "*")
+        {
+            auto dash = clients.find('-');
+            try
+            {
+                first = std::stoul(clients.substr(0, dash));
+                last = (dash == std::string::npos ? first : std::stoul(clients.substr(dash + 1)));
+            }
+            catch (const std::exception&)
+            {
+                NS_ABORT_MSG("Invalid clients in traffic entry: " << entry);
+            }
+            NS_ABORT_MSG_IF(first > last || last >= nClients,
+                            "Clients out of range in traffic entry: " << entry);
+        }
+        for (std::size_t i = first; i <= last; i++)
+        {
+            if (!assigned[i])
+            {
+                models[i] = model;
+                assigned[i] = true;
+            }
+        }
+    }
+
+    auto it = std::find(assigned.cbegin(), assigned.cend(), false);
+    NS_ABORT_MSG_IF(it != assigned.cend(),
+                    "No traffic model for client " << it - assigned.cbegin() << " in: " << spec);
+    return models;
+}
+
+ApplicationContainer
+InstallTrafficSource(const TrafficModel& model,
+                     bool udp,
+                     uint32_t payloadSize,
+                     Ptr<Node> node,
+                     Ptr<NetDevice> device,
+                     const Address& remote,
+                     Mac48Address receiver)
+{
+    NS_LOG_FUNCTION(model.name << udp << payloadSize << node << device << remote << receiver);
+
+    std::string factory = (udp ? "ns3::UdpSocketFactory" : "ns3::TcpSocketFactory");
+
+    if (model.name == "onoff" || model.name == "cbr" || model.name == "bursty")
+    {
+        OnOffHelper onoff(factory, remote);
+        if (model.name == "onoff")
+        {
+            onoff.SetAttribute("OnTime",
+                               StringValue("ns3::ExponentialRandomVariable[Mean=" +
+                                           model.Get("OnMean", "0.5") + "]"));
+            onoff.SetAttribute("OffTime",
+                               StringValue("ns3::ExponentialRandomVariable[Mean=" +
+                                           model.Get("OffMean", "0.5") + "]"));
+        }
+        else if (model.name == "cbr")
+        {
+            onoff.SetAttribute("OnTime", StringValue("ns3::ConstantRandomVariable[Constant=1]"));
+            onoff.SetAttribute("OffTime", StringValue("ns3::ConstantRandomVariable[Constant=0]"));
+        }
+        else
+        {
+            //* Heavy-tailed on and off periods with the given means
+            double shape = std::stod(model.Get("Shape", "1.5"));
+            NS_ABORT_MSG_IF(shape <= 1, "The Pareto shape must be greater than 1");
+            auto pareto = [shape](const std::string& mean) {
+                return "ns3::ParetoRandomVariable[Scale=" +
+                       std::to_string(std::stod(mean) * (shape - 1) / shape) +
+                       "|Shape=" + std::to_string(shape) + "]";
+            };
+            onoff.SetAttribute("OnTime", StringValue(pareto(model.Get("OnMean", "0.05"))));
+            onoff.SetAttribute("OffTime", StringValue(pareto(model.Get("OffMean", "0.5"))));
+        }
+        onoff.SetAttribute("PacketSize", UintegerValue(payloadSize));
+        std::string defaultRate = (model.name == "bursty" ? "20Mb/s" : "2Mb/s");
+        onoff.SetAttribute("DataRate", StringValue(model.Get("Rate", defaultRate)));
+        return onoff.Install(node);
+    }
+
+    if (model.name == "flood")
+    {
+        NS_ABORT_MSG_IF(!udp, "The flood model requires UDP (use saturated with TCP)");
+        auto inet = InetSocketAddress::ConvertFrom(remote);
+        UdpClientHelper client(inet.GetIpv4(), inet.GetPort());
+        client.SetAttribute("MaxPackets", UintegerValue(4294967295U));
+        client.SetAttribute("Interval", StringValue(model.Get("Interval", "10us")));
+        client.SetAttribute("PacketSize", UintegerValue(payloadSize));
+        return client.Install(node);
+    }
+
+    if (model.name == "saturated" && !udp)
+    {
+        //* TCP keeps the MAC queue full on its own
+        NS_ABORT_MSG_IF(!model.params.empty(), "The saturated model has no parameters with TCP");
+        BulkSendHelper bulk(factory, remote);
+        bulk.SetAttribute("SendSize", UintegerValue(payloadSize));
+        bulk.SetAttribute("MaxBytes", UintegerValue(0));
+        return bulk.Install(node);
+    }
+
+    Ptr<TrafficSourceApp> app;
+    if (model.name == "video")
+    {
+        app = CreateObject<VideoTrafficApp>();
+    }
+    else if (model.name == "trace")
+    {
+        app = CreateObject<TraceTrafficApp>();
+    }
+    else
+    {
+        auto saturating = CreateObject<SaturatingUdpApp>();
+        auto wifiDevice = DynamicCast<WifiNetDevice>(device);
+        NS_ABORT_MSG_IF(!wifiDevice, "The saturated UDP model requires a Wi-Fi device");
+        saturating->SetMacQueue(wifiDevice->GetMac()->GetTxopQueue(AC_BE), receiver);
+        app = saturating;
+    }
+    app->SetAttribute("Remote", AddressValue(remote));
+    app->SetAttribute("Protocol", TypeIdValue(TypeId::LookupByName(factory)));
+    app->SetAttribute("PacketSize", UintegerValue(payloadSize));
+    //* Parameters of the custom models are attributes of the application
+    for (const auto& [key, value] : model.params)
+    {
+        app->SetAttribute(key, StringValue(value));
+    }
+    node->AddApplication(app);
+    return ApplicationContainer(app);
+}
+
+} // namespace ns3
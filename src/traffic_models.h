@@ -0,0 +1,268 @@
+#ifndef TRAFFIC_MODELS_H
+#define TRAFFIC_MODELS_H
+
+#include "ns3/address.h"
+#include "ns3/application.h"
+#include "ns3/application-container.h"
+#include "ns3/data-rate.h"
+#include "ns3/event-id.h"
+#include "ns3/mac48-address.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/socket.h"
+#include "ns3/traced-callback.h"
+#include "ns3/wifi-mac-queue.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Base class of the traffic sources that send application data units (e.g., video
+ * frames) rather than single packets: each data unit is sent with a single event and
+ * split into packets of at most PacketSize bytes.
+ */
+class TrafficSourceApp : public Application
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+    TrafficSourceApp();
+    ~TrafficSourceApp() override;
+
+    /**
+     * \return the number of bytes that could not be handed to the socket
+     */
+    uint64_t GetDroppedBytes() const;
+
+  protected:
+    void DoDispose() override;
+
+    /**
+     * Send the given amount of bytes, split into packets of at most PacketSize bytes.
+     *
+     * \param bytes the amount of bytes to send
+     */
+    void SendBytes(uint32_t bytes);
+
+    Ptr<Socket> m_socket;  //!< the socket, created when the application starts
+    uint32_t m_packetSize; //!< the maximum size of the packets
+
+    /// packets handed to the socket (possibly refused by it)
+    TracedCallback<Ptr<const Packet>> m_txTrace;
+
+  private:
+    void StartApplication() override;
+    void StopApplication() override;
+
+    /**
+     * Called once the socket is open to start generating traffic.
+     */
+    virtual void StartTraffic() = 0;
+    /**
+     * Called when the application stops to cancel any pending event.
+     */
+    virtual void StopTraffic() = 0;
+
+    Address m_peer;          //!< the remote address
+    TypeId m_protocol;       //!< the type of the socket factory
+    uint64_t m_droppedBytes; //!< bytes refused by the socket
+};
+
+/**
+ * Video-like source: frames are generated at a constant frame rate and the first frame
+ * of every group of pictures (I-frame) is larger than the other ones. Frame sizes are
+ * log-normally distributed around the mean size that yields the configured rate.
+ */
+class VideoTrafficApp : public TrafficSourceApp
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+    VideoTrafficApp();
+
+    /**
+     * Assign a fixed random variable stream number to the random variables used by
+     * this application.
+     *
+     * \param stream first stream index to use
+     * \return the number of stream indices assigned by this application
+     */
+    int64_t AssignStreams(int64_t stream);
+
+  private:
+    void StartTraffic() override;
+    void StopTraffic() override;
+
+    /**
+     * Send the next frame and schedule the following one.
+     */
+    void SendFrame();
+
+    DataRate m_rate;                          //!< mean rate
+    double m_frameRate;                       //!< frames per second
+    uint32_t m_gopSize;                       //!< frames per group of pictures
+    double m_iFrameRatio;                     //!< size of I-frames relative to other frames
+    double m_sigma;                           //!< standard deviation of the log of frame sizes
+    Ptr<NormalRandomVariable> m_frameSizeVar; //!< variation of the frame sizes
+    uint32_t m_frameCount;                    //!< frames sent so far
+    EventId m_sendEvent;                      //!< event to send the next frame
+};
+
+/**
+ * Trace-driven source: the file has one "<time in seconds> <bytes>" line per data unit,
+ * with times relative to the start of the application. Lines starting with '#' are
+ * ignored. Optionally, the trace is replayed in a loop.
+ */
+class TraceTrafficApp : public TrafficSourceApp
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+    TraceTrafficApp();
+
+  private:
+    void StartTraffic() override;
+    void StopTraffic() override;
+
+    /**
+     * Send the current data unit and schedule the next one.
+     */
+    void SendNext();
+
+    std::string m_fileName;                         //!< the trace file
+    bool m_loop;                                    //!< whether to replay the trace in a loop
+    std::vector<std::pair<Time, uint32_t>> m_trace; //!< the data units of the trace
+    std::size_t m_next;                             //!< index of the next data unit
+    Time m_offset;                                  //!< start time of the current replay
+    EventId m_sendEvent;                            //!< event to send the next data unit
+};
+
+/**
+ * Saturated UDP source. Rather than generating packets at a fixed (high) rate, which
+ * takes one event per packet, the source keeps the MAC queue of the sending device
+ * between a low and a high watermark: every time a frame addressed to the receiver of
+ * the flow leaves the queue and less than LowWatermark frames of the flow are left,
+ * the queue is refilled up to HighWatermark frames. A slow refill timer covers the
+ * cases the dequeue trace cannot (e.g., address resolution at the beginning).
+ */
+class SaturatingUdpApp : public TrafficSourceApp
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+    SaturatingUdpApp();
+
+    /**
+     * \param queue the MAC queue the packets of the flow are enqueued into
+     * \param receiver the MAC address of the receiver of the frames of the flow
+     */
+    void SetMacQueue(Ptr<WifiMacQueue> queue, Mac48Address receiver);
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    void StartTraffic() override;
+    void StopTraffic() override;
+
+    /**
+     * Callback connected to the Dequeue trace of the MAC queue.
+     *
+     * \param mpdu the MPDU leaving the queue
+     */
+    void NotifyDequeue(Ptr<const WifiMpdu> mpdu);
+    /**
+     * \return the number of frames of the flow in the MAC queue
+     */
+    uint32_t CountQueued() const;
+    /**
+     * Send packets until HighWatermark frames of the flow are queued.
+     */
+    void Refill();
+    /**
+     * Refill the queue if needed and reschedule the timer.
+     */
+    void RefillTimeout();
+
+    Ptr<WifiMacQueue> m_queue; //!< the MAC queue
+    Mac48Address m_receiver;   //!< the receiver of the frames of the flow
+    uint32_t m_lowWatermark;   //!< frames below which the queue is refilled
+    uint32_t m_highWatermark;  //!< frames the queue is refilled up to
+    Time m_refillInterval;     //!< period of the refill timer
+    uint32_t m_queued;         //!< frames of the flow queued (recounted at every refill)
+    bool m_running;            //!< whether the application is generating traffic
+    EventId m_refillEvent;     //!< the refill timer
+    EventId m_refillNowEvent;  //!< refill scheduled after a frame left the queue
+};
+
+/**
+ * A traffic model and its parameters, e.g., "video[Rate=8Mb/s|FrameRate=30]"
+ */
+struct TrafficModel
+{
+    std::string name;                          //!< the name of the model
+    std::map<std::string, std::string> params; //!< the parameters of the model
+
+    /**
+     * \param key the name of the parameter
+     * \param def the default value
+     * \return the value of the parameter, or the default value if it is not set
+     */
+    std::string Get(const std::string& key, const std::string& def) const;
+};
+
+/**
+ * Parse a per-client traffic specification, i.e., a ';' separated list of
+ * "<clients>:<model>" entries where <clients> is a client index, a range of indices
+ * ("1-3") or '*' for all the clients, and <model> is one of onoff, cbr, flood, bursty,
+ * video, trace and saturated, optionally followed by "[Key=Value|...]" parameters.
+ * The first entry matching a client wins. Aborts if the specification is invalid, sets
+ * a parameter its model does not use or leaves a client without a model.
+ *
+ * \param spec the traffic specification
+ * \param nClients the number of clients
+ * \return the traffic model of each client
+ */
+std::vector<TrafficModel> ParseTrafficSpec(const std::string& spec, std::size_t nClients);
+
+/**
+ * Install the source of a flow on the given client node.
+ *
+ * \param model the traffic model
+ * \param udp whether the flow uses UDP (TCP otherwise)
+ * \param payloadSize the application payload size in bytes
+ * \param node the node of the client
+ * \param device the device the flow is sent through
+ * \param remote the address of the sink of the flow
+ * \param receiver the MAC address of the receiver of the frames of the flow
+ * \return the installed application
+ */
+ApplicationContainer InstallTrafficSource(const TrafficModel& model,
+                                          bool udp,
+                                          uint32_t payloadSize,
+                                          Ptr<Node> node,
+                                          Ptr<NetDevice> device,
+                                          const Address& remote,
+                                          Mac48Address receiver);
+
+} // namespace ns3
+
+#endif /* TRAFFIC_MODELS_H */
@@ -0,0 +1,657 @@
+/*
+ * Analytics over the CSV files written by saw.cc (rr_tputs_*.csv and rr_sched_*.csv).
+ *
+ * Standalone tool, it does not depend on ns-3:
+ *   g++ -O2 -std=c++17 -o tput_analytics tools/tput_analytics.cc
+ *
+ * Usage:
+ *   tput_analytics [--shares] <file or directory>...
+ *       Per-configuration fairness (Jain's index), total throughput, starved clients and,
+ *       with --shares, the share of every client. Scheduling efficiency of the rr_sched
+ *       files (schedule2/candidates). Directories are scanned recursively.
+ *   tput_analytics --diff <A> <B>
+ *       Compare the configurations found under both A and B (matched by their path
+ *       relative to A and B, and by MCS, channel width, GI and number of clients).
+ *
+ * Files are memory-mapped and parsed into columns; the header is used to locate the
+ * columns, hence both the original (mcs,...,n_clients) and the newer layouts (with
+ * stop_s and replication) are supported. Header-only files are reported as empty.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <tuple>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+/**
+ * Read-only memory mapping of a file
+ */
+class MappedFile
+{
+  public:
+    /**
+     * \param path the path of the file
+     */
+    explicit MappedFile(const std::string& path)
+    {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return;
+        }
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr != MAP_FAILED)
+            {
+                m_data = static_cast<const char*>(addr);
+                m_size = st.st_size;
+                madvise(addr, m_size, MADV_SEQUENTIAL);
+            }
+        }
+        close(fd);
+    }
+
+    ~MappedFile()
+    {
+        if (m_data)
+        {
+            munmap(const_cast<char*>(m_data), m_size);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * \return the content of the file (empty if it could not be mapped)
+     */
+    std::string_view GetContent() const
+    {
+        return {m_data, m_size};
+    }
+
+  private:
+    const char* m_data{nullptr}; //!< the mapped content
+    std::size_t m_size{0};       //!< the size of the file
+};
+
+/**
+ * Split a line of a CSV file (no quoting, as written by saw.cc) into fields
+ *
+ * \param line the line
+ * \param fields filled with the fields
+ */
+void
+SplitFields(std::string_view line, std::vector<std::string_view>& fields)
+{
+    fields.clear();
+    std::size_t start = 0;
+    while (true)
+    {
+        auto comma = line.find(',', start);
+        fields.push_back(line.substr(start, comma - start));
+        if (comma == std::string_view::npos)
+        {
+            break;
+        }
+        start = comma + 1;
+    }
+}
+
+/**
+ * \param field a field
+ * \return the field parsed as a number (NaN if invalid)
+ */
+double
+ParseDouble(std::string_view field)
+{
+    double value = NAN;
+    std::from_chars(field.data(), field.data() + field.size(), value);
+    return value;
+}
+
+/**
+ * \param field a field
+ * \return the field parsed as an integer (0 if invalid)
+ */
+int64_t
+ParseInt(std::string_view field)
+{
+    int64_t value = 0;
+    std::from_chars(field.data(), field.data() + field.size(), value);
+    return value;
+}
+
+/**
+ * Call the given function for every line of the content, without the line terminator
+ *
+ * \param content the content of a file
+ * \param f the function
+ */
+template <typename F>
+void
+ForEachLine(std::string_view content, F f)
+{
+    while (!content.empty())
+    {
+        auto eol = content.find('\n');
+        auto line = content.substr(0, eol);
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.remove_suffix(1);
+        }
+        if (!line.empty())
+        {
+            f(line);
+        }
+        if (eol == std::string_view::npos)
+        {
+            break;
+        }
+        content.remove_prefix(eol + 1);
+    }
+}
+
+/**
+ * Throughput rows of all the rr_tputs files, one vector per column
+ */
+struct TputColumns
+{
+    std::vector<uint32_t> group;  //!< the group (file variant and configuration) of the row
+    std::vector<uint32_t> client; //!< the client (interned origin) of the row
+    std::vector<double> tput;     //!< the throughput in Mbit/s
+};
+
+/**
+ * Configuration of a sweep point: variant (path relative to the root it was found
+ * under), MCS, channel width, GI, number of clients and replication
+ */
+typedef std::tuple<std::string, int, int, int, int, int> ConfigKey;
+
+/**
+ * Scheduling counters of an rr_sched file
+ */
+struct SchedSummary
+{
+    std::size_t rows{0};      //!< number of UL MU scheduling decisions
+    uint64_t total{0};        //!< sum of the stations in the UL list
+    uint64_t unsolicited{0};  //!< sum of the stations that could not be solicited
+    uint64_t schedule1{0};    //!< sum of the RUs the decisions were sized for
+    uint64_t candidates{0};   //!< sum of the candidate stations
+    uint64_t schedule2{0};    //!< sum of the stations actually scheduled
+    double sumRatio{0};       //!< sum of the per-decision schedule2/candidates ratios
+    std::size_t ratioRows{0}; //!< decisions with at least one candidate
+};
+
+/**
+ * The corpus of result files
+ */
+class Corpus
+{
+  public:
+    /**
+     * Load every result file found under the given path.
+     *
+     * \param root a file or a directory
+     */
+    void Load(const std::string& root)
+    {
+        namespace fs = std::filesystem;
+        std::vector<fs::path> files;
+        if (fs::is_directory(root))
+        {
+            for (const auto& entry : fs::recursive_directory_iterator(root))
+            {
+                if (entry.is_regular_file() && entry.path().extension() == ".csv")
+                {
+                    files.push_back(entry.path());
+                }
+            }
+            std::sort(files.begin(), files.end());
+        }
+        else
+        {
+            files.emplace_back(root);
+        }
+        for (const auto& file : files)
+        {
+            auto base = fs::is_directory(root) ? fs::path(root) : fs::path(root).parent_path();
+            auto variant = file.parent_path().lexically_relative(base).string();
+            LoadFile(file.string(), variant == "." ? "" : variant);
+        }
+    }
+
+    /**
+     * \return the number of groups
+     */
+    std::size_t GetNGroups() const
+    {
+        return m_groupIds.size();
+    }
+
+    /**
+     * \return the groups, sorted by configuration
+     */
+    std::vector<std::pair<ConfigKey, uint32_t>> GetSortedGroups() const
+    {
+        std::vector<std::pair<ConfigKey, uint32_t>> groups(m_groupIds.cbegin(), m_groupIds.cend());
+        std::sort(groups.begin(), groups.end());
+        return groups;
+    }
+
+    TputColumns m_tputs;                                 //!< throughput rows
+    std::vector<std::string> m_clients;                  //!< interned client names
+    std::vector<std::pair<std::string, SchedSummary>> m_sched; //!< per-file scheduling summary
+    std::vector<std::string> m_emptyFiles;               //!< header-only files
+    std::vector<std::string> m_skippedFiles;             //!< files with an unknown layout
+    std::size_t m_bytes{0};                              //!< bytes parsed
+
+  private:
+    /**
+     * \param path the path of a CSV file
+     * \param variant the variant of the file
+     */
+    void LoadFile(const std::string& path, const std::string& variant)
+    {
+        MappedFile file(path);
+        auto content = file.GetContent();
+        m_bytes += content.size();
+        auto eol = content.find('\n');
+        std::vector<std::string_view> header;
+        SplitFields(content.substr(0, eol), header);
+        if (!header.empty() && !header.back().empty() && header.back().back() == '\r')
+        {
+            header.back().remove_suffix(1);
+        }
+        auto body = (eol == std::string_view::npos ? std::string_view{} : content.substr(eol + 1));
+        if (body.find_first_not_of("\r\n") == std::string_view::npos)
+        {
+            m_emptyFiles.push_back(path);
+            return;
+        }
+        auto column = [&header](std::string_view name) {
+            auto it = std::find(header.cbegin(), header.cend(), name);
+            return (it == header.cend() ? -1 : static_cast<int>(it - header.cbegin()));
+        };
+
+        std::vector<std::string_view> fields;
+        if (column("tput_mbps") >= 0 && column("origin") >= 0)
+        {
+            int mcs = column("mcs");
+            int width = column("channel_mhz");
+            int gi = column("gi_ns");
+            int tput = column("tput_mbps");
+            int origin = column("origin");
+            int nClients = column("n_clients");
+            int replication = column("replication");
+            ForEachLine(body, [&](std::string_view line) {
+                SplitFields(line, fields);
+                if (fields.size() < header.size())
+                {
+                    return;
+                }
+                auto get = [&fields](int i) { return (i < 0 ? 0 : ParseInt(fields[i])); };
+                ConfigKey key{variant,
+                              get(mcs),
+                              get(width),
+                              get(gi),
+                              get(nClients),
+                              static_cast<int>(get(replication))};
+                auto it = m_groupIds.try_emplace(key, m_groupIds.size()).first;
+                m_tputs.group.push_back(it->second);
+                m_tputs.client.push_back(Intern(fields[origin]));
+                m_tputs.tput.push_back(ParseDouble(fields[tput]));
+            });
+        }
+        else if (column("candidates") >= 0 && column("schedule2") >= 0)
+        {
+            int cols[] = {column("total"),
+                          column("unsolicited"),
+                          column("schedule1"),
+                          column("candidates"),
+                          column("schedule2")};
+            SchedSummary summary;
+            ForEachLine(body, [&](std::string_view line) {
+                SplitFields(line, fields);
+                if (fields.size() < header.size())
+                {
+                    return;
+                }
+                uint64_t values[5];
+                for (int i = 0; i < 5; i++)
+                {
+                    values[i] = (cols[i] < 0 ? 0 : ParseInt(fields[cols[i]]));
+                }
+                summary.rows++;
+                summary.total += values[0];
+                summary.unsolicited += values[1];
+                summary.schedule1 += values[2];
+                summary.candidates += values[3];
+                summary.schedule2 += values[4];
+                if (values[3] > 0)
+                {
+                    summary.sumRatio += static_cast<double>(values[4]) / values[3];
+                    summary.ratioRows++;
+                }
+            });
+            m_sched.emplace_back(path, summary);
+        }
+        else
+        {
+            m_skippedFiles.push_back(path);
+        }
+    }
+
+    /**
+     * \param name a client name
+     * \return the identifier of the client
+     */
+    uint32_t Intern(std::string_view name)
+    {
+        auto it = m_clientIds.find(std::string(name));
+        if (it != m_clientIds.end())
+        {
+            return it->second;
+        }
+        m_clients.emplace_back(name);
+        return m_clientIds.emplace(m_clients.back(), m_clients.size() - 1).first->second;
+    }
+
+    std::map<ConfigKey, uint32_t> m_groupIds;                //!< group of each configuration
+    std::unordered_map<std::string, uint32_t> m_clientIds; //!< identifier of each client
+};
+
+/**
+ * Throughput metrics of a configuration
+ */
+struct GroupStats
+{
+    std::size_t n{0};    //!< number of clients
+    double total{0};     //!< total throughput in Mbit/s
+    double sumSq{0};     //!< sum of the squared per-client throughputs
+    double min{INFINITY}; //!< lowest per-client throughput
+    double max{0};       //!< highest per-client throughput
+    std::size_t starved{0}; //!< clients with null throughput
+
+    /**
+     * \return Jain's fairness index (1 if all the clients get the same throughput)
+     */
+    double GetJain() const
+    {
+        return (sumSq > 0 ? total * total / (n * sumSq) : 1);
+    }
+};
+
+/**
+ * \param corpus the corpus
+ * \return the metrics of every group, in a single pass over the columns
+ */
+std::vector<GroupStats>
+ComputeGroupStats(const Corpus& corpus)
+{
+    std::vector<GroupStats> stats(corpus.GetNGroups());
+    const auto& cols = corpus.m_tputs;
+    for (std::size_t r = 0; r < cols.tput.size(); r++)
+    {
+        auto& s = stats[cols.group[r]];
+        double x = cols.tput[r];
+        s.n++;
+        s.total += x;
+        s.sumSq += x * x;
+        s.min = std::min(s.min, x);
+        s.max = std::max(s.max, x);
+        s.starved += (x <= 0);
+    }
+    return stats;
+}
+
+/**
+ * \param key a configuration
+ * \return the configuration formatted for the reports
+ */
+std::string
+FormatKey(const ConfigKey& key)
+{
+    const auto& [variant, mcs, width, gi, nClients, replication] = key;
+    std::string str = (variant.empty() ? "." : variant) + " mcs=" + std::to_string(mcs) +
+                      " width=" + std::to_string(width) + " gi=" + std::to_string(gi) +
+                      " clients=" + std::to_string(nClients);
+    if (replication > 0)
+    {
+        str += " run=" + std::to_string(replication);
+    }
+    return str;
+}
+
+/**
+ * Print the per-configuration report.
+ *
+ * \param corpus the corpus
+ * \param shares whether to print the share of every client
+ */
+void
+PrintReport(const Corpus& corpus, bool shares)
+{
+    auto stats = ComputeGroupStats(corpus);
+    std::vector<std::vector<std::size_t>> rowsByGroup;
+    if (shares)
+    {
+        rowsByGroup.resize(stats.size());
+        for (std::size_t r = 0; r < corpus.m_tputs.group.size(); r++)
+        {
+            rowsByGroup[corpus.m_tputs.group[r]].push_back(r);
+        }
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "configuration\trows\ttotal_mbps\tjain\tmin_mbps\tmax_mbps\tmax/mean\tstarved\n";
+    for (const auto& [key, group] : corpus.GetSortedGroups())
+    {
+        const auto& s = stats[group];
+        double mean = s.total / s.n;
+        std::cout << FormatKey(key) << "\t" << s.n << "\t" << s.total << "\t" << s.GetJain()
+                  << "\t" << s.min << "\t" << s.max << "\t" << (mean > 0 ? s.max / mean : 0)
+                  << "\t" << s.starved << "\n";
+        if (shares)
+        {
+            for (auto r : rowsByGroup[group])
+            {
+                double x = corpus.m_tputs.tput[r];
+                std::cout << "    " << corpus.m_clients[corpus.m_tputs.client[r]] << "\t" << x
+                          << " Mbit/s\t" << (s.total > 0 ? 100 * x / s.total : 0) << " %\n";
+            }
+        }
+    }
+
+    for (const auto& [path, sched] : corpus.m_sched)
+    {
+        std::cout << "\n" << path << ": " << sched.rows << " scheduling decisions\n"
+                  << "  schedule2/candidates: " << (sched.candidates > 0
+                                                        ? static_cast<double>(sched.schedule2) /
+                                                              sched.candidates
+                                                        : 0)
+                  << " (aggregate), "
+                  << (sched.ratioRows > 0 ? sched.sumRatio / sched.ratioRows : 0)
+                  << " (mean per decision)\n"
+                  << "  RUs/stations: "
+                  << (sched.total > 0 ? static_cast<double>(sched.schedule1) / sched.total : 0)
+                  << ", unsolicited/total: "
+                  << (sched.total > 0 ? static_cast<double>(sched.unsolicited) / sched.total : 0)
+                  << "\n"
+                  << "  mean per decision: total " << static_cast<double>(sched.total) / sched.rows
+                  << ", candidates " << static_cast<double>(sched.candidates) / sched.rows
+                  << ", scheduled " << static_cast<double>(sched.schedule2) / sched.rows << "\n";
+    }
+}
+
+/**
+ * Print the difference between the configurations found in both corpora
+ *
+ * \param a the first corpus
+ * \param b the second corpus
+ */
+void
+PrintDiff(const Corpus& a, const Corpus& b)
+{
+    //* Replications are averaged
+    auto average = [](const Corpus& corpus) {
+        auto stats = ComputeGroupStats(corpus);
+        std::map<ConfigKey, std::tuple<double, double, std::size_t>> means; // total, jain, runs
+        for (const auto& [key, group] : corpus.GetSortedGroups())
+        {
+            auto config = key;
+            std::get<5>(config) = 0;
+            auto& [total, jain, runs] = means[config];
+            total += stats[group].total;
+            jain += stats[group].GetJain();
+            runs++;
+        }
+        for (auto& [key, mean] : means)
+        {
+            std::get<0>(mean) /= std::get<2>(mean);
+            std::get<1>(mean) /= std::get<2>(mean);
+        }
+        return means;
+    };
+    auto meansA = average(a);
+    auto meansB = average(b);
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "configuration\tA_total_mbps\tB_total_mbps\tdelta_%\tA_jain\tB_jain\tdelta_jain\n";
+    std::size_t onlyA = 0;
+    for (const auto& [key, ma] : meansA)
+    {
+        auto it = meansB.find(key);
+        if (it == meansB.end())
+        {
+            onlyA++;
+            continue;
+        }
+        const auto& mb = it->second;
+        double ta = std::get<0>(ma);
+        double tb = std::get<0>(mb);
+        std::cout << FormatKey(key) << "\t" << ta << "\t" << tb << "\t"
+                  << (ta > 0 ? 100 * (tb - ta) / ta : 0) << "\t" << std::get<1>(ma) << "\t"
+                  << std::get<1>(mb) << "\t" << std::get<1>(mb) - std::get<1>(ma) << "\n";
+    }
+    std::size_t onlyB = 0;
+    for (const auto& [key, mb] : meansB)
+    {
+        onlyB += (meansA.find(key) == meansA.end());
+    }
+    std::cout << onlyA << " configurations only in A, " << onlyB << " only in B\n";
+}
+
+/**
+ * \param corpus the corpus
+ */
+void
+PrintFileNotes(const Corpus& corpus)
+{
+    for (const auto& path : corpus.m_emptyFiles)
+    {
+        std::cerr << "empty (header only): " << path << "\n";
+    }
+    for (const auto& path : corpus.m_skippedFiles)
+    {
+        std::cerr << "skipped (unknown layout): " << path << "\n";
+    }
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::string> args(argv + 1, argv + argc);
+    bool shares = false;
+    bool diff = false;
+    std::vector<std::string> paths;
+    for (const auto& arg : args)
+    {
+        if (arg == "--shares")
+        {
+            shares = true;
+        }
+        else if (arg == "--diff")
+        {
+            diff = true;
+        }
+        else if (arg == "-h" || arg == "--help")
+        {
+            paths.clear();
+            break;
+        }
+        else
+        {
+            paths.push_back(arg);
+        }
+    }
+    if (paths.empty() || (diff && paths.size() != 2))
+    {
+        std::cerr << "Usage: " << argv[0] << " [--shares] <file or directory>...\n"
+                  << "       " << argv[0] << " --diff <A> <B>\n";
+        return 1;
+    }
+    for (const auto& path : paths)
+    {
+        if (!std::filesystem::exists(path))
+        {
+            std::cerr << "No such file or directory: " << path << "\n";
+            return 1;
+        }
+    }
+
+    std::size_t bytes = 0;
+    std::size_t rows = 0;
+    if (diff)
+    {
+        Corpus a;
+        Corpus b;
+        a.Load(paths[0]);
+        b.Load(paths[1]);
+        PrintFileNotes(a);
+        PrintFileNotes(b);
+        PrintDiff(a, b);
+        bytes = a.m_bytes + b.m_bytes;
+        rows = a.m_tputs.tput.size() + b.m_tputs.tput.size();
+    }
+    else
+    {
+        Corpus corpus;
+        for (const auto& path : paths)
+        {
+            corpus.Load(path);
+        }
+        PrintFileNotes(corpus);
+        PrintReport(corpus, shares);
+        bytes = corpus.m_bytes;
+        rows = corpus.m_tputs.tput.size();
+    }
+
+    double ms =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << rows << " throughput rows (" << bytes << " bytes) analyzed in " << ms << " ms\n";
+    return 0;
+}